@@ -5,17 +5,50 @@
 // and username checks are done carefully so approval can create the login.
 // =========================
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE // pthread_rwlockattr_setkind_np (daemon mode)
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <time.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdatomic.h>
 
 #ifdef _WIN32
   #include <windows.h>
   #include <conio.h>
+  #include <io.h>
+  #include <direct.h>
+  #include <fcntl.h>
+  #include <sys/stat.h>
 #else
   #include <unistd.h>
+  #include <fcntl.h>
+  #include <sys/types.h>
+  #include <sys/wait.h>
+  #include <sys/stat.h>
+  #include <sys/mman.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <poll.h>
+  #include <signal.h>
+  #include <pthread.h>
+#endif
+
+#if defined(_MSC_VER)
+  #define THREAD_LOCAL __declspec(thread)
+#else
+  #define THREAD_LOCAL __thread
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define HAVE_SSE2 1
 #endif
 
 // -------------------------
@@ -25,7 +58,24 @@
 #define STUDENTS_FILE    "students.txt"           // format: id,name,department,semester,cgpa
 #define LOGINS_FILE      "logins.txt"             // format: username,password,role,studentId
 #define MARKSHEET_FILE   "marksheets.txt"
-#define TEMP_FILE        "temp.txt"
+#define STUDENTS_BIN_FILE "students.dat"          // fixed-width records, see StudentDiskRecord
+#define STUDENTS_JOURNAL "students.journal"       // format: U,<students.txt line> or D,id (replayed over STUDENTS_FILE)
+#define STUDENTS_JOURNAL_OLD "students.journal.old" // journal being folded into STUDENTS_FILE by compaction
+#define SEQUENCE_FILE    "sequences.txt"          // format: table,nextId (one line per table)
+#define DELETE_COMMIT_FILE "delete.commit"       // format: S,id / R,tmp,target (bulk delete being published)
+#define DELETE_COMMIT_TMP  "delete.commit.tmp"
+#define MARKSHEET_DELETE_TMP "marksheets.delete.tmp"
+#define LOGINS_DELETE_TMP    "logins.delete.tmp"
+#define IMPORT_REJECTS_FILE "import_rejects.txt"  // format: line,reason,original row (written by bulk import)
+#define JOURNAL_COMPACT_BYTES (4L * 1024 * 1024)  // fold the journal once it grows past this
+#define LOCK_FILE        "sms.lock"               // one lock + generation slot per table, see lockTables()
+#define BATCH_COMMIT_OPS 256                      // batch commands sharing one commit window
+#define STATS_FILE       "stats.txt"              // operation stats, rewritten on exit
+#define DAEMON_SOCKET    "sms.sock"               // default socket for --daemon / --connect
+#define DAEMON_MAX_CLIENTS 256
+#define DAEMON_MAX_WORKERS 64
+#define DAEMON_LINE_MAX  (64 * 1024)              // longest request line a client may send
+#define DAEMON_COMMIT_GROUP 32                    // queued write requests committed together
 
 #define MAX_LINE         1024
 #define MAX_NAME         100
@@ -35,6 +85,8 @@
 #define MAX_SUBJECT      60
 #define MAX_TOKEN        200
 #define MAX_STATUS       16  // pending / approved
+#define FIRST_STUDENT_ID 120 // nextStudentId() starts here; students.dat slot 0
+#define MAX_ID_LIST      1000000 // most ids one id list ("120,130-180") may expand to
 
 // -------------------------
 // Data structures
@@ -44,9 +96,16 @@ typedef struct {
     char name[MAX_NAME];
     char department[MAX_DEPT];
     int semester;
-    float cgpa;
+    int cgpa;                       // hundredths (3.25 is 325)
 } Student;
 
+// Growable text buffer used to batch many lines into one write (see textBufPrintf).
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} TextBuf;
+
 typedef struct {
     char username[MAX_USERNAME];
     char password[MAX_PASS];
@@ -59,8 +118,12 @@ typedef struct {
 // -------------------------
 
 /* admission + id helpers */
+typedef enum { SEQ_STUDENTS = 0, SEQ_ADMISSIONS = 1, SEQ_COUNT } SequenceId;
 int nextAdmissionTempId();
 int nextStudentId();
+int reserveIds(SequenceId seq, int count); /* claim a block of ids, returns the first */
+void observeId(SequenceId seq, int id);    /* keep the sequence ahead of an id written elsewhere */
+void releaseIdTail(SequenceId seq, int from, int end); /* return unused ids at the end of a block */
 
 /* username checks */
 int usernameExistsInLogins(const char *username);            // checks LOGINS_FILE only
@@ -72,23 +135,191 @@ int createLogin(const char *username, const char *password, const char *role, in
 int loginUser(const char *username, const char *password, char *outRole, int *outStudentId);   // authenticates using LOGINS_FILE
 
 /* admission + approval */
+enum {
+    APPROVE_OK = 1,             // approved now; studentId is the new student
+    APPROVE_NOT_FOUND = 0,
+    APPROVE_ALREADY = 2,        // was approved earlier; studentId is the linked student
+    APPROVE_USERNAME_TAKEN = 3,
+    APPROVE_MALFORMED = 4,
+    APPROVE_ERROR = -1
+};
+typedef struct {
+    int tempId;
+    int result;     // APPROVE_*
+    int studentId;
+} ApprovalResult;
+
 int registerAdmission(); /* saves to ADMISSION_FILE with status "pending" */
+int submitAdmission(const Student *s, const char *email, const char *username, const char *password); /* same, no prompts */
 int approveAdmissionById(int admissionTempId); /* admin: mark approved and create login (checks LOGINS only) */
+int approveAdmissionsBatch(const int *tempIds, int count, ApprovalResult **outResults, int *outCount); /* NULL ids = all pending */
+int createLoginsBatch(const LoginEntry *entries, int count, int *status); /* through --connect not atomic: see remoteCreateLoginsBatch */
+const char *approvalResultText(int result);
 
 /* student CRUD + marksheet */
 int addStudentRecord(const Student *s);
+int addStudentRecordsBatch(const Student *list, int count, int *status); /* one store append for many students; through --connect not atomic */
 int updateStudentRecord(int id, const Student *newData);
 int deleteStudentRecord(int id);
+int deleteStudentsBatch(const int *ids, int count);                        /* one rewrite per file for many ids */
+int deleteStudentsWhere(int (*pred)(const Student *, void *), void *ctx);  /* e.g. semester > 8 */
 int findStudentById(int id, Student *out);
 void listAllStudents();
+int loadStudentTable(); /* load the active student store into the resident table (called once at startup) */
+int convertStudentsToBinary(); /* one-shot STUDENTS_FILE -> STUDENTS_BIN_FILE conversion */
+int studentTableMaxId();       /* highest student id seen in the resident table */
+void finishStudentJournal();   /* close the journal and wait for a background compaction */
 
 int addMarksheet(int studentId);
 int viewMarksheetFor(int studentId);
+int addMarksheetEntry(int studentId, const char *semesterLabel, const char *subjects); /* no prompts */
+int collectMarksheets(int studentId, TextBuf *out);                                   /* raw lines of one student */
+
+/* CGPA from marksheets: adding a marksheet stores the student's cumulative CGPA (the
+   average of every subject score). verifyCgpa recounts marksheets.txt from scratch and
+   compares the running totals and every stored CGPA against it; with fix set, records
+   that differ are rewritten. Returns the number of records that differed (listed in
+   *out, caller frees), -1 on error. */
+typedef struct {
+    int id;
+    int stored, computed;   // hundredths
+} CgpaMismatch;
+typedef struct {
+    int students;           // students with scored marksheets
+    int marksheets;
+    int totalsMismatched;   // students whose running totals were wrong (they are recounted)
+    int cgpaMismatched;     // records whose CGPA differs from their marksheets
+    int fixed;
+} CgpaReport;
+int verifyCgpa(int fix, CgpaReport *report, CgpaMismatch **out);
+
+/* bulk marksheet export: every student's official report to dir/marksheet_<id>.txt */
+typedef struct {
+    int reports;        // files written
+    int marksheets;
+    int failed;         // reports that could not be written
+    int threads;
+    double seconds;
+} ExportReport;
+int exportMarksheetReports(const char *dir, int threads, ExportReport *report); /* threads 0 = one per CPU */
+
+/* admission requests (read side) */
+typedef struct {
+    int tempId;
+    char name[MAX_NAME];
+    char department[MAX_DEPT];
+    int semester;
+    char email[128];
+    char username[MAX_USERNAME];
+    char status[MAX_STATUS];
+    int studentId;
+} AdmissionInfo;
+int listAdmissions(int tempId, const char *username, AdmissionInfo **out); /* password is never returned */
+
+/* paged listings. Filters are checked during the scan, so rows that do not match are
+   never copied or formatted. A cursor is a position in listing order (0 = start): a
+   forward page holds the first `limit` matches at or after it, a backward page the
+   last `limit` matches before it. Both return the page size (caller frees *out), -1
+   on error. Student positions shift when a compaction drops deleted rows. */
+typedef struct {
+    const char *department;  // NULL or "" = any
+    int semester;            // 0 = any
+    const char *status;      // admissions only: "pending", "approved"; NULL or "" = any
+} ListFilter;
+typedef struct {
+    int next;   // forward cursor for the page after this one, -1 on the last page
+    int prev;   // backward cursor for the page before this one, -1 on the first page
+} ListPage;
+int listStudentsPage(const ListFilter *f, int cursor, int limit, int backward, Student **out, ListPage *page);
+int listAdmissionsPage(const ListFilter *f, int cursor, int limit, int backward, AdmissionInfo **out, ListPage *page);
+
+/* bulk import */
+typedef struct {
+    int rows;           // data rows read
+    int imported;       // students created
+    int logins;         // logins created
+    int rejected;
+    double seconds;
+} ImportReport;
+int importStudentsCsv(const char *path, ImportReport *report);
+
+/* department / semester analytics */
+#define ANALYTICS_SEMESTERS 256 // semesters are counted 0..255 (clamped)
+#define ANALYTICS_BUCKETS   5   // CGPA distribution, see g_cgpaBucketLabels
+typedef struct {
+    char department[MAX_DEPT];
+    int students;
+    int avgCgpa, medianCgpa;    // hundredths
+} DeptAnalytics;
+typedef struct {
+    int students;
+    int avgCgpa, medianCgpa;               // hundredths
+    DeptAnalytics *depts;                  // sorted by name; free() when done
+    int nDepts;
+    int bySemester[ANALYTICS_SEMESTERS];   // headcount per semester
+    int byCgpa[ANALYTICS_BUCKETS];
+} AnalyticsReport;
+int studentAnalytics(AnalyticsReport *out);
+
+/* merit lists: best CGPA first, ties by id; department NULL or "" = every student.
+   CGPA bounds are in hundredths, inclusive. Both return how many students they put in *out (caller frees), -1 on error. */
+int topStudentsByCgpa(const char *department, int k, Student **out);
+int studentsInCgpaRange(const char *department, int minCgpa, int maxCgpa, int limit, Student **out); /* limit 0 = all */
+
+/* name search: case-insensitive substring match, best matches first. Puts page
+   [offset, offset + limit) in *out (caller frees) and the number of matches in *total;
+   returns the page size, -1 on error. Queries shorter than 3 characters match word starts. */
+int searchStudentsByName(const char *query, int offset, int limit, Student **out, int *total);
 
 /* menus */
 void adminMenu();
 void studentMenu(int studentId);
 
+// Set by the headless modes: library code must not print to stdout
+static int g_quiet = 0;
+
+/* cross-process table locks + group commit (see lockTables) */
+typedef enum { TBL_SEQUENCES, TBL_ADMISSIONS, TBL_STUDENTS, TBL_LOGINS, TBL_MARKSHEETS, TBL_COUNT } TableId;
+#define TBL(t)  (1u << (t))
+#define TBL_ALL ((1u << TBL_COUNT) - 1)
+typedef enum { DURABILITY_NONE, DURABILITY_BATCH, DURABILITY_OP } Durability;
+static Durability g_durability = DURABILITY_NONE; // --durability=none|batch|op
+static int lockTables(unsigned mask, unsigned exclusive);
+static int unlockTables(unsigned mask);
+static void markTableWritten(const char *path);
+static void tableCacheInvalidate(TableId t); /* drop a resident copy another process made stale */
+static int storeSync();                      /* flush the binary student store to disk */
+
+/* thin client (--connect): the public operations above are forwarded to a daemon */
+static int g_remote = 0;
+static unsigned char remoteUsernameFlags(const char *username);
+static int remoteReserveIds(SequenceId seq, int count);
+static int remoteCreateLogin(const char *username, const char *password, const char *role, int studentId);
+static int remoteCreateLoginsBatch(const LoginEntry *entries, int count, int *status);
+static int remoteSubmitAdmission(const Student *s, const char *email, const char *username, const char *password);
+static int remoteApproveAdmissionsBatch(const int *tempIds, int count, ApprovalResult **outResults, int *outCount);
+static int remoteListAdmissions(int tempId, const char *username, AdmissionInfo **out);
+static int remoteListAdmissionsPage(const ListFilter *f, int cursor, int limit, int backward, AdmissionInfo **out, ListPage *page);
+static int remoteLoginUser(const char *username, const char *password, char *outRole, int *outStudentId);
+static int remoteAddStudentRecord(const Student *s);
+static int remoteAddStudentRecordsBatch(const Student *list, int count, int *status);
+static int remoteFindStudentById(int id, Student *out);
+static int remoteUpdateStudentRecord(int id, const Student *newData);
+static int remoteDeleteStudentsBatch(const int *ids, int count);
+static int remoteDeleteStudentsWhere(int (*pred)(const Student *, void *), void *ctx);
+static void remoteListAllStudents();
+static int remoteListStudentsPage(const ListFilter *f, int cursor, int limit, int backward, Student **out, ListPage *page);
+static int remoteAddMarksheetEntry(int studentId, const char *semesterLabel, const char *subjects);
+static int remoteCollectMarksheets(int studentId, TextBuf *out);
+static int remoteImportStudentsCsv(const char *path, ImportReport *report);
+static int remoteExportMarksheetReports(const char *dir, int threads, ExportReport *report);
+static int remoteVerifyCgpa(int fix, CgpaReport *report, CgpaMismatch **out);
+static int remoteStudentAnalytics(AnalyticsReport *out);
+static int remoteRankQuery(const char *department, int minCgpa, int maxCgpa, int limit, int top, Student **out);
+static int remoteSearchStudentsByName(const char *query, int offset, int limit, Student **out, int *total);
+static void remotePrintStats();
+static int remoteBatchCommand(char *line, FILE *out);
+
 // -------------------------
 // Utility helpers
 // -------------------------
@@ -182,30 +413,6 @@ int getIntInput(const char *prompt) {
     }
 }
 
-// Get float with validation and custom prompt
-float getFloatInput(const char *prompt) {
-    char line[128];
-    float val;
-    char *endptr;
-    while (1) {
-        if (prompt && *prompt) printf("%s", prompt);
-        if (!safeFgets(line, sizeof(line))) {
-            printf("❌ Input error. Try again.\n");
-            continue;
-        }
-        if (line[0] == '\0') {
-            printf("❌ Input cannot be empty. Try again.\n");
-            continue;
-        }
-        val = strtof(line, &endptr);
-        if (*endptr != '\0') {
-            printf("❌ Invalid input. Enter a numeric value.\n");
-            continue;
-        }
-        return val;
-    }
-}
-
 // Get string input and ensure not empty (stores in outBuf of size)
 void getStringInput(const char *prompt, char *outBuf, size_t size) {
     while (1) {
@@ -226,7 +433,8 @@ void getStringInput(const char *prompt, char *outBuf, size_t size) {
 int isValidName(const char *s) {
     if (!s) return 0;
     for (; *s; ++s) {
-        if (!(isalpha((unsigned char)*s) || isspace((unsigned char)*s) || *s == '.' || *s == '-'))
+        if (!(isalpha((unsigned char)*s) || isspace((unsigned char)*s) || *s == '.' || *s == '-' ||
+              *s == ',' || *s == '\''))
             return 0;
     }
     return 1;
@@ -249,817 +457,7905 @@ int isDigitsOnly(const char *s) {
 }
 
 // -------------------------
-// Terminal UI helpers
+// Fixed-point hundredths
 // -------------------------
-// Print a centered, boxed title (works with typical terminal widths)
-void printBoxedTitle(const char *title) {
-    int width = 72; // target width for box (adjustable)
-    int pad = 2;
-    int tlen = (int)strlen(title);
-    int inner = width - 2; // inside width
-    if (tlen + pad * 2 > inner) {
-        // if title too long, just print simple box
-        printf("\n+-%.*s-+\n", tlen + pad*2, "----------------------------------------------------------------------");
-        printf("| %s |\n", title);
-        printf("+-%.*s-+\n\n", tlen + pad*2, "----------------------------------------------------------------------");
-        return;
+/* CGPA and subject scores are kept as integer hundredths (3.25 is 325) everywhere, so
+ * they round-trip through the files exactly. These read and write the "d.dd" text form
+ * directly; the record and listing paths call them once per row, so they avoid stdio. */
+
+#define NUM_BUF 16   // room for any int as decimal or as "d.dd", plus the NUL
+
+// Decimal form of v into buf (NUM_BUF bytes). Returns the length.
+static int formatInt(int v, char *buf) {
+    char tmp[NUM_BUF];
+    unsigned u = (unsigned)v;
+    int n = 0, len = 0;
+    if (v < 0) {
+        buf[len++] = '-';
+        u = 0u - u;
     }
-    int left = (inner - tlen) / 2;
-    int right = inner - tlen - left;
-    // top border
-    printf("\n+");
-    for (int i=0;i<inner;i++) putchar('-');
-    printf("+\n");
-    // title line
-    printf("|");
-    for (int i=0;i<left;i++) putchar(' ');
-    printf("%s", title);
-    for (int i=0;i<right;i++) putchar(' ');
-    printf("|\n");
-    // bottom border
-    printf("+");
-    for (int i=0;i<inner;i++) putchar('-');
-    printf("+\n\n");
+    do {
+        tmp[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    while (n) buf[len++] = tmp[--n];
+    buf[len] = '\0';
+    return len;
 }
 
-// Print a centered subtitle line
-void printCenteredLine(const char *line) {
-    int width = 72;
-    int len = (int)strlen(line);
-    int left = (width - len) / 2;
-    if (left < 0) left = 0;
-    for (int i=0;i<left;i++) putchar(' ');
-    printf("%s\n", line);
+// Hundredths v as "[-]d.dd" into buf (NUM_BUF bytes). Returns the length.
+static int formatHundredths(int v, char *buf) {
+    unsigned u = (unsigned)v;
+    int len = 0;
+    if (v < 0) {
+        buf[len++] = '-';
+        u = 0u - u;
+    }
+    len += formatInt((int)(u / 100), buf + len);
+    buf[len++] = '.';
+    buf[len++] = (char)('0' + u / 10 % 10);
+    buf[len++] = (char)('0' + u % 10);
+    buf[len] = '\0';
+    return len;
 }
 
-// Small helper to print app header (used by main)
-void printAppHeader() {
-    clearScreen();
-    printBoxedTitle("DAFFODIL INTERNATIONAL UNIVERSITY (DIU)");
-    printCenteredLine("Student Management System — Terminal Edition");
-    printCenteredLine("");
-    showDateTime();
-    printf("\n");
+// Parse "[+-]digits[.digits]" in [p, end) (leading blanks skipped) as hundredths; a
+// third decimal rounds half away from zero and later ones are ignored. Saturates at
+// INT_MAX. Returns the characters consumed, or 0 if there is no number at p.
+static int parseHundredths(const char *p, const char *end, int *out) {
+    const char *start = p;
+    while (p < end && isspace((unsigned char)*p)) p++;
+    int neg = (p < end && *p == '-');
+    if (p < end && (*p == '-' || *p == '+')) p++;
+    long long v = 0;
+    int digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        if (v < 100000000) v = v * 10 + (*p - '0');
+    }
+    v *= 100;
+    if (p < end && *p == '.') {
+        int scale = 10;
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+            if (scale > 0) v += (*p - '0') * scale;
+            else if (scale == 0 && *p >= '5') v++;
+            scale = scale > 0 ? scale / 10 : -1;
+        }
+    }
+    if (!digits) return 0;
+    if (v > INT_MAX) v = INT_MAX;
+    *out = (int)(neg ? -v : v);
+    return (int)(p - start);
 }
 
+// Whole-string parse (trailing blanks allowed). Returns 1 on success, 0 if s is not a number.
+static int textHundredths(const char *s, int *out) {
+    const char *end = s + strlen(s);
+    int n = parseHundredths(s, end, out);
+    if (n == 0) return 0;
+    for (s += n; s < end; s++) {
+        if (!isspace((unsigned char)*s)) return 0;
+    }
+    return 1;
+}
 
+// atof()-style: the number at the start of s in hundredths, or 0 if there is none
+static int hundredthsOf(const char *s) {
+    int v = 0;
+    parseHundredths(s, s + strlen(s), &v);
+    return v;
+}
 
+// v in hundredths, rounded to nearest (only for values that really are floating
+// point, such as records in the old binary format)
+static int toHundredths(double v) {
+    v *= 100.0;
+    return (int)(v < 0 ? v - 0.5 : v + 0.5);
+}
 
+// Get a decimal value (e.g. CGPA) as hundredths, with validation and custom prompt
+int getHundredthsInput(const char *prompt) {
+    char line[128];
+    int val;
+    while (1) {
+        if (prompt && *prompt) printf("%s", prompt);
+        if (!safeFgets(line, sizeof(line))) {
+            printf("❌ Input error. Try again.\n");
+            continue;
+        }
+        if (line[0] == '\0') {
+            printf("❌ Input cannot be empty. Try again.\n");
+            continue;
+        }
+        if (!textHundredths(line, &val)) {
+            printf("❌ Invalid input. Enter a numeric value.\n");
+            continue;
+        }
+        return val;
+    }
+}
 
+// -------------------------
+// Operation stats
+// -------------------------
+// Each public operation records its latency in a log-linear (HDR-style) histogram
+// together with the I/O it caused. A call made from inside another operation
+// (approveAdmissionById -> approveAdmissionsBatch) is charged to the outer one, and I/O
+// outside any operation goes to "other".
+
+typedef enum {
+    STAT_LOGIN, STAT_USERNAME_EXISTS, STAT_CREATE_LOGIN, STAT_CREATE_LOGINS, STAT_SUBMIT_ADMISSION,
+    STAT_LIST_PENDING, STAT_LIST_ADMISSIONS, STAT_APPROVE, STAT_APPROVE_BATCH, STAT_LOAD, STAT_ADD_STUDENT, STAT_ADD_STUDENTS,
+    STAT_FIND, STAT_UPDATE, STAT_DELETE, STAT_DELETE_BATCH, STAT_DELETE_WHERE, STAT_LIST,
+    STAT_ADD_MARKSHEET, STAT_COLLECT_MARKSHEETS, STAT_VIEW_MARKSHEET, STAT_EXPORT, STAT_VERIFY_CGPA, STAT_IMPORT, STAT_ANALYTICS, STAT_TOP, STAT_RANGE, STAT_SEARCH,
+    STAT_LIST_PAGE, STAT_ADMISSIONS_PAGE, STAT_OTHER, STAT_COUNT
+} StatOp;
+
+static const char *g_statNames[STAT_COUNT] = {
+    "loginUser", "usernameExists", "createLogin", "createLoginsBatch", "submitAdmission",
+    "listPendingAdmissions", "listAdmissions", "approveAdmissionById", "approveAdmissionsBatch", "loadStudentTable",
+    "addStudentRecord", "addStudentRecordsBatch", "findStudentById", "updateStudentRecord",
+    "deleteStudentRecord", "deleteStudentsBatch", "deleteStudentsWhere", "listAllStudents",
+    "addMarksheetEntry", "collectMarksheets", "viewMarksheetFor", "exportMarksheetReports", "verifyCgpa", "importStudentsCsv", "studentAnalytics",
+    "topStudentsByCgpa", "studentsInCgpaRange", "searchStudentsByName",
+    "listStudentsPage", "listAdmissionsPage", "other"
+};
+
+#define HIST_SUB_BITS 4
+#define HIST_SUB      (1 << HIST_SUB_BITS)  // linear sub-buckets per power of two (~6% precision)
+#define HIST_MAX_BITS 47                    // values are clamped below 2^47 ns (~39 hours)
+#define HIST_BUCKETS  ((HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_SUB)
 
+typedef struct {
+    unsigned long long counts[HIST_BUCKETS];
+    unsigned long long total, min, max, sum; // nanoseconds
+} LatencyHistogram;
 
+typedef struct {
+    unsigned long long calls;
+    unsigned long long bytesRead, bytesWritten, linesParsed, filesRewritten;
+    LatencyHistogram hist;
+} OpStats;
 
+typedef struct {
+    int op;                   // -1 when nested inside another operation
+    unsigned long long start;
+} StatScope;
+
+// Each thread counts into its own block (daemon workers get one from statsNewBlock);
+// printOperationStats adds the blocks up.
+#define STATS_MAX_BLOCKS (DAEMON_MAX_WORKERS + 1)
+
+static OpStats g_mainStats[STAT_COUNT];
+static OpStats *g_statBlocks[STATS_MAX_BLOCKS] = { g_mainStats };
+static int g_statBlockCount = 1;
+static THREAD_LOCAL OpStats *t_stats = g_mainStats;
+static THREAD_LOCAL int t_statActive = STAT_OTHER;
+static THREAD_LOCAL int t_statDepth = 0;
+
+static unsigned long long statsNowNs() {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (unsigned long long)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+#endif
+}
 
+// values below 2*HIST_SUB get their own bucket; above that each power of two is split
+// into HIST_SUB equal buckets
+static int histBucketOf(unsigned long long v) {
+    if (v >= (1ULL << HIST_MAX_BITS)) v = (1ULL << HIST_MAX_BITS) - 1;
+    if (v < 2 * HIST_SUB) return (int)v;
+    int msb = 0;
+    while ((v >> msb) > 1) msb++;
+    int shift = msb - HIST_SUB_BITS;
+    return shift * HIST_SUB + (int)(v >> shift);
+}
 
+// highest value that lands in bucket b
+static unsigned long long histBucketTop(int b) {
+    if (b < 2 * HIST_SUB) return (unsigned long long)b;
+    int shift = b / HIST_SUB - 1;
+    unsigned long long sub = (unsigned long long)(b % HIST_SUB + HIST_SUB);
+    return ((sub + 1) << shift) - 1;
+}
 
+static void histRecord(LatencyHistogram *h, unsigned long long v) {
+    h->counts[histBucketOf(v)]++;
+    if (h->total == 0 || v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+    h->total++;
+    h->sum += v;
+}
 
+// value at quantile q (0..1), accurate to the bucket width
+static unsigned long long histQuantile(const LatencyHistogram *h, double q) {
+    if (h->total == 0) return 0;
+    unsigned long long want = (unsigned long long)(q * (double)h->total + 0.5), seen = 0;
+    if (want < 1) want = 1;
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen >= want) {
+            unsigned long long top = histBucketTop(b);
+            return top < h->max ? top : h->max;
+        }
+    }
+    return h->max;
+}
 
+static StatScope statsBegin(StatOp op) {
+    StatScope sc = { -1, 0 };
+    if (t_statDepth++ > 0) return sc;
+    t_statActive = op;
+    sc.op = op;
+    sc.start = statsNowNs();
+    return sc;
+}
 
+static void statsEnd(StatScope sc) {
+    t_statDepth--;
+    if (sc.op < 0) return;
+    histRecord(&t_stats[sc.op].hist, statsNowNs() - sc.start);
+    t_stats[sc.op].calls++;
+    t_statActive = STAT_OTHER;
+}
 
+static void statsRead(size_t bytes) { t_stats[t_statActive].bytesRead += bytes; }
+static void statsLines(size_t lines) { t_stats[t_statActive].linesParsed += lines; }
+static void statsWrote(size_t bytes) { t_stats[t_statActive].bytesWritten += bytes; }
+
+// fgets for data files: the line counts towards the running operation
+char *readLine(char *buf, int size, FILE *fp) {
+    if (!fgets(buf, size, fp)) return NULL;
+    size_t len = strlen(buf);
+    t_stats[t_statActive].bytesRead += len;
+    t_stats[t_statActive].linesParsed++;
+    return buf;
+}
 
+// a whole file is about to be replaced: count it and its size as written
+static void statsRewrote(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return;
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        long size = ftell(fp);
+        if (size > 0) t_stats[t_statActive].bytesWritten += (unsigned long long)size;
+    }
+    fclose(fp);
+    t_stats[t_statActive].filesRewritten++;
+}
 
+// A zeroed block for a new thread; call from the main thread before the thread starts.
+static OpStats *statsNewBlock() {
+    if (g_statBlockCount >= STATS_MAX_BLOCKS) return NULL;
+    OpStats *block = calloc(STAT_COUNT, sizeof(OpStats));
+    if (block) g_statBlocks[g_statBlockCount++] = block;
+    return block;
+}
 
+static void statsUseBlock(OpStats *block) {
+    if (block) t_stats = block;
+}
 
+// every thread's counters added up (caller frees)
+static OpStats *statsMerged() {
+    OpStats *all = calloc(STAT_COUNT, sizeof(OpStats));
+    if (!all) return NULL;
+    for (int b = 0; b < g_statBlockCount; b++) {
+        for (int i = 0; i < STAT_COUNT; i++) {
+            const OpStats *src = &g_statBlocks[b][i];
+            OpStats *dst = &all[i];
+            dst->calls += src->calls;
+            dst->bytesRead += src->bytesRead;
+            dst->bytesWritten += src->bytesWritten;
+            dst->linesParsed += src->linesParsed;
+            dst->filesRewritten += src->filesRewritten;
+            if (src->hist.total == 0) continue;
+            if (dst->hist.total == 0 || src->hist.min < dst->hist.min) dst->hist.min = src->hist.min;
+            if (src->hist.max > dst->hist.max) dst->hist.max = src->hist.max;
+            dst->hist.total += src->hist.total;
+            dst->hist.sum += src->hist.sum;
+            for (int k = 0; k < HIST_BUCKETS; k++) dst->hist.counts[k] += src->hist.counts[k];
+        }
+    }
+    return all;
+}
 
-// =========================
-// sms.c  — Part 2 of 4
-// Authentication, admissions, and ID generators
-// Notes:
-//  - ADMISSION_FILE format:
-//      tempId,name,department,semester,email,username,password,status,studentId
-//    where status is "pending" or "approved" and studentId is 0 when pending.
-//  - Approve operation now marks admission as approved (does NOT delete the admission file entry).
-//  - Username uniqueness is enforced across both LOGINS_FILE and ADMISSION_FILE.
-// =========================
+static void formatNanos(char *buf, size_t size, unsigned long long ns) {
+    if (ns < 1000ULL) snprintf(buf, size, "%lluns", ns);
+    else if (ns < 1000000ULL) snprintf(buf, size, "%.1fus", ns / 1e3);
+    else if (ns < 1000000000ULL) snprintf(buf, size, "%.1fms", ns / 1e6);
+    else snprintf(buf, size, "%.2fs", ns / 1e9);
+}
 
-/* ---------- Helper: get next IDs ---------- */
+static void formatBytes(char *buf, size_t size, double bytes) {
+    if (bytes < 1024) snprintf(buf, size, "%.0fB", bytes);
+    else if (bytes < 1024.0 * 1024) snprintf(buf, size, "%.1fKB", bytes / 1024);
+    else if (bytes < 1024.0 * 1024 * 1024) snprintf(buf, size, "%.1fMB", bytes / (1024.0 * 1024));
+    else snprintf(buf, size, "%.2fGB", bytes / (1024.0 * 1024 * 1024));
+}
 
-// returns next temp admission id (auto-increment), or 1001 if no file
-int nextAdmissionTempId() {
-    FILE *fp = fopen(ADMISSION_FILE, "r");
-    if (!fp) return 1001;
-    char line[MAX_LINE];
-    int maxId = 1000;
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-        char *tok = strtok(copy, ",");
-        if (!tok) continue;
-        int id = atoi(tok);
-        if (id > maxId) maxId = id;
+// Table of every operation that ran (or did I/O), followed by its write amplification.
+void printOperationStats(FILE *out) {
+    OpStats *all = statsMerged();
+    if (!all) return;
+    fprintf(out, "%-24s %8s %9s %9s %9s %9s %9s %9s %9s %8s\n", "Operation", "Calls", "p50", "p90", "p99",
+            "Max", "Read", "Written", "Lines", "Rewrites");
+    int any = 0;
+    for (int i = 0; i < STAT_COUNT; i++) {
+        const OpStats *st = &all[i];
+        if (st->calls == 0 && st->bytesRead == 0 && st->bytesWritten == 0) continue;
+        char p50[16], p90[16], p99[16], mx[16], rd[16], wr[16];
+        formatNanos(p50, sizeof(p50), histQuantile(&st->hist, 0.50));
+        formatNanos(p90, sizeof(p90), histQuantile(&st->hist, 0.90));
+        formatNanos(p99, sizeof(p99), histQuantile(&st->hist, 0.99));
+        formatNanos(mx, sizeof(mx), st->hist.max);
+        formatBytes(rd, sizeof(rd), (double)st->bytesRead);
+        formatBytes(wr, sizeof(wr), (double)st->bytesWritten);
+        fprintf(out, "%-24s %8llu %9s %9s %9s %9s %9s %9s %9llu %8llu\n", g_statNames[i], st->calls,
+                st->calls ? p50 : "-", st->calls ? p90 : "-", st->calls ? p99 : "-", st->calls ? mx : "-",
+                rd, wr, st->linesParsed, st->filesRewritten);
+        any = 1;
     }
-    fclose(fp);
-    return maxId + 1;
+    if (!any) {
+        fprintf(out, "(no operations recorded yet)\n");
+        free(all);
+        return;
+    }
+    fprintf(out, "\nWrite amplification:\n");
+    any = 0;
+    for (int i = 0; i < STAT_COUNT; i++) {
+        const OpStats *st = &all[i];
+        if (st->bytesWritten == 0) continue;
+        char wr[16], per[16];
+        formatBytes(wr, sizeof(wr), (double)st->bytesWritten);
+        unsigned long long calls = st->calls ? st->calls : 1;
+        formatBytes(per, sizeof(per), (double)st->bytesWritten / (double)calls);
+        fprintf(out, "  %s: rewrote %llu file(s), %s written (%.1f files, %s per call)\n", g_statNames[i],
+                st->filesRewritten, wr, (double)st->filesRewritten / (double)calls, per);
+        any = 1;
+    }
+    if (!any) fprintf(out, "  nothing written\n");
+    free(all);
 }
 
-// returns next student id based on STUDENTS_FILE, or 120 if none
-int nextStudentId() {
-    FILE *fp = fopen(STUDENTS_FILE, "r");
-    if (!fp) return 120;
-    char line[MAX_LINE];
-    int maxId = 119;
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-        char *tok = strtok(copy, ",");
-        if (!tok) continue;
-        int id = atoi(tok);
-        if (id > maxId) maxId = id;
+// Rewrite STATS_FILE with this session's numbers (registered with atexit).
+void dumpOperationStats() {
+    if (g_remote) return; // the daemon keeps the stats file
+    int any = 0;
+    for (int b = 0; b < g_statBlockCount && !any; b++) {
+        for (int i = 0; i < STAT_COUNT && !any; i++) any = g_statBlocks[b][i].calls > 0;
     }
+    if (!any) return;
+    FILE *fp = fopen(STATS_FILE, "w");
+    if (!fp) return;
+    time_t t = time(NULL);
+    char when[64];
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&t));
+    fprintf(fp, "# session ending %s\n", when);
+    printOperationStats(fp);
     fclose(fp);
-    return maxId + 1;
 }
 
-/* ---------- Username existence checks ---------- */
+// Replace dst with src in one step, so readers never see dst missing.
+// Returns 0 on success, -1 on error.
+int replaceFile(const char *src, const char *dst) {
+    statsRewrote(src);
+    markTableWritten(dst);
+#ifdef _WIN32
+    return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+#else
+    return rename(src, dst) == 0 ? 0 : -1; // rename(2) swaps atomically on POSIX
+#endif
+}
 
-// check only LOGINS_FILE (returns 1 if exists, 0 otherwise)
-int usernameExistsInLogins(const char *username) {
-    if (!username || username[0] == '\0') return 0;
-    FILE *fp = fopen(LOGINS_FILE, "r");
+int fileExists(const char *path) {
+    FILE *fp = fopen(path, "r");
     if (!fp) return 0;
-    char line[MAX_LINE];
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-        char *tok = strtok(copy, ","); // username
-        if (tok && strcmp(tok, username) == 0) {
-            fclose(fp);
-            return 1;
+    fclose(fp);
+    return 1;
+}
+
+// Create dir unless it already exists. Returns 0 on success, -1 on error.
+static int makeDir(const char *dir) {
+#ifdef _WIN32
+    return (_mkdir(dir) == 0 || errno == EEXIST) ? 0 : -1;
+#else
+    return (mkdir(dir, 0755) == 0 || errno == EEXIST) ? 0 : -1;
+#endif
+}
+
+// Monotonic clock in seconds (for throughput reports)
+double nowSeconds() {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+// printf-append into b. Returns 0 on success, -1 if memory ran out.
+int textBufPrintf(TextBuf *b, const char *fmt, ...) {
+    while (1) {
+        va_list ap;
+        va_start(ap, fmt);
+        size_t room = b->cap - b->len;
+        int n = vsnprintf(b->data ? b->data + b->len : NULL, room, fmt, ap);
+        va_end(ap);
+        if (n < 0) return -1;
+        if ((size_t)n < room) {
+            b->len += (size_t)n;
+            return 0;
         }
+        size_t cap = b->cap ? b->cap * 2 : 4096;
+        while (cap - b->len <= (size_t)n) cap *= 2;
+        char *data = realloc(b->data, cap);
+        if (!data) return -1;
+        b->data = data;
+        b->cap = cap;
     }
-    fclose(fp);
-    return 0;
 }
 
-// check ADMISSION_FILE for any entry (pending or approved) having this username
-int usernameExistsInAdmissionsPending(const char *username) {
-    if (!username || username[0] == '\0') return 0;
-    FILE *fp = fopen(ADMISSION_FILE, "r");
-    if (!fp) return 0;
-    char line[MAX_LINE];
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        // admission format:
-        // tempId,name,department,semester,email,username,password,status,studentId
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-        char *tok = strtok(copy, ","); // tempId
-        int idx = 0;
-        char *foundUser = NULL;
-        while (tok) {
-            idx++;
-            // username is the 6th field per format above
-            if (idx == 6) {
-                foundUser = tok;
-                break;
+void textBufFree(TextBuf *b) {
+    free(b->data);
+    b->data = NULL;
+    b->len = b->cap = 0;
+}
+
+// Split a line on commas in place (empty fields are kept). A field in double quotes may
+// hold commas, and "" inside it stands for one quote; it is unquoted in place.
+// Returns the number of fields.
+int splitFields(char *line, char **parts, int maxParts) {
+    int n = 0;
+    char *p = line;
+    while (n < maxParts) {
+        parts[n++] = p;
+        if (*p == '"') {
+            char *w = p, *r = p + 1;
+            while (*r) {
+                if (*r == '"' && r[1] != '"') {
+                    r++;
+                    break;
+                }
+                if (*r == '"') r++;
+                *w++ = *r++;
             }
-            tok = strtok(NULL, ",");
-        }
-        if (foundUser && strcmp(foundUser, username) == 0) {
-            fclose(fp);
-            return 1;
+            p = r;
+            char *comma = strchr(p, ',');
+            *w = '\0';
+            if (!comma) break;
+            p = comma + 1;
+            continue;
         }
+        char *comma = strchr(p, ',');
+        if (!comma) break;
+        *comma = '\0';
+        p = comma + 1;
     }
-    fclose(fp);
-    return 0;
+    return n;
 }
 
-// Combined check used at registration time: ensure username not in logins and not in any admission entry
-int usernameExists(const char *username) {
-    if (usernameExistsInLogins(username)) return 1;
-    if (usernameExistsInAdmissionsPending(username)) return 1;
-    return 0;
+// value ready to be written as one CSV field: as is, or quoted into buf (size at least
+// CSV_FIELD_SIZE(strlen(value))) when it holds a comma or a quote
+#define CSV_FIELD_SIZE(len) (2 * (len) + 3)
+
+static const char *csvField(const char *value, char *buf, size_t size) {
+    if (!strpbrk(value, ",\"")) return value;
+    size_t j = 0;
+    buf[j++] = '"';
+    for (const char *p = value; *p && j + 3 < size; p++) {
+        if (*p == '"') buf[j++] = '"';
+        buf[j++] = *p;
+    }
+    buf[j++] = '"';
+    buf[j] = '\0';
+    return buf;
 }
 
-/* ---------- Create login (append to LOGINS_FILE) ---------- */
-// returns 1 on success, 0 if username exists, -1 on error
-int createLogin(const char *username, const char *password, const char *role, int studentId) {
-    if (!username || !password || !role) return -1;
-    if (usernameExistsInLogins(username)) return 0; // already taken in confirmed logins
-    FILE *fp = fopen(LOGINS_FILE, "a");
-    if (!fp) return -1;
-    // store as: username,password,role,studentId\n
-    fprintf(fp, "%s,%s,%s,%d\n", username, password, role, studentId);
-    fclose(fp);
-    return 1;
+// Parse an id list such as "1001,1003,1010-1050" into a malloc'd array.
+// Returns number of ids (caller frees *out), or -1 on a syntax error, a negative id
+// or a list longer than MAX_ID_LIST (checked before a range is expanded).
+int parseIdList(const char *spec, int **out) {
+    *out = NULL;
+    int n = 0, cap = 0;
+    const char *p = spec;
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        if (!*p) break;
+        char *end;
+        long lo = strtol(p, &end, 10), hi;
+        if (end == p) { free(*out); *out = NULL; return -1; }
+        p = end;
+        while (*p == ' ') p++;
+        hi = lo;
+        if (*p == '-') {
+            p++;
+            hi = strtol(p, &end, 10);
+            if (end == p || hi < lo) { free(*out); *out = NULL; return -1; }
+            p = end;
+        }
+        if (lo < 0 || hi > INT_MAX || hi - lo >= MAX_ID_LIST - n) { free(*out); *out = NULL; return -1; }
+        for (long id = lo; id <= hi; id++) {
+            if (n == cap) {
+                cap = cap ? cap * 2 : 64;
+                int *grown = realloc(*out, (size_t)cap * sizeof(int));
+                if (!grown) { free(*out); *out = NULL; return -1; }
+                *out = grown;
+            }
+            (*out)[n++] = (int)id;
+        }
+        while (*p == ' ') p++;
+        if (*p && *p != ',') { free(*out); *out = NULL; return -1; }
+    }
+    return n;
 }
 
-/* ---------- Register admission (student -> pending) ---------- */
-/* returns temp admission id (>0) on success, -1 on error */
-int registerAdmission() {
-    clearScreen();
-    printBoxedTitle("Student Admission - Register");
+// -------------------------
+// Table locks and group commit
+// -------------------------
+/* Each table (a data file plus its temp files and journals) has an fcntl record lock on
+   its own 8-byte slot of LOCK_FILE, so several processes can share one data directory.
+   The slot also holds the table's generation, bumped when a holder that wrote lets go.
+   A process that finds a generation it did not write drops its resident copy of that
+   table (student table, username index, marksheet index, sequences) and reloads it.
+   An operation locks every table it needs up front, in TableId order; nested operations
+   find their tables already held. Within a process the counts are shared by the daemon's
+   workers, whose own rwlock keeps readers and a writer apart.
+
+   Appends to the journal, logins, admissions and marksheets are queued and written by
+   the last holder of the table just before it lets go: one write (and, per g_durability,
+   one fsync) per file. Batch mode and the daemon hold every table across several
+   commands, so those commands share a single commit window. */
+
+enum { TLOCK_NONE, TLOCK_SHARED, TLOCK_EXCLUSIVE };
 
-    Student s;
-    char email[128];
-    char username[MAX_USERNAME];
-    char password[MAX_PASS];
+typedef struct {
+    int fd;                             // LOCK_FILE, opened on first use
+    int held[TBL_COUNT];                // holders in this process
+    int exclusive[TBL_COUNT];
+    int written[TBL_COUNT];             // changed since the table was locked
+    unsigned long long gen[TBL_COUNT];  // generation our resident copy reflects
+#ifndef _WIN32
+    pthread_mutex_t mutex;
+#endif
+} TableLocks;
 
-    int semester = getIntInput("Enter Semester (integer): ");
-    s.semester = semester;
+static TableLocks g_locks = {
+    .fd = -1,
+#ifndef _WIN32
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+#endif
+};
 
-    getStringInput("Enter Full Name: ", s.name, sizeof(s.name));
-    if (!isValidName(s.name)) {
+// Set while a daemon reader runs: caches are shared with other readers, so a stale
+// table is left for the next write (or freshness check) to reload.
+static THREAD_LOCAL int t_readOnlyCaches = 0;
+
+typedef enum { APPEND_JOURNAL, APPEND_LOGINS, APPEND_ADMISSIONS, APPEND_MARKSHEETS, APPEND_COUNT } AppendId;
+
+typedef struct {
+    const char *path;
+    TableId table;
+    TextBuf pending;    // queued, not yet written
+    long base;          // file size below the pending bytes
+} AppendFile;
+
+static AppendFile g_appends[APPEND_COUNT] = {
+    { STUDENTS_JOURNAL, TBL_STUDENTS,   { 0 }, 0 },
+    { LOGINS_FILE,      TBL_LOGINS,     { 0 }, 0 },
+    { ADMISSION_FILE,   TBL_ADMISSIONS, { 0 }, 0 },
+    { MARKSHEET_FILE,   TBL_MARKSHEETS, { 0 }, 0 },
+};
+
+static long fileSizeOf(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return 0;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size < 0 ? 0 : size;
+}
+
+// "<path>.<pid>.tmp": a temp file no other process writes to
+static const char *processTempName(const char *path, char *buf, size_t size) {
+#ifdef _WIN32
+    snprintf(buf, size, "%s.%lu.tmp", path, (unsigned long)GetCurrentProcessId());
+#else
+    snprintf(buf, size, "%s.%ld.tmp", path, (long)getpid());
+#endif
+    return buf;
+}
+
+static void markTableWritten(const char *path) {
+    static const struct { const char *path; TableId table; } files[] = {
+        { STUDENTS_FILE, TBL_STUDENTS }, { STUDENTS_BIN_FILE, TBL_STUDENTS }, { STUDENTS_JOURNAL, TBL_STUDENTS },
+        { LOGINS_FILE, TBL_LOGINS }, { ADMISSION_FILE, TBL_ADMISSIONS }, { MARKSHEET_FILE, TBL_MARKSHEETS },
+        { SEQUENCE_FILE, TBL_SEQUENCES },
+    };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        if (strcmp(path, files[i].path) == 0) g_locks.written[files[i].table] = 1;
+    }
+}
+
+// one table's slot: take it shared / exclusive or let it go; 0 on success
+static int lockSlot(TableId t, int type) {
+#ifdef _WIN32
+    HANDLE h = (HANDLE)_get_osfhandle(g_locks.fd);
+    OVERLAPPED ov;
+    memset(&ov, 0, sizeof(ov));
+    ov.Offset = (DWORD)t * 8;
+    if (type == TLOCK_NONE) return UnlockFileEx(h, 0, 8, 0, &ov) ? 0 : -1;
+    if (type == TLOCK_EXCLUSIVE && g_locks.held[t]) UnlockFileEx(h, 0, 8, 0, &ov); // no in-place upgrade
+    return LockFileEx(h, type == TLOCK_EXCLUSIVE ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, 8, 0, &ov) ? 0 : -1;
+#else
+    struct flock fl;
+    memset(&fl, 0, sizeof(fl));
+    fl.l_type = (type == TLOCK_NONE) ? F_UNLCK : (type == TLOCK_EXCLUSIVE) ? F_WRLCK : F_RDLCK;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = (off_t)t * 8;
+    fl.l_len = 8;
+    while (fcntl(g_locks.fd, F_SETLKW, &fl) != 0) {
+        if (errno != EINTR) return -1; // EDEADLK: another process waits on a table we hold
+    }
+    return 0;
+#endif
+}
+
+static unsigned long long slotGeneration(TableId t) {
+    unsigned long long gen = 0;
+#ifdef _WIN32
+    if (_lseeki64(g_locks.fd, (long long)t * 8, SEEK_SET) < 0 || _read(g_locks.fd, &gen, sizeof(gen)) != (int)sizeof(gen)) gen = 0;
+#else
+    if (pread(g_locks.fd, &gen, sizeof(gen), (off_t)t * 8) != (ssize_t)sizeof(gen)) gen = 0;
+#endif
+    return gen;
+}
+
+static void slotSetGeneration(TableId t, unsigned long long gen) {
+#ifdef _WIN32
+    if (_lseeki64(g_locks.fd, (long long)t * 8, SEEK_SET) >= 0) _write(g_locks.fd, &gen, sizeof(gen));
+#else
+    if (pwrite(g_locks.fd, &gen, sizeof(gen), (off_t)t * 8) != (ssize_t)sizeof(gen)) return;
+#endif
+}
+
+static int openLockFile() {
+    if (g_locks.fd >= 0) return 0;
+#ifdef _WIN32
+    g_locks.fd = _open(LOCK_FILE, _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    g_locks.fd = open(LOCK_FILE, O_RDWR | O_CREAT, 0644);
+#endif
+    return g_locks.fd >= 0 ? 0 : -1;
+}
+
+// Write a file's queued appends in one go. Returns 1 on success, -1 on error (kept queued).
+static int appendCommit(AppendFile *a) {
+    if (a->pending.len == 0) return 1;
+#ifdef _WIN32
+    int fd = _open(a->path, _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int fd = open(a->path, O_WRONLY | O_APPEND | O_CREAT, 0644);
+#endif
+    if (fd < 0) return -1;
+    size_t done = 0;
+    while (done < a->pending.len) {
+#ifdef _WIN32
+        int n = _write(fd, a->pending.data + done, (unsigned int)(a->pending.len - done));
+#else
+        ssize_t n = write(fd, a->pending.data + done, a->pending.len - done);
+        if (n < 0 && errno == EINTR) continue;
+#endif
+        if (n <= 0) break;
+        done += (size_t)n;
+    }
+    int ok = (done == a->pending.len);
+#ifdef _WIN32
+    if (ok && g_durability != DURABILITY_NONE && _commit(fd) != 0) ok = 0;
+    if (_close(fd) != 0) ok = 0;
+#else
+    if (ok && g_durability != DURABILITY_NONE && fsync(fd) != 0) ok = 0;
+    if (close(fd) != 0) ok = 0;
+#endif
+    statsWrote(done);
+    if (!ok) {
+        // keep what did not make it; the file already ends with the written part
+        memmove(a->pending.data, a->pending.data + done, a->pending.len - done);
+        a->pending.len -= done;
+        a->base += (long)done;
+        return -1;
+    }
+    a->pending.len = 0;
+    return 1;
+}
+
+static int commitTable(TableId t) {
+    int ok = 1;
+    for (int i = 0; i < APPEND_COUNT; i++) {
+        if (g_appends[i].table == t && appendCommit(&g_appends[i]) != 1) ok = -1;
+    }
+    if (t == TBL_STUDENTS && g_locks.written[t] && g_durability != DURABILITY_NONE && storeSync() != 1) ok = -1;
+    return ok;
+}
+
+/* Queue text for the end of a table file. Returns the offset it will land at, or -1.
+   Without the table locked (nothing to group with) it is written at once. */
+static long appendQueue(AppendId id, const char *text) {
+    AppendFile *a = &g_appends[id];
+    if (a->pending.len == 0) a->base = fileSizeOf(a->path);
+    long off = a->base + (long)a->pending.len;
+    if (textBufPrintf(&a->pending, "%s", text) != 0) return -1;
+    g_locks.written[a->table] = 1;
+    if (!g_locks.held[a->table] && appendCommit(a) != 1) return -1;
+    return off;
+}
+
+// size of a table file including what is still queued for it
+static long appendEnd(AppendId id) {
+    AppendFile *a = &g_appends[id];
+    return a->pending.len ? a->base + (long)a->pending.len : fileSizeOf(a->path);
+}
+
+// Write out anything queued for path before reading it. Returns 1 on success, -1 on error.
+static int appendFlushPath(const char *path) {
+    for (int i = 0; i < APPEND_COUNT; i++) {
+        if (strcmp(g_appends[i].path, path) == 0) return appendCommit(&g_appends[i]);
+    }
+    return 1;
+}
+
+static void releaseSlot(TableId t) {
+    if (g_locks.written[t]) {
+        g_locks.gen[t] = slotGeneration(t) + 1;
+        slotSetGeneration(t, g_locks.gen[t]);
+        g_locks.written[t] = 0;
+    }
+    g_locks.exclusive[t] = 0;
+    lockSlot(t, TLOCK_NONE);
+}
+
+/* Lock the tables in mask (those also in exclusive for writing), in TableId order.
+   Returns 1, or -1 if a lock could not be taken (nothing new is held then). */
+static int lockTables(unsigned mask, unsigned exclusive) {
+#ifndef _WIN32
+    pthread_mutex_lock(&g_locks.mutex);
+#endif
+    int ok = (openLockFile() == 0);
+    int t = 0;
+    for (; ok && t < TBL_COUNT; t++) {
+        if (!(mask & TBL(t))) continue;
+        int want = (exclusive & TBL(t)) ? TLOCK_EXCLUSIVE : TLOCK_SHARED;
+        if (g_locks.held[t] == 0 || (want == TLOCK_EXCLUSIVE && !g_locks.exclusive[t])) {
+            if (lockSlot((TableId)t, want) != 0) {
+                ok = 0;
+                break;
+            }
+            if (want == TLOCK_EXCLUSIVE) g_locks.exclusive[t] = 1;
+            unsigned long long gen = slotGeneration((TableId)t);
+            if (g_locks.held[t] == 0 && gen != g_locks.gen[t] && !t_readOnlyCaches) {
+                tableCacheInvalidate((TableId)t);
+                g_locks.gen[t] = gen;
+            }
+        }
+        g_locks.held[t]++;
+    }
+    if (!ok) {
+        // give back what this call took
+        while (--t >= 0) {
+            if (!(mask & TBL(t))) continue;
+            if (--g_locks.held[t] == 0) releaseSlot((TableId)t);
+        }
+    }
+#ifndef _WIN32
+    pthread_mutex_unlock(&g_locks.mutex);
+#endif
+    return ok ? 1 : -1;
+}
+
+/* Let go of the tables in mask. The last holder writes the queued appends (every holder
+   does with DURABILITY_OP) and, if the table changed, bumps its generation.
+   Returns 1, or -1 if queued appends could not be written. */
+static int unlockTables(unsigned mask) {
+#ifndef _WIN32
+    pthread_mutex_lock(&g_locks.mutex);
+#endif
+    int ok = 1;
+    for (int t = TBL_COUNT - 1; t >= 0; t--) {
+        if (!(mask & TBL(t)) || g_locks.held[t] == 0) continue;
+        if ((g_locks.held[t] == 1 || g_durability == DURABILITY_OP) && commitTable((TableId)t) != 1) ok = -1;
+        if (--g_locks.held[t] == 0) releaseSlot((TableId)t);
+    }
+#ifndef _WIN32
+    pthread_mutex_unlock(&g_locks.mutex);
+#endif
+    return ok;
+}
+
+/* After a failed commit: drop whatever is still queued, and the resident copies, so the
+   next lock reloads every table from what actually reached the files. Call with no
+   tables held. */
+static void discardUncommitted() {
+    for (int i = 0; i < APPEND_COUNT; i++) g_appends[i].pending.len = 0;
+    for (int t = 0; t < TBL_COUNT; t++) tableCacheInvalidate((TableId)t);
+}
+
+// 1 if the table is locked for writing by this process
+static int tableHeldExclusive(TableId t) {
+    return g_locks.held[t] > 0 && g_locks.exclusive[t];
+}
+
+// 1 if another process changed a table we are not holding since we last looked
+static int tablesChangedElsewhere() {
+    int changed = 0;
+#ifndef _WIN32
+    pthread_mutex_lock(&g_locks.mutex);
+#endif
+    if (openLockFile() == 0) {
+        for (int t = 0; t < TBL_COUNT && !changed; t++) {
+            changed = (g_locks.held[t] == 0 && slotGeneration((TableId)t) != g_locks.gen[t]);
+        }
+    }
+#ifndef _WIN32
+    pthread_mutex_unlock(&g_locks.mutex);
+#endif
+    return changed;
+}
+
+// -------------------------
+// Record reader
+// -------------------------
+/* Data files are read through a read-only mapping of the whole file (a plain copy on
+   Windows). Every data file rewrite goes through a rename, so a mapped file is never
+   truncated under a reader. A record is one line; recordParse() cuts it into FieldView
+   slices that point into the mapping, so nothing is copied until a caller wants a
+   value. Commas, quotes and line ends are found 16 bytes at a time with SSE2 where the
+   compiler has it. A field that starts with '"' runs to the closing quote and may hold
+   commas; "" inside it stands for one quote (csvField() writes values that way). */
+
+#define REC_MAX_FIELDS 128
+
+typedef struct {
+    const char *p;          // field text, quotes stripped
+    int len;
+    int quoted;             // p may contain "" pairs
+} FieldView;
+
+typedef struct {
+    FieldView f[REC_MAX_FIELDS];
+    int n;
+    const char *line;       // the whole line, surrounding whitespace trimmed
+    int lineLen;
+    long offset;            // where the line starts in the file
+} Record;
+
+typedef struct {
+    const char *data;
+    size_t size;
+    int mapped;             // data is an mmap (else malloc'd, or NULL when empty)
+} MappedFile;
+
+typedef struct {
+    MappedFile file;
+    size_t pos;
+} RecordReader;
+
+static int lowestBit(unsigned int mask) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, mask);
+    return (int)i;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// first a, b or c in [p, end), or end
+static const char *findAny(const char *p, const char *end, char a, char b, char c) {
+#ifdef HAVE_SSE2
+    const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vc = _mm_set1_epi8(c);
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)),
+                                   _mm_cmpeq_epi8(v, vc));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask) return p + lowestBit((unsigned int)mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != a && *p != b && *p != c) p++;
+    return p;
+}
+
+// Map path for reading. Returns 1 on success (an empty file has data == NULL), 0 if the
+// file cannot be opened, -1 on error.
+static int mapFile(const char *path, MappedFile *m) {
+    memset(m, 0, sizeof(*m));
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    if (st.st_size > 0) {
+        void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        m->data = p;
+        m->size = (size_t)st.st_size;
+        m->mapped = 1;
+    }
+    close(fd);
+#else
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return 0;
+    long size = -1;
+    if (fseek(fp, 0, SEEK_END) == 0) size = ftell(fp);
+    char *copy = (size > 0) ? malloc((size_t)size) : NULL;
+    if (size < 0 || (size > 0 && (!copy || fseek(fp, 0, SEEK_SET) != 0 ||
+                                  fread(copy, 1, (size_t)size, fp) != (size_t)size))) {
+        free(copy);
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+    m->data = copy;
+    m->size = (size_t)(size > 0 ? size : 0);
+#endif
+    return 1;
+}
+
+static void unmapFile(MappedFile *m) {
+#ifndef _WIN32
+    if (m->mapped) munmap((void *)m->data, m->size);
+#else
+    free((void *)m->data);
+#endif
+    memset(m, 0, sizeof(*m));
+}
+
+// Cut [line, end) (no '\n') into at most maxFields fields; the last one stops at the next
+// comma. Returns the number of fields, 0 for a blank line.
+static int recordParse(const char *line, const char *end, Record *rec, int maxFields) {
+    while (end > line && isspace((unsigned char)end[-1])) end--;
+    while (line < end && isspace((unsigned char)*line)) line++;
+    rec->line = line;
+    rec->lineLen = (int)(end - line);
+    rec->n = 0;
+    if (line == end) return 0;
+    if (maxFields > REC_MAX_FIELDS) maxFields = REC_MAX_FIELDS;
+    const char *p = line;
+    for (;;) {
+        FieldView *f = &rec->f[rec->n++];
+        if (p < end && *p == '"') {
+            const char *q = p + 1;
+            for (;;) {
+                q = findAny(q, end, '"', '"', '"');
+                if (q + 1 < end && q[1] == '"') q += 2;
+                else break;
+            }
+            f->p = p + 1;
+            f->len = (int)(q - f->p);
+            f->quoted = 1;
+            p = findAny(q < end ? q + 1 : end, end, ',', ',', ',');
+        } else {
+            const char *q = findAny(p, end, ',', ',', ',');
+            f->p = p;
+            f->len = (int)(q - p);
+            f->quoted = 0;
+            p = q;
+        }
+        if (p >= end || rec->n == maxFields) break;
+        p++;
+    }
+    return rec->n;
+}
+
+static int recordReaderOpen(RecordReader *r, const char *path) {
+    r->pos = 0;
+    return mapFile(path, &r->file);
+}
+
+static void recordReaderClose(RecordReader *r) {
+    unmapFile(&r->file);
+}
+
+// Next non-blank line, cut into at most maxFields fields. Returns 1, or 0 at the end.
+static int recordNext(RecordReader *r, Record *rec, int maxFields) {
+    const char *end = r->file.data + r->file.size;
+    while (r->pos < r->file.size) {
+        const char *line = r->file.data + r->pos;
+        const char *nl = findAny(line, end, '\n', '\n', '\n');
+        size_t next = (size_t)(nl - r->file.data) + (nl < end);
+        statsRead(next - r->pos);
+        statsLines(1);
+        rec->offset = (long)r->pos;
+        r->pos = next;
+        if (recordParse(line, nl, rec, maxFields) > 0) return 1;
+    }
+    return 0;
+}
+
+// one past the field's raw text (its closing quote included)
+static const char *fieldEnd(const FieldView *f) {
+    return f->p + f->len + f->quoted;
+}
+
+// copy the field's value (unquoted, truncated to size - 1) into dst; returns dst
+static char *fieldCopy(const FieldView *f, char *dst, size_t size) {
+    size_t j = 0;
+    for (int i = 0; i < f->len && j + 1 < size; i++) {
+        if (f->quoted && f->p[i] == '"' && ++i == f->len) break; // "" -> "
+        dst[j++] = f->p[i];
+    }
+    dst[j] = '\0';
+    return dst;
+}
+
+static int fieldEquals(const FieldView *f, const char *s) {
+    if (!f->quoted) return strlen(s) == (size_t)f->len && memcmp(f->p, s, (size_t)f->len) == 0;
+    for (int i = 0; i < f->len; i++, s++) {
+        if (f->p[i] == '"' && ++i == f->len) break;
+        if (*s != f->p[i]) return 0;
+    }
+    return *s == '\0';
+}
+
+// atoi() on a field
+static int fieldInt(const FieldView *f) {
+    const char *p = f->p, *end = f->p + f->len;
+    while (p < end && isspace((unsigned char)*p)) p++;
+    int neg = (p < end && *p == '-');
+    if (p < end && (*p == '-' || *p == '+')) p++;
+    int v = 0;
+    while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+    return neg ? -v : v;
+}
+
+// a decimal field (CGPA, score) in hundredths; 0 when it is not a number
+static int fieldHundredths(const FieldView *f) {
+    int v = 0;
+    parseHundredths(f->p, f->p + f->len, &v);
+    return v;
+}
+
+// -------------------------
+// Parallel chunked scanner
+// -------------------------
+/* Whole-file jobs (loading the student table, replaying its journal, rebuilding the
+   marksheet index) map the file (see mapFile), cut it into newline-aligned chunks and
+   parse the chunks on several threads. A callback turns one line into a fixed-size
+   record; every thread keeps its records in its own array, and callers walk the chunks
+   in order, so they see the records in file order as the old fgets loops did.
+   Callbacks run on the scanner threads: no strtok, no stats. Small files, and Windows
+   builds, are parsed on the calling thread. */
+
+#define SCAN_MAX_THREADS 32
+#define SCAN_CHUNK_MIN   (128L * 1024)   // smallest chunk worth a thread of its own
+
+static int g_scanThreads = 0;           // --scan-threads N (0 = one per online CPU)
+
+// [line, end) is one line of the mapped file, without its '\n'; offset is where it
+// starts in the file. Fill rec and return 1 to keep the line.
+typedef int (*ScanLineFn)(const char *line, const char *end, long offset, void *rec);
+
+typedef struct {
+    const char *begin, *end;    // whole lines of the file
+    long base;                  // file offset of begin
+    ScanLineFn parse;
+    size_t recSize;
+    char *recs;                 // kept records, file order
+    int count, cap;
+    long lines;
+    int failed;                 // out of memory
+} ScanChunk;
+
+typedef struct {
+    MappedFile file;
+    long size;
+    int nChunks;
+    ScanChunk chunks[SCAN_MAX_THREADS];
+} FileScan;
+
+#define SCAN_RECORD(chunk, i) ((void *)((chunk)->recs + (size_t)(i) * (chunk)->recSize))
+
+static void *scanChunkRun(void *arg) {
+    ScanChunk *c = arg;
+    const char *p = c->begin;
+    while (p < c->end) {
+        const char *nl = findAny(p, c->end, '\n', '\n', '\n');
+        const char *next = (nl < c->end) ? nl + 1 : c->end;
+        c->lines++;
+        if (c->count == c->cap) {
+            int cap = c->cap ? c->cap * 2 : 256;
+            char *grown = realloc(c->recs, (size_t)cap * c->recSize);
+            if (!grown) {
+                c->failed = 1;
+                return NULL;
+            }
+            c->recs = grown;
+            c->cap = cap;
+        }
+        if (c->parse(p, nl, c->base + (long)(p - c->begin), SCAN_RECORD(c, c->count))) c->count++;
+        p = next;
+    }
+    return NULL;
+}
+
+static int scanThreadCount(long size) {
+#ifdef _WIN32
+    (void)size;
+    return 1;
+#else
+    int n = g_scanThreads > 0 ? g_scanThreads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > size / SCAN_CHUNK_MIN) n = (int)(size / SCAN_CHUNK_MIN);
+    if (n > SCAN_MAX_THREADS) n = SCAN_MAX_THREADS;
+    return n < 1 ? 1 : n;
+#endif
+}
+
+static void scanFree(FileScan *scan) {
+    for (int c = 0; c < scan->nChunks; c++) free(scan->chunks[c].recs);
+    unmapFile(&scan->file);
+    memset(scan, 0, sizeof(*scan));
+}
+
+// Parse every line of path into records of recSize bytes. Returns 1 on success, 0 if the
+// file cannot be opened (scan is then empty), -1 on a read error or out of memory.
+static int scanFile(const char *path, ScanLineFn parse, size_t recSize, FileScan *scan) {
+    memset(scan, 0, sizeof(*scan));
+    int r = mapFile(path, &scan->file);
+    if (r != 1) return r;
+    long size = (long)scan->file.size;
+    const char *data = scan->file.data;
+    scan->size = size;
+    statsRead((size_t)size);
+
+    // chunk k starts at the first line that begins at or after size * k / n
+    int n = scanThreadCount(size);
+    const char *end = data + size;
+    const char *p = data;
+    for (int k = 0; k < n && p < end; k++) {
+        const char *stop = end;
+        if (k + 1 < n) {
+            stop = data + size / n * (k + 1);
+            if (stop < p) stop = p;
+            const char *nl = findAny(stop, end, '\n', '\n', '\n');
+            stop = (nl < end) ? nl + 1 : end;
+        }
+        ScanChunk *c = &scan->chunks[scan->nChunks++];
+        c->begin = p;
+        c->end = stop;
+        c->base = (long)(p - data);
+        c->parse = parse;
+        c->recSize = recSize;
+        p = stop;
+    }
+
+#ifndef _WIN32
+    pthread_t threads[SCAN_MAX_THREADS];
+    int started[SCAN_MAX_THREADS] = {0};
+    for (int k = 1; k < scan->nChunks; k++) {
+        started[k] = (pthread_create(&threads[k], NULL, scanChunkRun, &scan->chunks[k]) == 0);
+    }
+    if (scan->nChunks > 0) scanChunkRun(&scan->chunks[0]);
+    for (int k = 1; k < scan->nChunks; k++) {
+        if (started[k]) pthread_join(threads[k], NULL);
+        else scanChunkRun(&scan->chunks[k]);
+    }
+#else
+    for (int k = 0; k < scan->nChunks; k++) scanChunkRun(&scan->chunks[k]);
+#endif
+
+    int failed = 0;
+    long lines = 0;
+    for (int k = 0; k < scan->nChunks; k++) {
+        failed |= scan->chunks[k].failed;
+        lines += scan->chunks[k].lines;
+    }
+    statsLines((size_t)lines);
+    if (failed) {
+        scanFree(scan);
+        return -1;
+    }
+    return 1;
+}
+
+// -------------------------
+// Terminal UI helpers
+// -------------------------
+// Print a centered, boxed title (works with typical terminal widths)
+void printBoxedTitle(const char *title) {
+    int width = 72; // target width for box (adjustable)
+    int pad = 2;
+    int tlen = (int)strlen(title);
+    int inner = width - 2; // inside width
+    if (tlen + pad * 2 > inner) {
+        // if title too long, just print simple box
+        printf("\n+-%.*s-+\n", tlen + pad*2, "----------------------------------------------------------------------");
+        printf("| %s |\n", title);
+        printf("+-%.*s-+\n\n", tlen + pad*2, "----------------------------------------------------------------------");
+        return;
+    }
+    int left = (inner - tlen) / 2;
+    int right = inner - tlen - left;
+    // top border
+    printf("\n+");
+    for (int i=0;i<inner;i++) putchar('-');
+    printf("+\n");
+    // title line
+    printf("|");
+    for (int i=0;i<left;i++) putchar(' ');
+    printf("%s", title);
+    for (int i=0;i<right;i++) putchar(' ');
+    printf("|\n");
+    // bottom border
+    printf("+");
+    for (int i=0;i<inner;i++) putchar('-');
+    printf("+\n\n");
+}
+
+// Print a centered subtitle line
+void printCenteredLine(const char *line) {
+    int width = 72;
+    int len = (int)strlen(line);
+    int left = (width - len) / 2;
+    if (left < 0) left = 0;
+    for (int i=0;i<left;i++) putchar(' ');
+    printf("%s\n", line);
+}
+
+// Small helper to print app header (used by main)
+void printAppHeader() {
+    clearScreen();
+    printBoxedTitle("DAFFODIL INTERNATIONAL UNIVERSITY (DIU)");
+    printCenteredLine("Student Management System — Terminal Edition");
+    printCenteredLine("");
+    showDateTime();
+    printf("\n");
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+// =========================
+// sms.c  — Part 2 of 4
+// Authentication, admissions, and ID generators
+// Notes:
+//  - ADMISSION_FILE format:
+//      tempId,name,department,semester,email,username,password,status,studentId
+//    where status is "pending" or "approved" and studentId is 0 when pending.
+//  - Approve operation now marks admission as approved (does NOT delete the admission file entry).
+//  - Username uniqueness is enforced across both LOGINS_FILE and ADMISSION_FILE.
+// =========================
+
+/* ---------- Helper: get next IDs ---------- */
+/* IDs come from SEQUENCE_FILE (one "name,next" line per table), kept in memory and
+   rewritten atomically whenever a block is reserved. The old max-id scans only run
+   to rebuild the counters when the file is missing. */
+
+typedef struct {
+    const char *name;
+    int first;      // id handed out when the table is empty
+    int next;
+} Sequence;
+
+static Sequence g_sequences[SEQ_COUNT] = {
+    { "students",   FIRST_STUDENT_ID, 0 },
+    { "admissions", 1001,             0 },
+};
+static int g_sequencesLoaded = 0;
+
+// highest temp id in ADMISSION_FILE, or 1000 if none (only used to rebuild the sequence)
+static int scanMaxAdmissionTempId() {
+    appendFlushPath(ADMISSION_FILE);
+    RecordReader rd;
+    if (recordReaderOpen(&rd, ADMISSION_FILE) != 1) return 1000;
+    Record rec;
+    int maxId = 1000;
+    while (recordNext(&rd, &rec, 1)) {
+        int id = fieldInt(&rec.f[0]); // tempId is the first field
+        if (id > maxId) maxId = id;
+    }
+    recordReaderClose(&rd);
+    return maxId;
+}
+
+static int saveSequences() {
+    char tmpPath[64];
+    processTempName(SEQUENCE_FILE, tmpPath, sizeof(tmpPath));
+    FILE *fp = fopen(tmpPath, "w");
+    if (!fp) return -1;
+    for (int i = 0; i < SEQ_COUNT; i++) fprintf(fp, "%s,%d\n", g_sequences[i].name, g_sequences[i].next);
+    if (fclose(fp) != 0) {
+        remove(tmpPath);
+        return -1;
+    }
+    return replaceFile(tmpPath, SEQUENCE_FILE) == 0 ? 1 : -1;
+}
+
+static void loadSequences() {
+    if (g_sequencesLoaded) return;
+    g_sequencesLoaded = 1;
+    int found = 0;
+    RecordReader rd;
+    if (recordReaderOpen(&rd, SEQUENCE_FILE) == 1) {
+        Record rec;
+        while (recordNext(&rd, &rec, 2)) {
+            if (rec.n < 2) continue;
+            for (int i = 0; i < SEQ_COUNT; i++) {
+                if (fieldEquals(&rec.f[0], g_sequences[i].name)) {
+                    g_sequences[i].next = fieldInt(&rec.f[1]);
+                    found++;
+                }
+            }
+        }
+        recordReaderClose(&rd);
+    }
+    if (found < SEQ_COUNT && lockTables(TBL(TBL_ADMISSIONS) | TBL(TBL_STUDENTS), 0) == 1) {
+        // missing or incomplete sequence file: rebuild from the tables once
+        loadStudentTable();
+        int maxStudent = studentTableMaxId();
+        g_sequences[SEQ_STUDENTS].next = (maxStudent < FIRST_STUDENT_ID) ? FIRST_STUDENT_ID : maxStudent + 1;
+        g_sequences[SEQ_ADMISSIONS].next = scanMaxAdmissionTempId() + 1;
+        unlockTables(TBL(TBL_ADMISSIONS) | TBL(TBL_STUDENTS));
+        saveSequences();
+    }
+    for (int i = 0; i < SEQ_COUNT; i++) {
+        if (g_sequences[i].next < g_sequences[i].first) g_sequences[i].next = g_sequences[i].first;
+    }
+}
+
+// Reserve `count` consecutive ids; returns the first one (or -1 if the sequence file cannot be written)
+int reserveIds(SequenceId seq, int count) {
+    if (count < 1) count = 1;
+    if (g_remote) return remoteReserveIds(seq, count);
+    if (lockTables(TBL(TBL_SEQUENCES), TBL(TBL_SEQUENCES)) != 1) return -1;
+    loadSequences();
+    int first = g_sequences[seq].next;
+    g_sequences[seq].next += count;
+    if (saveSequences() != 1) {
+        g_sequences[seq].next = first;
+        first = -1;
+    }
+    unlockTables(TBL(TBL_SEQUENCES));
+    return first;
+}
+
+// Make sure the sequence never hands out `id` again (e.g. a record added with an explicit id).
+void observeId(SequenceId seq, int id) {
+    if (lockTables(TBL(TBL_SEQUENCES), TBL(TBL_SEQUENCES)) != 1) return;
+    loadSequences();
+    if (id >= g_sequences[seq].next) {
+        g_sequences[seq].next = id + 1;
+        saveSequences();
+    }
+    unlockTables(TBL(TBL_SEQUENCES));
+}
+
+// Give back the unused tail [from, end) of a reserved block if nothing was reserved after it.
+void releaseIdTail(SequenceId seq, int from, int end) {
+    if (lockTables(TBL(TBL_SEQUENCES), TBL(TBL_SEQUENCES)) != 1) return;
+    loadSequences();
+    if (from < end && g_sequences[seq].next == end) {
+        g_sequences[seq].next = from;
+        saveSequences();
+    }
+    unlockTables(TBL(TBL_SEQUENCES));
+}
+
+// returns a fresh temp admission id (auto-increment), starting at 1001
+int nextAdmissionTempId() {
+    return reserveIds(SEQ_ADMISSIONS, 1);
+}
+
+// returns a fresh student id, starting at 120
+int nextStudentId() {
+    return reserveIds(SEQ_STUDENTS, 1);
+}
+
+/* ---------- Username index ---------- */
+/* One in-memory set of every username in LOGINS_FILE and ADMISSION_FILE, built by a
+   single scan of each file on first use and kept current by the code that appends
+   (createLogin, registerAdmission) or removes (deleteStudentRecord) entries.
+   A Bloom filter sits in front: a miss there means "definitely free" without
+   touching the hash table. Entries are never physically removed; clearing their
+   flags is enough, and the Bloom filter simply keeps the bits set. */
+
+#define UNAME_IN_LOGINS     1
+#define UNAME_IN_ADMISSIONS 2
+#define BLOOM_HASHES        7
+#define BLOOM_MIN_BITS      (1u << 16)
+
+typedef struct {
+    char *name;             // NULL = empty slot
+    unsigned char flags;    // UNAME_IN_LOGINS | UNAME_IN_ADMISSIONS (0 = removed)
+} UsernameSlot;
+
+typedef struct {
+    UsernameSlot *slots;
+    unsigned int cap;       // power of two
+    unsigned int used;
+    unsigned long long *bloom;
+    unsigned int bloomBits; // power of two
+    int loaded;
+} UsernameIndex;
+
+static UsernameIndex g_usernames;
+
+static unsigned long long hashUsername(const char *s) {
+    unsigned long long h = 1469598103934665603ULL; // FNV-1a
+    for (; *s; ++s) {
+        h ^= (unsigned char)*s;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void bloomAdd(unsigned long long h) {
+    unsigned int h1 = (unsigned int)h, h2 = (unsigned int)(h >> 32) | 1u;
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        unsigned int bit = (h1 + (unsigned int)i * h2) & (g_usernames.bloomBits - 1);
+        g_usernames.bloom[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+
+static int bloomMayContain(unsigned long long h) {
+    unsigned int h1 = (unsigned int)h, h2 = (unsigned int)(h >> 32) | 1u;
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        unsigned int bit = (h1 + (unsigned int)i * h2) & (g_usernames.bloomBits - 1);
+        if (!(g_usernames.bloom[bit >> 6] & (1ULL << (bit & 63)))) return 0;
+    }
+    return 1;
+}
+
+// (re)size the hash table and Bloom filter for `want` names, reinserting what is there
+static int usernameIndexResize(unsigned int want) {
+    unsigned int cap = 1024;
+    while (cap < want * 2) cap *= 2;
+    unsigned int bits = BLOOM_MIN_BITS;
+    while (bits < want * 10) bits *= 2; // ~10 bits per name, about 1% false positives
+    UsernameSlot *slots = calloc(cap, sizeof(UsernameSlot));
+    unsigned long long *bloom = calloc(bits / 64, sizeof(unsigned long long));
+    if (!slots || !bloom) {
+        free(slots);
+        free(bloom);
+        return -1;
+    }
+    UsernameSlot *old = g_usernames.slots;
+    unsigned int oldCap = g_usernames.cap;
+    free(g_usernames.bloom);
+    g_usernames.slots = slots;
+    g_usernames.cap = cap;
+    g_usernames.used = 0;
+    g_usernames.bloom = bloom;
+    g_usernames.bloomBits = bits;
+    for (unsigned int i = 0; i < oldCap; i++) {
+        if (!old[i].name) continue;
+        if (!old[i].flags) { free(old[i].name); continue; } // drop removed names
+        unsigned long long h = hashUsername(old[i].name);
+        unsigned int j = (unsigned int)h & (cap - 1);
+        while (slots[j].name) j = (j + 1) & (cap - 1);
+        slots[j] = old[i];
+        g_usernames.used++;
+        bloomAdd(h);
+    }
+    free(old);
+    return 0;
+}
+
+static UsernameSlot *usernameLookup(const char *username) {
+    unsigned long long h = hashUsername(username);
+    if (!bloomMayContain(h)) return NULL; // definitely free
+    unsigned int j = (unsigned int)h & (g_usernames.cap - 1);
+    while (g_usernames.slots[j].name) {
+        if (strcmp(g_usernames.slots[j].name, username) == 0) return &g_usernames.slots[j];
+        j = (j + 1) & (g_usernames.cap - 1);
+    }
+    return NULL;
+}
+
+static void usernameIndexAdd(const char *username, unsigned char flag) {
+    if (!username || username[0] == '\0' || !g_usernames.loaded) return;
+    UsernameSlot *slot = usernameLookup(username);
+    if (slot) {
+        slot->flags |= flag;
+        return;
+    }
+    if ((g_usernames.used + 1) * 2 > g_usernames.cap && usernameIndexResize(g_usernames.used + 1) != 0) return;
+    unsigned long long h = hashUsername(username);
+    unsigned int j = (unsigned int)h & (g_usernames.cap - 1);
+    while (g_usernames.slots[j].name) j = (j + 1) & (g_usernames.cap - 1);
+    g_usernames.slots[j].name = strdup(username);
+    if (!g_usernames.slots[j].name) return;
+    g_usernames.slots[j].flags = flag;
+    g_usernames.used++;
+    bloomAdd(h);
+}
+
+static void usernameIndexRemove(const char *username, unsigned char flag) {
+    if (!username || !g_usernames.loaded) return;
+    UsernameSlot *slot = usernameLookup(username);
+    if (slot) slot->flags &= (unsigned char)~flag;
+}
+
+// forget every name; the index is rebuilt from the files on next use
+static void usernameIndexClear() {
+    for (unsigned int i = 0; i < g_usernames.cap; i++) free(g_usernames.slots[i].name);
+    free(g_usernames.slots);
+    free(g_usernames.bloom);
+    memset(&g_usernames, 0, sizeof(g_usernames));
+}
+
+// username is the 1st field of LOGINS_FILE and the 6th field of ADMISSION_FILE
+static void indexUsernamesFrom(const char *path, int field, unsigned char flag) {
+    appendFlushPath(path);
+    RecordReader rd;
+    if (recordReaderOpen(&rd, path) != 1) return;
+    Record rec;
+    char username[MAX_LINE];
+    while (recordNext(&rd, &rec, field)) {
+        if (rec.n < field) continue;
+        usernameIndexAdd(fieldCopy(&rec.f[field - 1], username, sizeof(username)), flag);
+    }
+    recordReaderClose(&rd);
+}
+
+// Build the index once. Returns 1 on success, -1 if memory ran out.
+static int loadUsernameIndex() {
+    if (g_usernames.loaded) return 1;
+    if (usernameIndexResize(0) != 0) return -1;
+    g_usernames.loaded = 1;
+    indexUsernamesFrom(LOGINS_FILE, 1, UNAME_IN_LOGINS);
+    indexUsernamesFrom(ADMISSION_FILE, 6, UNAME_IN_ADMISSIONS);
+    return 1;
+}
+
+static unsigned char usernameFlags(const char *username) {
+    if (!username || username[0] == '\0') return 0;
+    if (g_remote) return remoteUsernameFlags(username);
+    if (lockTables(TBL(TBL_ADMISSIONS) | TBL(TBL_LOGINS), 0) != 1) return 0;
+    unsigned char flags = 0;
+    if (loadUsernameIndex() == 1) {
+        UsernameSlot *slot = usernameLookup(username);
+        if (slot) flags = slot->flags;
+    }
+    unlockTables(TBL(TBL_ADMISSIONS) | TBL(TBL_LOGINS));
+    return flags;
+}
+
+/* ---------- Username existence checks ---------- */
+
+// check only LOGINS_FILE (returns 1 if exists, 0 otherwise)
+int usernameExistsInLogins(const char *username) {
+    return (usernameFlags(username) & UNAME_IN_LOGINS) ? 1 : 0;
+}
+
+// check ADMISSION_FILE for any entry (pending or approved) having this username
+int usernameExistsInAdmissionsPending(const char *username) {
+    return (usernameFlags(username) & UNAME_IN_ADMISSIONS) ? 1 : 0;
+}
+
+// Combined check used at registration time: ensure username not in logins and not in any admission entry
+static int usernameExistsImpl(const char *username) {
+    return usernameFlags(username) ? 1 : 0;
+}
+
+int usernameExists(const char *username) {
+    StatScope sc = statsBegin(STAT_USERNAME_EXISTS);
+    int r = usernameExistsImpl(username);
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Create login (append to LOGINS_FILE) ---------- */
+// returns 1 on success, 0 if username exists, -1 on error
+static int createLoginImpl(const char *username, const char *password, const char *role, int studentId) {
+    if (!username || !password || !role) return -1;
+    if (usernameExistsInLogins(username)) return 0; // already taken in confirmed logins
+    // store as: username,password,role,studentId\n
+    char line[MAX_LINE], user[CSV_FIELD_SIZE(MAX_USERNAME)], pass[CSV_FIELD_SIZE(MAX_PASS)];
+    snprintf(line, sizeof(line), "%s,%s,%s,%d\n", csvField(username, user, sizeof(user)),
+             csvField(password, pass, sizeof(pass)), role, studentId);
+    if (appendQueue(APPEND_LOGINS, line) < 0) return -1;
+    usernameIndexAdd(username, UNAME_IN_LOGINS);
+    return 1;
+}
+
+int createLogin(const char *username, const char *password, const char *role, int studentId) {
+    StatScope sc = statsBegin(STAT_CREATE_LOGIN);
+    unsigned tables = TBL(TBL_ADMISSIONS) | TBL(TBL_LOGINS);
+    int r;
+    if (g_remote) {
+        r = remoteCreateLogin(username, password, role, studentId);
+    } else if (lockTables(tables, TBL(TBL_LOGINS)) != 1) {
+        r = -1;
+    } else {
+        r = createLoginImpl(username, password, role, studentId);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Create many logins with one append ---------- */
+/* status[i] (optional) gets 1 if entry i was written, 0 if its username was taken.
+   Returns number of logins created, or -1 on file error (nothing is written then). */
+static int createLoginsBatchImpl(const LoginEntry *entries, int count, int *status) {
+    if (!entries || count < 0) return -1;
+    if (loadUsernameIndex() != 1) return -1;
+    TextBuf buf = {0};
+    int created = 0;
+    for (int i = 0; i < count; i++) {
+        const LoginEntry *e = &entries[i];
+        // the index is updated as we go, so a name repeated inside the batch is caught too
+        int ok = !usernameExistsInLogins(e->username);
+        char user[CSV_FIELD_SIZE(MAX_USERNAME)], pass[CSV_FIELD_SIZE(MAX_PASS)];
+        if (ok && textBufPrintf(&buf, "%s,%s,%s,%d\n", csvField(e->username, user, sizeof(user)),
+                                csvField(e->password, pass, sizeof(pass)), e->role, e->studentId) != 0) ok = -1;
+        if (ok == 1) {
+            usernameIndexAdd(e->username, UNAME_IN_LOGINS);
+            created++;
+        }
+        if (status) status[i] = (ok == 1);
+        if (ok < 0) break;
+    }
+    int failed = (created > 0 && appendQueue(APPEND_LOGINS, buf.data) < 0);
+    if (failed) {
+        // roll the index back; nothing reached the file
+        for (int i = 0; i < count; i++) {
+            if (!status || status[i]) usernameIndexRemove(entries[i].username, UNAME_IN_LOGINS);
+            if (status) status[i] = 0;
+        }
+        textBufFree(&buf);
+        return -1;
+    }
+    textBufFree(&buf);
+    return created;
+}
+
+int createLoginsBatch(const LoginEntry *entries, int count, int *status) {
+    StatScope sc = statsBegin(STAT_CREATE_LOGINS);
+    unsigned tables = TBL(TBL_ADMISSIONS) | TBL(TBL_LOGINS);
+    int r;
+    if (g_remote) {
+        r = remoteCreateLoginsBatch(entries, count, status);
+    } else if (lockTables(tables, TBL(TBL_LOGINS)) != 1) {
+        r = -1;
+    } else {
+        r = createLoginsBatchImpl(entries, count, status);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Submit admission (no prompts) ---------- */
+/* s supplies name, department and semester. Returns temp admission id (>0) on success,
+   0 if the username is taken, -1 on error */
+static int submitAdmissionImpl(const Student *s, const char *email, const char *username, const char *password) {
+    if (usernameExists(username)) return 0;
+    int tempId = nextAdmissionTempId();
+    if (tempId < 0) return -1;
+
+    // admission format:
+    // tempId,name,department,semester,email,username,password,status,studentId
+    // status: pending (initial). studentId: 0 (initial)
+    char line[MAX_LINE * 2];
+    char name[CSV_FIELD_SIZE(MAX_NAME)], dept[CSV_FIELD_SIZE(MAX_DEPT)], mail[CSV_FIELD_SIZE(MAX_TOKEN)];
+    char user[CSV_FIELD_SIZE(MAX_USERNAME)], pass[CSV_FIELD_SIZE(MAX_PASS)];
+    snprintf(line, sizeof(line), "%d,%s,%s,%d,%s,%s,%s,pending,0\n", tempId,
+             csvField(s->name, name, sizeof(name)), csvField(s->department, dept, sizeof(dept)), s->semester,
+             csvField(email, mail, sizeof(mail)), csvField(username, user, sizeof(user)),
+             csvField(password, pass, sizeof(pass)));
+    if (appendQueue(APPEND_ADMISSIONS, line) < 0) return -1;
+    usernameIndexAdd(username, UNAME_IN_ADMISSIONS);
+    return tempId;
+}
+
+int submitAdmission(const Student *s, const char *email, const char *username, const char *password) {
+    StatScope sc = statsBegin(STAT_SUBMIT_ADMISSION);
+    unsigned tables = TBL(TBL_SEQUENCES) | TBL(TBL_ADMISSIONS) | TBL(TBL_LOGINS);
+    int r;
+    if (g_remote) {
+        r = remoteSubmitAdmission(s, email, username, password);
+    } else if (lockTables(tables, TBL(TBL_SEQUENCES) | TBL(TBL_ADMISSIONS)) != 1) {
+        r = -1;
+    } else {
+        r = submitAdmissionImpl(s, email, username, password);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Read admission requests ---------- */
+// tempId,name,department,semester,email,username,password,status,studentId (at least 6 fields)
+static void admissionFromRecord(const Record *rec, AdmissionInfo *a) {
+    const FieldView *f = rec->f;
+    int p = rec->n;
+    memset(a, 0, sizeof(*a));
+    a->tempId = fieldInt(&f[0]);
+    fieldCopy(&f[1], a->name, sizeof(a->name));
+    fieldCopy(&f[2], a->department, sizeof(a->department));
+    a->semester = fieldInt(&f[3]);
+    fieldCopy(&f[4], a->email, sizeof(a->email));
+    fieldCopy(&f[5], a->username, sizeof(a->username));
+    if (p >= 8) fieldCopy(&f[7], a->status, sizeof(a->status));
+    else strcpy(a->status, "pending");
+    a->studentId = p >= 9 ? fieldInt(&f[8]) : 0;
+}
+
+/* tempId > 0 selects that request, a non-empty username selects that applicant's
+   requests, otherwise every request is returned. Returns the number found (caller
+   frees *out), or -1 if the file cannot be read. A missing file is no requests. */
+static int listAdmissionsImpl(int tempId, const char *username, AdmissionInfo **out) {
+    *out = NULL;
+    appendFlushPath(ADMISSION_FILE);
+    RecordReader rd;
+    int r = recordReaderOpen(&rd, ADMISSION_FILE);
+    if (r != 1) return (r < 0 || fileExists(ADMISSION_FILE)) ? -1 : 0;
+    int n = 0, cap = 0;
+    Record rec;
+    while (recordNext(&rd, &rec, 9)) {
+        // tempId,name,department,semester,email,username,password,status,studentId
+        const FieldView *f = rec.f;
+        int p = rec.n;
+        if (p < 6) continue;
+        if (tempId > 0 && fieldInt(&f[0]) != tempId) continue;
+        if (username && username[0] && !fieldEquals(&f[5], username)) continue;
+        if (n == cap) {
+            cap = cap ? cap * 2 : 16;
+            AdmissionInfo *grown = realloc(*out, (size_t)cap * sizeof(AdmissionInfo));
+            if (!grown) {
+                free(*out);
+                *out = NULL;
+                recordReaderClose(&rd);
+                return -1;
+            }
+            *out = grown;
+        }
+        admissionFromRecord(&rec, &(*out)[n++]);
+        if (tempId > 0) break;
+    }
+    recordReaderClose(&rd);
+    return n;
+}
+
+/* ---------- Paged admission listing ---------- */
+// a request without a status field is pending
+static int admissionMatches(const Record *rec, const ListFilter *f) {
+    const FieldView *fv = rec->f;
+    if (f->department && f->department[0] && !fieldEquals(&fv[2], f->department)) return 0;
+    if (f->semester && fieldInt(&fv[3]) != f->semester) return 0;
+    if (f->status && f->status[0]) {
+        if (rec->n >= 8 ? !fieldEquals(&fv[7], f->status) : strcmp(f->status, "pending") != 0) return 0;
+    }
+    return 1;
+}
+
+/* One pass over the file; only matching requests are copied. A backward page keeps
+   the last `limit` matches before the cursor in a ring. */
+static int listAdmissionsPageImpl(const ListFilter *f, int cursor, int limit, int backward,
+                                  AdmissionInfo **out, ListPage *page) {
+    *out = NULL;
+    page->next = page->prev = -1;
+    AdmissionInfo *list = malloc((size_t)limit * sizeof(AdmissionInfo));
+    int *at = malloc((size_t)limit * sizeof(int));
+    if (!list || !at) {
+        free(list);
+        free(at);
+        return -1;
+    }
+    appendFlushPath(ADMISSION_FILE);
+    RecordReader rd;
+    int r = recordReaderOpen(&rd, ADMISSION_FILE);
+    if (r != 1) {
+        free(list);
+        free(at);
+        if (r < 0 || fileExists(ADMISSION_FILE)) return -1;
+        *out = calloc(1, sizeof(AdmissionInfo)); // no file: no requests
+        return *out ? 0 : -1;
+    }
+    int pos = 0, n = 0, head = 0, earlier = 0;
+    Record rec;
+    while (recordNext(&rd, &rec, 9)) {
+        if (rec.n < 6) continue;
+        int here = pos++;
+        if (!admissionMatches(&rec, f)) continue;
+        if (!backward && here < cursor) {
+            earlier = 1;
+            continue;
+        }
+        if (backward ? here >= cursor : n == limit) {
+            page->next = here;
+            break;
+        }
+        int slot = (head + n) % limit;
+        if (n == limit) {
+            earlier = 1; // the oldest match drops off the front of the ring
+            slot = head;
+            head = (head + 1) % limit;
+        } else {
+            n++;
+        }
+        admissionFromRecord(&rec, &list[slot]);
+        at[slot] = here;
+    }
+    recordReaderClose(&rd);
+    if (head) { // rotate the ring into file order
+        AdmissionInfo *ordered = malloc((size_t)limit * sizeof(AdmissionInfo));
+        int *orderedAt = malloc((size_t)limit * sizeof(int));
+        if (!ordered || !orderedAt) {
+            free(ordered);
+            free(orderedAt);
+            free(list);
+            free(at);
+            return -1;
+        }
+        for (int i = 0; i < n; i++) {
+            ordered[i] = list[(head + i) % limit];
+            orderedAt[i] = at[(head + i) % limit];
+        }
+        free(list);
+        free(at);
+        list = ordered;
+        at = orderedAt;
+    }
+    if (n && earlier) page->prev = at[0];
+    free(at);
+    *out = list;
+    return n;
+}
+
+int listAdmissionsPage(const ListFilter *f, int cursor, int limit, int backward, AdmissionInfo **out, ListPage *page) {
+    StatScope sc = statsBegin(STAT_ADMISSIONS_PAGE);
+    ListFilter any = {0};
+    if (!f) f = &any;
+    if (limit <= 0) limit = 1;
+    if (cursor < 0) cursor = 0;
+    int r;
+    if (g_remote) {
+        r = remoteListAdmissionsPage(f, cursor, limit, backward, out, page);
+    } else if (lockTables(TBL(TBL_ADMISSIONS), 0) != 1) {
+        *out = NULL;
+        page->next = page->prev = -1;
+        r = -1;
+    } else {
+        r = listAdmissionsPageImpl(f, cursor, limit, backward, out, page);
+        unlockTables(TBL(TBL_ADMISSIONS));
+    }
+    statsEnd(sc);
+    return r;
+}
+
+int listAdmissions(int tempId, const char *username, AdmissionInfo **out) {
+    StatScope sc = statsBegin(STAT_LIST_ADMISSIONS);
+    int r;
+    if (g_remote) {
+        r = remoteListAdmissions(tempId, username, out);
+    } else if (lockTables(TBL(TBL_ADMISSIONS), 0) != 1) {
+        *out = NULL;
+        r = -1;
+    } else {
+        r = listAdmissionsImpl(tempId, username, out);
+        unlockTables(TBL(TBL_ADMISSIONS));
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Register admission (student -> pending) ---------- */
+/* returns temp admission id (>0) on success, -1 on error */
+int registerAdmission() {
+    clearScreen();
+    printBoxedTitle("Student Admission - Register");
+
+    Student s;
+    char email[128];
+    char username[MAX_USERNAME];
+    char password[MAX_PASS];
+
+    int semester = getIntInput("Enter Semester (integer): ");
+    s.semester = semester;
+
+    getStringInput("Enter Full Name: ", s.name, sizeof(s.name));
+    if (!isValidName(s.name)) {
         printf("❌ Invalid name. Use letters, spaces, . or - only.\n");
         return -1;
     }
 
-    getStringInput("Enter Department: ", s.department, sizeof(s.department));
-    getStringInput("Enter Email: ", email, sizeof(email));
-    if (!isValidEmail(email)) {
-        printf("❌ Invalid email format.\n");
+    getStringInput("Enter Department: ", s.department, sizeof(s.department));
+    getStringInput("Enter Email: ", email, sizeof(email));
+    if (!isValidEmail(email)) {
+        printf("❌ Invalid email format.\n");
+        return -1;
+    }
+
+    // username / password for future login (will be active only after approval)
+    while (1) {
+        getStringInput("Choose Username: ", username, sizeof(username));
+        if (usernameExists(username)) {
+            printf("❌ Username already taken (either in system or a pending request). Choose another.\n");
+            continue;
+        }
+        break;
+    }
+    getStringInput("Choose Password: ", password, sizeof(password));
+
+    int tempId = submitAdmission(&s, email, username, password);
+    if (tempId == 0) {
+        printf("❌ Username already taken (either in system or a pending request).\n");
+        return -1;
+    }
+    if (tempId < 0) {
+        printf("❌ Unable to save admission request (%s / %s).\n", ADMISSION_FILE, SEQUENCE_FILE);
+        return -1;
+    }
+
+    printf("✅ Admission request saved with temporary ID: %d\n", tempId);
+    printf("ℹ️  Your request is pending. After admin approval you'll be able to login.\n");
+    return tempId;
+}
+
+/* ---------- Batch admission approval ---------- */
+/* Approves every requested temp id with one read and one rewrite of ADMISSION_FILE,
+   one batched insert into the student store and one append to LOGINS_FILE.
+   tempIds == NULL approves every pending entry. On return *outResults holds one
+   entry per distinct requested id (or per pending entry), to be released with free().
+   Returns number approved, or -1 on error (the admission file is then unchanged). */
+
+typedef struct {
+    int tempId;
+    int result;     // index into the results array
+} WantedId;
+
+static int compareWanted(const void *a, const void *b) {
+    int x = ((const WantedId *)a)->tempId, y = ((const WantedId *)b)->tempId;
+    return (x > y) - (x < y);
+}
+
+// repeats of a temp id ordered by position in the request
+static int compareWantedFirst(const void *a, const void *b) {
+    int c = compareWanted(a, b);
+    if (c != 0) return c;
+    int x = ((const WantedId *)a)->result, y = ((const WantedId *)b)->result;
+    return (x > y) - (x < y);
+}
+
+static int approveAdmissionsBatchImpl(const int *tempIds, int count, ApprovalResult **outResults, int *outCount) {
+    *outResults = NULL;
+    *outCount = 0;
+    appendFlushPath(ADMISSION_FILE);
+    FILE *fp = fopen(ADMISSION_FILE, "rb");
+    if (!fp) return -1;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *text = malloc((size_t)size + 1);
+    if (!text || fread(text, 1, (size_t)size, fp) != (size_t)size) {
+        free(text);
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+    text[size] = '\0';
+    statsRead((size_t)size);
+
+    // split into lines (in place)
+    int nLines = 0, capLines = 1024;
+    char **lines = malloc((size_t)capLines * sizeof(char *));
+    for (char *p = text; lines && *p; ) {
+        char *nl = strchr(p, '\n');
+        if (nl) *nl = '\0';
+        if (nLines == capLines) {
+            capLines *= 2;
+            char **grown = realloc(lines, (size_t)capLines * sizeof(char *));
+            if (!grown) { free(lines); lines = NULL; break; }
+            lines = grown;
+        }
+        trim(p);
+        lines[nLines++] = p;
+        if (!nl) break;
+        p = nl + 1;
+    }
+    statsLines((size_t)nLines);
+
+    WantedId *wanted = NULL;
+    int *uniqueIds = NULL;
+    if (tempIds && count > 0) {
+        wanted = malloc((size_t)count * sizeof(WantedId));
+        uniqueIds = malloc((size_t)count * sizeof(int));
+        if (wanted && uniqueIds) {
+            for (int i = 0; i < count; i++) {
+                wanted[i].tempId = tempIds[i];
+                wanted[i].result = i;
+            }
+            qsort(wanted, (size_t)count, sizeof(WantedId), compareWantedFirst);
+            // a repeated temp id is approved and reported once, at its first position
+            for (int i = 0; i < count; i++) uniqueIds[i] = 1;
+            for (int i = 1; i < count; i++) {
+                if (wanted[i].tempId == wanted[i - 1].tempId) uniqueIds[wanted[i].result] = 0;
+            }
+            int n = 0;
+            for (int i = 0; i < count; i++) {
+                if (uniqueIds[i]) uniqueIds[n++] = tempIds[i]; // n <= i: that flag was already read
+            }
+            tempIds = uniqueIds;
+            count = n;
+            for (int i = 0; i < count; i++) {
+                wanted[i].tempId = tempIds[i];
+                wanted[i].result = i;
+            }
+            qsort(wanted, (size_t)count, sizeof(WantedId), compareWanted);
+        }
+    }
+    int maxResults = tempIds ? count : nLines;
+    ApprovalResult *results = calloc((size_t)(maxResults > 0 ? maxResults : 1), sizeof(ApprovalResult));
+    int *lineOf = malloc((size_t)(maxResults > 0 ? maxResults : 1) * sizeof(int));   // admission line per result
+    Student *students = malloc((size_t)(maxResults > 0 ? maxResults : 1) * sizeof(Student));
+    LoginEntry *logins = malloc((size_t)(maxResults > 0 ? maxResults : 1) * sizeof(LoginEntry));
+    int *loginOk = malloc((size_t)(maxResults > 0 ? maxResults : 1) * sizeof(int));
+    int *resultOf = malloc((size_t)(nLines > 0 ? nLines : 1) * sizeof(int));     // result per admission line
+    if (!lines || (tempIds && count > 0 && (!wanted || !uniqueIds)) || !results || !lineOf || !students || !logins || !loginOk || !resultOf) {
+        free(text); free(lines); free(wanted); free(uniqueIds); free(results); free(lineOf); free(students); free(logins); free(loginOk); free(resultOf);
+        return -1;
+    }
+    for (int i = 0; i < maxResults; i++) lineOf[i] = -1;
+    for (int l = 0; l < nLines; l++) resultOf[l] = -1;
+
+    // 1) pick the entries to approve
+    int nResults = 0;
+    if (tempIds) {
+        for (int i = 0; i < count; i++) {
+            results[i].tempId = tempIds[i];
+            results[i].result = APPROVE_NOT_FOUND;
+        }
+        nResults = count;
+    }
+    for (int l = 0; l < nLines; l++) {
+        if (lines[l][0] == '\0') continue;
+        int tid = atoi(lines[l]);
+        int r = -1;
+        if (tempIds) {
+            WantedId key = { tid, 0 };
+            WantedId *w = bsearch(&key, wanted, (size_t)count, sizeof(WantedId), compareWanted);
+            if (!w || lineOf[w->result] >= 0) continue;
+            r = w->result;
+        } else {
+            r = nResults;
+        }
+
+        Record rec;
+        int p = recordParse(lines[l], lines[l] + strlen(lines[l]), &rec, 9);
+        char status[MAX_STATUS] = "pending";
+        if (p >= 8) fieldCopy(&rec.f[7], status, sizeof(status));
+        int linkedId = (p >= 9) ? fieldInt(&rec.f[8]) : 0;
+        if (!tempIds && strcmp(status, "pending") != 0) continue; // "all pending" skips approved ones
+        if (!tempIds) {
+            results[r].tempId = tid;
+            nResults++;
+        }
+        lineOf[r] = l;
+        resultOf[l] = r;
+        if (p < 7) {
+            results[r].result = APPROVE_MALFORMED;
+        } else if (strcmp(status, "approved") == 0 && linkedId > 0) {
+            results[r].result = APPROVE_ALREADY;
+            results[r].studentId = linkedId;
+        } else {
+            results[r].result = APPROVE_OK; // tentatively
+        }
+    }
+
+    // 2) username checks (against logins and earlier entries of this batch), then one id block
+    int nApprove = 0;
+    for (int i = 0; i < nResults; i++) {
+        if (results[i].result != APPROVE_OK) continue;
+        const char *line = lines[lineOf[i]];
+        Record rec;
+        recordParse(line, line + strlen(line), &rec, 7);
+        LoginEntry *e = &logins[nApprove];
+        fieldCopy(&rec.f[5], e->username, sizeof(e->username));
+        fieldCopy(&rec.f[6], e->password, sizeof(e->password));
+        strcpy(e->role, "student");
+        int dup = usernameExistsInLogins(e->username);
+        for (int k = 0; k < nApprove && !dup; k++) dup = (strcmp(logins[k].username, e->username) == 0);
+        if (dup) {
+            results[i].result = APPROVE_USERNAME_TAKEN;
+            continue;
+        }
+        Student *s = &students[nApprove];
+        memset(s, 0, sizeof(*s));
+        fieldCopy(&rec.f[1], s->name, sizeof(s->name));
+        fieldCopy(&rec.f[2], s->department, sizeof(s->department));
+        s->semester = fieldInt(&rec.f[3]);
+        s->cgpa = 0;
+        results[i].studentId = nApprove; // slot in students[]/logins[] until real ids are assigned
+        nApprove++;
+    }
+
+    int rc = 0, inserted = 0;
+    if (nApprove > 0) {
+        int firstId = reserveIds(SEQ_STUDENTS, nApprove);
+        if (firstId < 0) rc = -1;
+        for (int k = 0; k < nApprove && rc == 0; k++) {
+            students[k].id = firstId + k;
+            logins[k].studentId = firstId + k;
+        }
+        // 3) one batched insert into the student store, one append to LOGINS_FILE
+        if (rc == 0 && addStudentRecordsBatch(students, nApprove, loginOk) != nApprove) {
+            // through --connect some students may be in before the failure
+            for (int k = 0; k < nApprove; k++) {
+                if (loginOk[k]) deleteStudentRecord(students[k].id);
+            }
+            rc = -1;
+        }
+        if (rc == 0 && createLoginsBatch(logins, nApprove, loginOk) < 0) {
+            // undo; deleting a student also drops any login already written for it
+            for (int k = 0; k < nApprove; k++) deleteStudentRecord(students[k].id);
+            rc = -1;
+        }
+        if (rc == 0) {
+            // a login can still be refused if its name appeared after step 2; undo just those students
+            for (int k = 0; k < nApprove; k++) {
+                if (!loginOk[k]) deleteStudentRecord(students[k].id);
+            }
+            inserted = 1;
+        }
+    }
+
+    // 4) rewrite the admission file once
+    if (rc == 0) {
+        for (int i = 0; i < nResults; i++) {
+            if (results[i].result != APPROVE_OK) continue;
+            int k = results[i].studentId;
+            if (!loginOk[k]) {
+                results[i].result = APPROVE_USERNAME_TAKEN;
+                results[i].studentId = 0;
+                continue;
+            }
+            results[i].studentId = students[k].id;
+        }
+        char tmpPath[64];
+        processTempName(ADMISSION_FILE, tmpPath, sizeof(tmpPath));
+        FILE *tmp = fopen(tmpPath, "w");
+        if (!tmp) rc = -1;
+        for (int l = 0; tmp && l < nLines; l++) {
+            int approvedAs = resultOf[l];
+            if (approvedAs < 0 || results[approvedAs].result != APPROVE_OK) {
+                fprintf(tmp, "%s\n", lines[l]);
+                continue;
+            }
+            // tempId,name,department,semester,email,username,password,status,studentId:
+            // the first seven fields are kept as written
+            Record rec;
+            recordParse(lines[l], lines[l] + strlen(lines[l]), &rec, 7);
+            fprintf(tmp, "%.*s,approved,%d\n", (int)(fieldEnd(&rec.f[6]) - lines[l]), lines[l],
+                    results[approvedAs].studentId);
+        }
+        if (tmp && fclose(tmp) != 0) rc = -1;
+        if (rc == 0 && replaceFile(tmpPath, ADMISSION_FILE) != 0) rc = -1;
+        if (rc != 0 && tmp) remove(tmpPath);
+    }
+    if (rc != 0 && inserted) {
+        // the admission file still says pending: take the new students and their logins
+        // back out, so the entries can be approved again
+        int n = 0;
+        for (int k = 0; k < nApprove; k++) {
+            if (loginOk[k]) lineOf[n++] = students[k].id; // lineOf is no longer needed
+        }
+        if (n > 0) deleteStudentsBatch(lineOf, n);
+    }
+
+    int approved = 0;
+    for (int i = 0; i < nResults; i++) {
+        if (rc != 0 && results[i].result == APPROVE_OK) {
+            results[i].result = APPROVE_ERROR;
+            results[i].studentId = 0;
+        }
+        if (results[i].result == APPROVE_OK) approved++;
+    }
+    free(text); free(lines); free(wanted); free(uniqueIds); free(lineOf); free(students); free(logins); free(loginOk); free(resultOf);
+    *outResults = results;
+    *outCount = nResults;
+    return (rc == 0) ? approved : -1;
+}
+
+int approveAdmissionsBatch(const int *tempIds, int count, ApprovalResult **outResults, int *outCount) {
+    StatScope sc = statsBegin(STAT_APPROVE_BATCH);
+    int r;
+    if (g_remote) {
+        r = remoteApproveAdmissionsBatch(tempIds, count, outResults, outCount);
+    } else if (lockTables(TBL_ALL, TBL_ALL) != 1) {
+        *outResults = NULL;
+        *outCount = 0;
+        r = -1;
+    } else {
+        r = approveAdmissionsBatchImpl(tempIds, count, outResults, outCount);
+        if (unlockTables(TBL_ALL) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+const char *approvalResultText(int result) {
+    switch (result) {
+        case APPROVE_OK:             return "approved";
+        case APPROVE_NOT_FOUND:      return "not found";
+        case APPROVE_ALREADY:        return "already approved";
+        case APPROVE_USERNAME_TAKEN: return "username taken";
+        case APPROVE_MALFORMED:      return "malformed entry";
+        default:                     return "error";
+    }
+}
+
+/* ---------- Approve admission by temp id ---------- */
+/* returns 1 on success, 0 if not found, -1 on error */
+static int approveAdmissionByIdImpl(int admissionTempId) {
+    if (!g_remote && !fileExists(ADMISSION_FILE)) {
+        printf("❌ %s not found.\n", ADMISSION_FILE);
+        return -1;
+    }
+    ApprovalResult *results = NULL;
+    int n = 0;
+    int r = approveAdmissionsBatch(&admissionTempId, 1, &results, &n);
+    if (r < 0 || n < 1) {
+        printf("❌ Error updating admission file.\n");
+        free(results);
+        return -1;
+    }
+    ApprovalResult res = results[0];
+    free(results);
+    switch (res.result) {
+        case APPROVE_OK:
+            printf("✅ Admission %d approved. Assigned Student ID: %d\n", res.tempId, res.studentId);
+            return 1;
+        case APPROVE_ALREADY:
+            printf("ℹ️ Admission %d already approved (Student ID %d).\n", res.tempId, res.studentId);
+            return 0;
+        case APPROVE_USERNAME_TAKEN:
+            printf("❌ Cannot approve admission %d — username already exists in system. Ask applicant to choose a different username.\n", res.tempId);
+            return 0;
+        case APPROVE_MALFORMED:
+            printf("❌ Malformed admission entry for tempId %d. Skipping.\n", res.tempId);
+            return 0;
+        case APPROVE_NOT_FOUND:
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+int approveAdmissionById(int admissionTempId) {
+    StatScope sc = statsBegin(STAT_APPROVE);
+    int r = approveAdmissionByIdImpl(admissionTempId);
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- User login (checks LOGINS_FILE) ---------- */
+/* outRole must be large enough (>=16). outStudentId pointer is required.
+   Returns 1 on success, 0 on failure */
+static int loginUserImpl(const char *username, const char *password, char *outRole, int *outStudentId) {
+    if (!username || !password || !outRole || !outStudentId) return 0;
+    if (!usernameExistsInLogins(username)) return 0; // unknown name: no need to scan the file
+    appendFlushPath(LOGINS_FILE);
+    RecordReader rd;
+    if (recordReaderOpen(&rd, LOGINS_FILE) != 1) return 0;
+    Record rec;
+    int success = 0;
+    while (recordNext(&rd, &rec, 4)) {
+        // format: username,password,role,studentId
+        if (rec.n != 4) continue;
+        if (fieldEquals(&rec.f[0], username) && fieldEquals(&rec.f[1], password)) {
+            fieldCopy(&rec.f[2], outRole, 16);
+            *outStudentId = fieldInt(&rec.f[3]);
+            success = 1;
+            break;
+        }
+    }
+    recordReaderClose(&rd);
+    return success;
+}
+
+int loginUser(const char *username, const char *password, char *outRole, int *outStudentId) {
+    StatScope sc = statsBegin(STAT_LOGIN);
+    unsigned tables = TBL(TBL_ADMISSIONS) | TBL(TBL_LOGINS);
+    int r = 0;
+    if (g_remote) {
+        r = remoteLoginUser(username, password, outRole, outStudentId);
+    } else if (lockTables(tables, 0) == 1) {
+        r = loginUserImpl(username, password, outRole, outStudentId);
+        unlockTables(tables);
+    }
+    statsEnd(sc);
+    return r;
+}
+
+
+
+
+
+
+
+// =========================
+// sms.c  — Part 3 of 4
+// Student CRUD and Marksheet functions
+// Students are served from a resident table (hash index on id) that is loaded
+// once at startup; students.txt stays the durable copy.
+// =========================
+
+/* ---------- Department dictionary ---------- */
+/* Department names are interned to small ids, numbered in order of first use, so
+   per-row department data takes two bytes instead of the name. Ids are never reused
+   or renumbered; the dictionary only grows, and only on the write path. Names sit in
+   fixed pages that never move, so snapshot readers can turn an id back into a name
+   while a writer adds more. */
+
+#define DEPT_NONE       0xFFFF  // no department (deleted row, or the dictionary is full)
+#define DEPT_PAGE_BITS  8
+#define DEPT_PAGE_NAMES (1 << DEPT_PAGE_BITS)
+
+typedef struct {
+    char (*pages[(DEPT_NONE + 1) / DEPT_PAGE_NAMES])[MAX_DEPT];
+    int count;
+    int *slots;             // open addressing: id + 1, 0 = empty
+    int slotCap;            // power of two
+} DeptDict;
+
+static DeptDict g_depts;
+
+static const char *departmentName(int id) {
+    if (id < 0 || id >= DEPT_NONE || !g_depts.pages[id >> DEPT_PAGE_BITS]) return "";
+    return g_depts.pages[id >> DEPT_PAGE_BITS][id & (DEPT_PAGE_NAMES - 1)];
+}
+
+static unsigned int hashDeptName(const char *s) {
+    unsigned int h = 2166136261u; // FNV-1a
+    while (*s) h = (h ^ (unsigned char)*s++) * 16777619u;
+    return h;
+}
+
+static int deptSlotsGrow() {
+    int cap = g_depts.slotCap ? g_depts.slotCap * 2 : 64;
+    int *slots = calloc((size_t)cap, sizeof(int));
+    if (!slots) return -1;
+    for (int id = 0; id < g_depts.count; id++) {
+        unsigned int i = hashDeptName(departmentName(id)) & (unsigned int)(cap - 1);
+        while (slots[i]) i = (i + 1) & (unsigned int)(cap - 1);
+        slots[i] = id + 1;
+    }
+    free(g_depts.slots);
+    g_depts.slots = slots;
+    g_depts.slotCap = cap;
+    return 0;
+}
+
+// slot holding name, or the empty slot where it would go (needs slotCap > 0)
+static unsigned int deptSlotOf(const char *name) {
+    unsigned int mask = (unsigned int)g_depts.slotCap - 1;
+    unsigned int i = hashDeptName(name) & mask;
+    while (g_depts.slots[i] && strcmp(departmentName(g_depts.slots[i] - 1), name) != 0) i = (i + 1) & mask;
+    return i;
+}
+
+// id of a known department name, DEPT_NONE if it was never interned (never adds)
+static int departmentLookup(const char *name) {
+    if (!g_depts.slotCap) return DEPT_NONE;
+    int id = g_depts.slots[deptSlotOf(name)] - 1;
+    return id < 0 ? DEPT_NONE : id;
+}
+
+/* The same for a snapshot reader, which must not touch the hash slots (a writer may
+   be growing them): a walk over the first n ids, the dictionary as it was published. */
+static int departmentScan(const char *name, int n) {
+    for (int id = 0; id < n; id++) {
+        if (strcmp(departmentName(id), name) == 0) return id;
+    }
+    return DEPT_NONE;
+}
+
+// id of a department name, added if new; DEPT_NONE if it cannot be added
+static int departmentId(const char *name) {
+    if ((g_depts.count + 1) * 2 > g_depts.slotCap && deptSlotsGrow() != 0) return DEPT_NONE;
+    unsigned int i = deptSlotOf(name);
+    if (g_depts.slots[i]) return g_depts.slots[i] - 1;
+    if (g_depts.count == DEPT_NONE) return DEPT_NONE;
+    int id = g_depts.count;
+    char (*page)[MAX_DEPT] = g_depts.pages[id >> DEPT_PAGE_BITS];
+    if (!page) {
+        page = calloc(DEPT_PAGE_NAMES, MAX_DEPT);
+        if (!page) return DEPT_NONE;
+        g_depts.pages[id >> DEPT_PAGE_BITS] = page;
+    }
+    snprintf(page[id & (DEPT_PAGE_NAMES - 1)], MAX_DEPT, "%s", name);
+    g_depts.count++;
+    g_depts.slots[i] = id + 1;
+    return id;
+}
+
+/* ---------- Name arena ---------- */
+/* Student names are bump-allocated, NUL-terminated, into chunks of NAME_CHUNK_SIZE
+   bytes, and a row refers to its name by offset and length. A name never straddles
+   two chunks, and chunks never move, so an offset stays good for as long as its arena
+   lives. Renames and deletes leave dead bytes behind; once they are half of an arena
+   past its first chunk, studentTableCompact copies the live names into a new arena
+   and retires the old one (snapshots published before that keep reading it). */
+
+#define NAME_CHUNK_BITS 20
+#define NAME_CHUNK_SIZE (1u << NAME_CHUNK_BITS)
+#define NAME_MAX_CHUNKS 4096    // offsets are 32 bits: 4 GB of names
+
+typedef struct {
+    char *chunks[NAME_MAX_CHUNKS];
+    int nChunks;
+    unsigned long long used;    // next free offset
+    unsigned long long dead;    // bytes of names no row refers to any more
+} NameArena;
+
+static NameArena *g_nameArena;  // names of the working table
+
+static const char *arenaName(const NameArena *a, unsigned int off) {
+    return a->chunks[off >> NAME_CHUNK_BITS] + (off & (NAME_CHUNK_SIZE - 1));
+}
+
+// copy the len bytes of name into a; 0 and its offset in *off, or -1 when out of memory
+static int arenaAdd(NameArena *a, const char *name, size_t len, unsigned int *off) {
+    unsigned long long at = a->used;
+    if ((at & (NAME_CHUNK_SIZE - 1)) + len + 1 > NAME_CHUNK_SIZE) at = (at | (NAME_CHUNK_SIZE - 1)) + 1;
+    int chunk = (int)(at >> NAME_CHUNK_BITS);
+    if (chunk >= NAME_MAX_CHUNKS) return -1;
+    if (chunk == a->nChunks) {
+        a->chunks[chunk] = malloc(NAME_CHUNK_SIZE);
+        if (!a->chunks[chunk]) return -1;
+        a->nChunks++;
+    }
+    char *p = a->chunks[chunk] + (at & (NAME_CHUNK_SIZE - 1));
+    memcpy(p, name, len);
+    p[len] = '\0';
+    *off = (unsigned int)at;
+    a->used = at + len + 1;
+    return 0;
+}
+
+/* ---------- Resident student table ---------- */
+/* students.txt is parsed once into memory. Rows keep file order (so listings look
+   the same as before) and an open-addressing hash index maps Student.id -> row.
+   Every CRUD function below reads through the table and writes through to
+   STUDENTS_FILE, which remains the durable copy. */
+
+#define SLOT_EMPTY      (-1)
+#define SLOT_DELETED    (-2)
+#define TABLE_MIN_SLOTS 1024
+
+/* A resident row. The strings are not inline: the name is in the name arena and the
+   department is a dictionary id, which takes a row from sizeof(Student) to 20 bytes.
+   Code outside the table works on the Student that studentView() fills in. */
+typedef struct {
+    int id;
+    unsigned int nameOff;       // in the name arena
+    int semester;
+    int cgpa;                   // hundredths
+    unsigned short dept;        // department id
+    unsigned char nameLen;
+} StudentRec;
+
+typedef struct {
+    StudentRec *rows;       // file order; rows with live[i] == 0 were deleted
+    unsigned char *live;
+    int count;              // rows in use (live + deleted)
+    int capacity;
+    int liveCount;
+    int maxId;              // highest id ever inserted (0 if none)
+    int *slots;             // hash index: row number, SLOT_EMPTY or SLOT_DELETED
+    int slotCap;            // always a power of two
+    int slotUsed;           // occupied + deleted slots
+    int loaded;
+} StudentTable;
+
+static StudentTable g_students;
+
+// the Student a row stands for; names is the arena the row's name was added to
+static void studentView(const StudentRec *r, const NameArena *names, Student *out) {
+    out->id = r->id;
+    memcpy(out->name, arenaName(names, r->nameOff), (size_t)r->nameLen + 1);
+    strcpy(out->department, departmentName(r->dept));
+    out->semester = r->semester;
+    out->cgpa = r->cgpa;
+}
+
+// row `row` of the working table as a Student
+static void studentAt(int row, Student *out) {
+    studentView(&g_students.rows[row], g_nameArena, out);
+}
+
+/* ---------- Student snapshots (MVCC) ---------- */
+/* Long readers (listings, reports) walk an immutable version of the table instead of
+   holding the daemon's table lock, so they neither wait for writers nor hold them up.
+   A version is a list of pages of SNAP_PAGE_ROWS rows. After a write, only the pages
+   it touched are copied into the next version; every other page is shared with the
+   previous one (copy-on-write). A reader pins the current epoch before loading the
+   version pointer. A replaced page or version (or name arena) is freed once no reader
+   pinned at or before its retirement remains (epoch-based reclamation). Publishing
+   happens on the write path, which is already serialized. */
+
+#define SNAP_PAGE_ROWS   128
+#define SNAP_MAX_READERS 128    // threads that ever pin (daemon workers, main thread)
+
+typedef struct {
+    StudentRec rows[SNAP_PAGE_ROWS];
+    unsigned char live[SNAP_PAGE_ROWS];
+} StudentPage;
+
+typedef struct {
+    StudentPage **pages;
+    int nPages;
+    int count;          // rows, deleted ones included
+    int liveCount;
+    const NameArena *names;     // the arena the rows' names are in
+    int nDepts;         // department ids in use when published
+} StudentVersion;
+
+typedef struct {
+    void *ptr;
+    unsigned long long epoch;   // global epoch when it was replaced
+} RetiredBlock;
+
+static _Atomic(StudentVersion *) g_snapCurrent = NULL;
+static atomic_ullong g_snapEpoch = 1;
+static atomic_ullong g_snapPins[SNAP_MAX_READERS];  // epoch pinned by each reader, 0 = idle
+static atomic_int g_snapReaders = 0;
+static THREAD_LOCAL int t_snapSlot = -1;
+static THREAD_LOCAL int t_snapDepth = 0;
+
+static unsigned char *g_snapDirty;  // one flag per page of the working table
+static int g_snapDirtyCap;
+static int g_snapAllDirty = 1;      // rows moved (load, compaction): copy every page
+static RetiredBlock *g_retired;
+static int g_retiredCount, g_retiredCap;
+
+// the working table changed this row; the next publish copies its page
+static void studentRowChanged(int row) {
+    int page = row / SNAP_PAGE_ROWS;
+    if (page >= g_snapDirtyCap) {
+        int cap = g_snapDirtyCap ? g_snapDirtyCap : 64;
+        while (cap <= page) cap *= 2;
+        unsigned char *dirty = realloc(g_snapDirty, (size_t)cap);
+        if (!dirty) {
+            g_snapAllDirty = 1;
+            return;
+        }
+        memset(dirty + g_snapDirtyCap, 0, (size_t)(cap - g_snapDirtyCap));
+        g_snapDirty = dirty;
+        g_snapDirtyCap = cap;
+    }
+    g_snapDirty[page] = 1;
+}
+
+static void snapRetire(void *ptr) {
+    if (g_retiredCount == g_retiredCap) {
+        int cap = g_retiredCap ? g_retiredCap * 2 : 256;
+        RetiredBlock *grown = realloc(g_retired, (size_t)cap * sizeof(RetiredBlock));
+        if (!grown) return; // leak rather than free something a reader may hold
+        g_retired = grown;
+        g_retiredCap = cap;
+    }
+    g_retired[g_retiredCount].ptr = ptr;
+    g_retired[g_retiredCount].epoch = atomic_load(&g_snapEpoch);
+    g_retiredCount++;
+}
+
+// free every retired block that no pinned reader can still reach
+static void snapReclaim() {
+    unsigned long long oldest = ~0ULL;
+    int readers = atomic_load(&g_snapReaders);
+    if (readers > SNAP_MAX_READERS) readers = SNAP_MAX_READERS;
+    for (int i = 0; i < readers; i++) {
+        unsigned long long e = atomic_load(&g_snapPins[i]);
+        if (e && e < oldest) oldest = e;
+    }
+    int kept = 0;
+    for (int i = 0; i < g_retiredCount; i++) {
+        if (g_retired[i].epoch < oldest) free(g_retired[i].ptr);
+        else g_retired[kept++] = g_retired[i];
+    }
+    g_retiredCount = kept;
+}
+
+static int snapPageDirty(const StudentVersion *old, int page) {
+    return g_snapAllDirty || !old || page >= old->nPages ||
+           (page < g_snapDirtyCap && g_snapDirty[page]);
+}
+
+static void studentIndexesRefresh(const StudentVersion *old); // see Keeping the derived indexes current
+
+// Make the working table's changes visible to snapshot readers (writers only).
+static void studentSnapshotPublish() {
+    StudentVersion *old = atomic_load(&g_snapCurrent);
+    int nPages = (g_students.count + SNAP_PAGE_ROWS - 1) / SNAP_PAGE_ROWS;
+    StudentVersion *v = calloc(1, sizeof(StudentVersion));
+    StudentPage **pages = calloc((size_t)(nPages ? nPages : 1), sizeof(StudentPage *));
+    if (!v || !pages) {
+        free(v);
+        free(pages);
+        return; // readers keep seeing the previous version
+    }
+    for (int p = 0; p < nPages; p++) {
+        if (!snapPageDirty(old, p)) {
+            pages[p] = old->pages[p];
+            continue;
+        }
+        StudentPage *page = malloc(sizeof(StudentPage));
+        if (!page) {
+            for (int q = 0; q < p; q++) {
+                if (snapPageDirty(old, q)) free(pages[q]);
+            }
+            free(pages);
+            free(v);
+            return;
+        }
+        int first = p * SNAP_PAGE_ROWS;
+        int n = g_students.count - first;
+        if (n > SNAP_PAGE_ROWS) n = SNAP_PAGE_ROWS;
+        memcpy(page->rows, &g_students.rows[first], (size_t)n * sizeof(StudentRec));
+        memcpy(page->live, &g_students.live[first], (size_t)n);
+        memset(page->live + n, 0, (size_t)(SNAP_PAGE_ROWS - n));
+        pages[p] = page;
+    }
+    v->pages = pages;
+    v->nPages = nPages;
+    v->count = g_students.count;
+    v->liveCount = g_students.liveCount;
+    v->names = g_nameArena;
+    v->nDepts = g_depts.count;
+    atomic_store(&g_snapCurrent, v);
+
+    if (old) {
+        for (int p = 0; p < old->nPages; p++) {
+            if (p >= nPages || pages[p] != old->pages[p]) snapRetire(old->pages[p]);
+        }
+        snapRetire(old->pages);
+        snapRetire(old);
+    }
+    studentIndexesRefresh(old);
+    if (g_snapDirty) memset(g_snapDirty, 0, (size_t)g_snapDirtyCap);
+    g_snapAllDirty = 0;
+    atomic_fetch_add(&g_snapEpoch, 1);
+    snapReclaim();
+}
+
+/* Pin the newest version; NULL before the table is loaded (or if SNAP_MAX_READERS
+   threads already took a slot). Nested pins are fine. Every pin, NULL or not, needs a
+   studentSnapshotRelease() from the same thread. */
+static const StudentVersion *studentSnapshotPin() {
+    if (t_snapDepth++ > 0) return (t_snapSlot >= 0) ? atomic_load(&g_snapCurrent) : NULL;
+    if (t_snapSlot < 0) {
+        int slot = atomic_fetch_add(&g_snapReaders, 1);
+        if (slot >= SNAP_MAX_READERS) return NULL;
+        t_snapSlot = slot;
+    }
+    atomic_store(&g_snapPins[t_snapSlot], atomic_load(&g_snapEpoch));
+    return atomic_load(&g_snapCurrent);
+}
+
+static void studentSnapshotRelease() {
+    if (--t_snapDepth > 0 || t_snapSlot < 0) return;
+    atomic_store(&g_snapPins[t_snapSlot], 0);
+}
+
+// row r of a pinned version, or NULL if it was deleted
+static const StudentRec *snapshotRow(const StudentVersion *v, int r) {
+    const StudentPage *page = v->pages[r / SNAP_PAGE_ROWS];
+    return page->live[r % SNAP_PAGE_ROWS] ? &page->rows[r % SNAP_PAGE_ROWS] : NULL;
+}
+
+// row r of a pinned version as a Student; 0 if it was deleted
+static int snapshotStudent(const StudentVersion *v, int r, Student *out) {
+    const StudentRec *rec = snapshotRow(v, r);
+    if (!rec) return 0;
+    studentView(rec, v->names, out);
+    return 1;
+}
+
+/* ---------- Analytics columns ---------- */
+/* The fields the analytics group by, copied out of every row into one array per field
+   (structure of arrays) parallel to g_students.rows. A pass over the columns reads
+   5 bytes per student instead of a whole row. They are built by the first query
+   that needs them (ensureStudentColumns); after that every snapshot publish refreshes
+   the rows of the pages it copied. When all rows changed (load, compaction) they are
+   marked stale and the next query rebuilds them. */
+
+#define COL_CGPA_MAX 1000 // CGPA is kept in hundredths, clamped to 0.00..10.00
+
+typedef struct {
+    unsigned short *dept;       // department id, DEPT_NONE for deleted rows
+    unsigned char *semester;    // clamped to 0..ANALYTICS_SEMESTERS-1
+    unsigned short *cgpa;       // hundredths, 0..COL_CGPA_MAX
+    int count, cap;
+    int stale;                  // not built, or out of date: ensureStudentColumns rebuilds
+} StudentColumns;
+
+static StudentColumns g_cols = { .stale = 1 };
+
+static int studentColumnsReserve(int rows) {
+    if (rows <= g_cols.cap) return 0;
+    int cap = g_cols.cap ? g_cols.cap : 1024;
+    while (cap < rows) cap *= 2;
+    unsigned short *dept = realloc(g_cols.dept, (size_t)cap * sizeof(unsigned short));
+    if (!dept) return -1;
+    g_cols.dept = dept;
+    unsigned char *semester = realloc(g_cols.semester, (size_t)cap);
+    if (!semester) return -1;
+    g_cols.semester = semester;
+    unsigned short *cgpa = realloc(g_cols.cgpa, (size_t)cap * sizeof(unsigned short));
+    if (!cgpa) return -1;
+    g_cols.cgpa = cgpa;
+    g_cols.cap = cap;
+    return 0;
+}
+
+// CGPA (hundredths) clamped to 0..COL_CGPA_MAX
+static int cgpaHundredths(int cgpa) {
+    return cgpa < 0 ? 0 : cgpa > COL_CGPA_MAX ? COL_CGPA_MAX : cgpa;
+}
+
+static void studentColumnsSet(int row) {
+    const StudentRec *s = &g_students.rows[row];
+    if (!g_students.live[row]) {
+        g_cols.dept[row] = DEPT_NONE;
+        g_cols.semester[row] = 0;
+        g_cols.cgpa[row] = 0;
+        return;
+    }
+    int semester = s->semester;
+    if (semester < 0) semester = 0;
+    if (semester >= ANALYTICS_SEMESTERS) semester = ANALYTICS_SEMESTERS - 1;
+    g_cols.dept[row] = s->dept;
+    g_cols.semester[row] = (unsigned char)semester;
+    g_cols.cgpa[row] = (unsigned short)cgpaHundredths(s->cgpa);
+}
+
+// build the columns if they are stale; 1 when they match the table, -1 otherwise
+static int ensureStudentColumns() {
+    if (!g_cols.stale) return 1;
+    if (t_readOnlyCaches || studentColumnsReserve(g_students.count) != 0) return -1;
+    for (int r = 0; r < g_students.count; r++) studentColumnsSet(r);
+    g_cols.count = g_students.count;
+    g_cols.stale = 0;
+    return 1;
+}
+
+/* ---------- CGPA ranking index ---------- */
+/* Merit lists (top K, CGPA ranges) walk two kinds of skip list over the live rows, both
+   ordered by CGPA, highest first, then by id: one list over every student and one per
+   department. The row number is the node, so keys come straight from the columns and a
+   node is 16 bytes: both level-0 links and its level counts, plus the rare higher
+   levels (p = 1/4), which live in a shared pool. Built by the first ranking query
+   (ensureRankIndex), then kept current by studentIndexesRefresh. A row keeps its
+   levels until the next rebuild; rows are never reused before that, since only
+   compaction moves them and that marks the index stale. */
+
+#define RANK_MAX_LEVEL 14  // enough for 4^14 rows
+#define RANK_ALL  0        // chain through every student
+#define RANK_DEPT 1        // chain through the student's department
+#define RANK_PREFETCH 16   // rows a rebuild looks ahead
+
+typedef struct {
+    int head[RANK_MAX_LEVEL];   // first node at each level, -1 = none
+    int level;                  // levels in use
+    int count;
+} RankList;
+
+typedef struct {
+    int next[2];            // level-0 link per chain, -1 = end of list
+    int upperAt;            // where the links above level 0 start in RankIndex.upper
+    int levels;             // ALL-chain levels << 4 | DEPT-chain levels; 0 = none yet
+} RankNode;
+
+typedef struct {
+    RankNode *nodes;        // one per row
+    int cap;
+    int *upper;
+    int upperLen, upperCap;
+    RankList all;
+    RankList *depts;        // indexed by department id
+    int deptCap;
+    unsigned int seed;
+} RankIndex;
+
+static RankIndex g_rank = { .seed = 2463534242u };
+static int g_rankStale = 1; // not built, or out of date: ensureRankIndex rebuilds
+
+static int rankReserve(int rows) {
+    if (rows <= g_rank.cap) return 0;
+    int cap = g_rank.cap ? g_rank.cap : 1024;
+    while (cap < rows) cap *= 2;
+    RankNode *nodes = realloc(g_rank.nodes, (size_t)cap * sizeof(RankNode));
+    if (!nodes) return -1;
+    memset(nodes + g_rank.cap, 0, (size_t)(cap - g_rank.cap) * sizeof(RankNode));
+    g_rank.nodes = nodes;
+    g_rank.cap = cap;
+    return 0;
+}
+
+// the list of a department, created empty on first use; NULL if out of memory
+static RankList *rankDeptList(int dept) {
+    if (dept >= g_rank.deptCap) {
+        int cap = g_rank.deptCap ? g_rank.deptCap : 32;
+        while (cap <= dept) cap *= 2;
+        RankList *depts = realloc(g_rank.depts, (size_t)cap * sizeof(RankList));
+        if (!depts) return NULL;
+        memset(depts + g_rank.deptCap, 0, (size_t)(cap - g_rank.deptCap) * sizeof(RankList));
+        g_rank.depts = depts;
+        g_rank.deptCap = cap;
+    }
+    return &g_rank.depts[dept];
+}
+
+static int rankLevels(int row, int chain) {
+    return (chain == RANK_ALL) ? g_rank.nodes[row].levels >> 4 : g_rank.nodes[row].levels & 15;
+}
+
+// the link leaving node (-1 = the list head) at level in chain
+static int *rankLink(RankList *list, int chain, int node, int level) {
+    if (node < 0) return &list->head[level];
+    if (level == 0) return &g_rank.nodes[node].next[chain];
+    int skip = (chain == RANK_ALL) ? 0 : rankLevels(node, RANK_ALL) - 1;
+    return &g_rank.upper[g_rank.nodes[node].upperAt + skip + level - 1];
+}
+
+// does row a rank ahead of row b?
+static int rankBefore(int a, int b) {
+    if (g_cols.cgpa[a] != g_cols.cgpa[b]) return g_cols.cgpa[a] > g_cols.cgpa[b];
+    return g_students.rows[a].id < g_students.rows[b].id;
+}
+
+static int rankRandomLevel() {
+    unsigned int x = g_rank.seed; // xorshift32
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_rank.seed = x;
+    int level = 1;
+    while (level < RANK_MAX_LEVEL && (x & 3) == 0) {
+        level++;
+        x >>= 2;
+    }
+    return level;
+}
+
+// give row its levels in both chains (once, until the next rebuild)
+static int rankAssignLevels(int row) {
+    if (g_rank.nodes[row].levels) return 0;
+    int all = rankRandomLevel(), dept = rankRandomLevel();
+    int need = all - 1 + dept - 1;
+    if (g_rank.upperLen + need > g_rank.upperCap) {
+        int cap = g_rank.upperCap ? g_rank.upperCap * 2 : 1024;
+        while (cap < g_rank.upperLen + need) cap *= 2;
+        int *upper = realloc(g_rank.upper, (size_t)cap * sizeof(int));
+        if (!upper) return -1;
+        g_rank.upper = upper;
+        g_rank.upperCap = cap;
+    }
+    g_rank.nodes[row].upperAt = g_rank.upperLen;
+    g_rank.upperLen += need;
+    g_rank.nodes[row].levels = all << 4 | dept;
+    return 0;
+}
+
+static void rankInsert(RankList *list, int chain, int row) {
+    int levels = rankLevels(row, chain);
+    while (list->level < levels) list->head[list->level++] = -1;
+    int node = -1;
+    for (int l = list->level - 1; l >= 0; l--) {
+        int next;
+        while ((next = *rankLink(list, chain, node, l)) >= 0 && rankBefore(next, row)) node = next;
+        if (l < levels) {
+            *rankLink(list, chain, row, l) = next;
+            *rankLink(list, chain, node, l) = row;
+        }
+    }
+    list->count++;
+}
+
+static void rankRemove(RankList *list, int chain, int row) {
+    int node = -1;
+    for (int l = list->level - 1; l >= 0; l--) {
+        int next;
+        while ((next = *rankLink(list, chain, node, l)) >= 0 && rankBefore(next, row)) node = next;
+        if (next == row) *rankLink(list, chain, node, l) = *rankLink(list, chain, row, l);
+    }
+    list->count--;
+}
+
+// rows are ranked while their columns hold a department (live rows)
+static void rankUnlinkRow(int row) {
+    int dept = g_cols.dept[row];
+    if (dept == DEPT_NONE) return;
+    rankRemove(&g_rank.all, RANK_ALL, row);
+    rankRemove(&g_rank.depts[dept], RANK_DEPT, row);
+}
+
+static int rankLinkRow(int row) {
+    int dept = g_cols.dept[row];
+    if (dept == DEPT_NONE) return 0;
+    RankList *list = rankDeptList(dept);
+    if (!list || rankAssignLevels(row) != 0) return -1;
+    rankInsert(&g_rank.all, RANK_ALL, row);
+    rankInsert(list, RANK_DEPT, row);
+    return 0;
+}
+
+// append row at the end of list; last[] holds the current tail at each level
+static void rankAppend(RankList *list, int chain, int row, int *last) {
+    int levels = rankLevels(row, chain);
+    while (list->level < levels) list->head[list->level++] = -1;
+    for (int l = 0; l < levels; l++) {
+        *rankLink(list, chain, last[l], l) = row;
+        last[l] = row;
+    }
+    list->count++;
+}
+
+// end list at its tails
+static void rankTerminate(RankList *list, int chain, const int *last) {
+    for (int l = 0; l < list->level; l++) *rankLink(list, chain, last[l], l) = -1;
+}
+
+/* Relink every live row from scratch: sort the rows by id (a radix sort, skipped when
+   they already are in id order, as a loaded file usually is), counting sort them
+   stably by CGPA, highest first, then append each row to the tails of its lists. */
+static void rankRebuild() {
+    g_rankStale = 1;
+    int n = g_cols.count, live = 0, sorted = 1;
+    int nDepts = g_depts.count;
+    if (rankReserve(n) != 0 || (nDepts && !rankDeptList(nDepts - 1))) return;
+    size_t rows = (size_t)(n ? n : 1);
+    int *order = malloc(rows * sizeof(int)), *tmp = malloc(rows * sizeof(int));
+    unsigned *keys = malloc(rows * sizeof(unsigned)), *keysTmp = malloc(rows * sizeof(unsigned));
+    int *count = malloc(65536 * sizeof(int));
+    int *last = malloc((size_t)(nDepts + 1) * RANK_MAX_LEVEL * sizeof(int));
+    int *upper;
+    if (!order || !tmp || !keys || !keysTmp || !count || !last) {
+        free(order);
+        free(tmp);
+        free(keys);
+        free(keysTmp);
+        free(count);
+        free(last);
+        return;
+    }
+    for (int r = 0; r < n; r++) {
+        if (g_cols.dept[r] == DEPT_NONE) continue;
+        unsigned key = (unsigned)g_students.rows[r].id ^ 0x80000000u; // sorts like the signed id
+        if (live && key < keys[live - 1]) sorted = 0;
+        keys[live] = key;
+        order[live++] = r;
+    }
+    for (int shift = 0; shift < 32 && !sorted; shift += 16) {
+        memset(count, 0, 65536 * sizeof(int));
+        for (int i = 0; i < live; i++) count[keys[i] >> shift & 0xFFFF]++;
+        for (int k = 0, sum = 0; k < 65536; k++) {
+            int c = count[k];
+            count[k] = sum;
+            sum += c;
+        }
+        for (int i = 0; i < live; i++) {
+            int at = count[keys[i] >> shift & 0xFFFF]++;
+            tmp[at] = order[i];
+            keysTmp[at] = keys[i];
+        }
+        int *swap = order;
+        order = tmp;
+        tmp = swap;
+        unsigned *swapKeys = keys;
+        keys = keysTmp;
+        keysTmp = swapKeys;
+    }
+    free(keys);
+    free(keysTmp);
+    memset(count, 0, (COL_CGPA_MAX + 1) * sizeof(int));
+    for (int i = 0; i < live; i++) count[COL_CGPA_MAX - g_cols.cgpa[order[i]]]++;
+    for (int k = 0, sum = 0; k <= COL_CGPA_MAX; k++) {
+        int c = count[k];
+        count[k] = sum;
+        sum += c;
+    }
+    for (int i = 0; i < live; i++) tmp[count[COL_CGPA_MAX - g_cols.cgpa[order[i]]]++] = order[i];
+
+    memset(g_rank.nodes, 0, (size_t)g_rank.cap * sizeof(RankNode));
+    g_rank.upperLen = 0;
+    if (g_rank.upperCap < live && (upper = realloc(g_rank.upper, (size_t)live * sizeof(int))) != NULL) {
+        g_rank.upper = upper; // about 2/3 of a link per row, so this rarely has to grow
+        g_rank.upperCap = live;
+    }
+    memset(&g_rank.all, 0, sizeof(RankList));
+    memset(g_rank.depts, 0, (size_t)g_rank.deptCap * sizeof(RankList));
+    for (int i = 0; i < (nDepts + 1) * RANK_MAX_LEVEL; i++) last[i] = -1;
+    int ok = 1;
+    for (int i = 0; i < live; i++) {
+        int row = tmp[i];
+#ifdef HAVE_SSE2
+        if (i + RANK_PREFETCH < live) { // rows come in CGPA order, i.e. scattered
+            int ahead = tmp[i + RANK_PREFETCH];
+            _mm_prefetch((const char *)&g_rank.nodes[ahead], _MM_HINT_T0);
+            _mm_prefetch((const char *)&g_cols.dept[ahead], _MM_HINT_T0);
+        }
+#endif
+        if (rankAssignLevels(row) != 0) {
+            ok = 0;
+            break;
+        }
+        int dept = g_cols.dept[row];
+        rankAppend(&g_rank.all, RANK_ALL, row, &last[nDepts * RANK_MAX_LEVEL]);
+        rankAppend(&g_rank.depts[dept], RANK_DEPT, row, &last[dept * RANK_MAX_LEVEL]);
+    }
+    rankTerminate(&g_rank.all, RANK_ALL, &last[nDepts * RANK_MAX_LEVEL]);
+    for (int d = 0; d < nDepts; d++) rankTerminate(&g_rank.depts[d], RANK_DEPT, &last[d * RANK_MAX_LEVEL]);
+    free(order);
+    free(tmp);
+    free(count);
+    free(last);
+    g_rankStale = !ok;
+}
+
+// build the ranking (and the columns it is keyed on) if stale; 1 when current, -1 otherwise
+static int ensureRankIndex() {
+    if (ensureStudentColumns() != 1) return -1;
+    if (g_rankStale && !t_readOnlyCaches) rankRebuild();
+    return g_rankStale ? -1 : 1;
+}
+
+/* First row, in rank order, of the list for dept (DEPT_NONE = every student) whose
+   CGPA is at most maxCgpa (hundredths); -1 if none. Follow it with rankNextRow. */
+static int rankSeek(int dept, int maxCgpa) {
+    RankList *list = (dept == DEPT_NONE) ? &g_rank.all : (dept < g_rank.deptCap) ? &g_rank.depts[dept] : NULL;
+    int chain = (dept == DEPT_NONE) ? RANK_ALL : RANK_DEPT;
+    if (!list || list->level == 0) return -1;
+    int node = -1;
+    for (int l = list->level - 1; l >= 0; l--) {
+        int next;
+        while ((next = *rankLink(list, chain, node, l)) >= 0 && g_cols.cgpa[next] > maxCgpa) node = next;
+    }
+    return *rankLink(list, chain, node, 0);
+}
+
+static int rankNextRow(int dept, int row) {
+    return g_rank.nodes[row].next[dept == DEPT_NONE ? RANK_ALL : RANK_DEPT];
+}
+
+/* ---------- Name search index ---------- */
+/* Case-insensitive name search through a trigram inverted index: each 3-byte window of
+   "\1" + the lowercased name ("\1" marks where the name starts) lists the rows whose
+   name contains it. A query reads only the posting list of its rarest trigram and
+   checks every candidate against the row's current name, so the lists never need to be
+   exact. Built by the first search (ensureNameIndex), then studentIndexesRefresh adds
+   the trigrams of new and renamed rows. Postings left behind by deleted and renamed
+   rows stay until they make up half the index, which then goes stale and is rebuilt. */
+
+#define NAME_MIN_QUERY 2  // two-letter queries match at the start of a word only
+#define NAME_START     1  // the byte in front of every indexed name
+
+typedef struct {
+    unsigned int key;       // 1 << 24 | three bytes; 0 = empty slot
+    int *rows;              // ascending after a rebuild; appended to afterwards
+    int count, cap;
+} TrigramList;
+
+typedef struct {
+    TrigramList *lists;     // open addressing on key
+    int listCap;            // power of two
+    int listCount;
+    long postings;          // row entries in all lists
+    long dead;              // entries of deleted rows and old names
+    int stale;              // not built, or mostly garbage: ensureNameIndex rebuilds
+} NameIndex;
+
+static NameIndex g_names = { .stale = 1 };
+
+// lowercase name into buf (size > MAX_NAME) behind NAME_START; returns the length
+static int nameFold(const char *name, unsigned char *buf) {
+    int n = 0;
+    buf[n++] = NAME_START;
+    for (; *name && n < MAX_NAME; name++) buf[n++] = (unsigned char)tolower((unsigned char)*name);
+    buf[n] = '\0';
+    return n;
+}
+
+// distinct trigram keys of folded text into keys (room for len entries); returns how many
+static int textTrigrams(const unsigned char *text, int len, unsigned int *keys) {
+    int k = 0;
+    for (int i = 0; i + 3 <= len; i++) {
+        unsigned int key = 1u << 24 | (unsigned int)text[i] << 16 | (unsigned int)text[i + 1] << 8 | text[i + 2];
+        int seen = 0;
+        for (int j = 0; j < k && !seen; j++) seen = (keys[j] == key);
+        if (!seen) keys[k++] = key;
+    }
+    return k;
+}
+
+static unsigned int hashTrigram(unsigned int key) {
+    unsigned int h = key * 2654435761u;
+    return h ^ (h >> 15);
+}
+
+// the list for key; with create, added when missing (NULL only if out of memory)
+static TrigramList *trigramList(unsigned int key, int create) {
+    if (create && (g_names.listCount + 1) * 2 > g_names.listCap) {
+        int cap = g_names.listCap ? g_names.listCap * 2 : 4096;
+        TrigramList *lists = calloc((size_t)cap, sizeof(TrigramList));
+        if (!lists) return NULL;
+        for (int i = 0; i < g_names.listCap; i++) {
+            if (!g_names.lists[i].key) continue;
+            unsigned int j = hashTrigram(g_names.lists[i].key) & (unsigned int)(cap - 1);
+            while (lists[j].key) j = (j + 1) & (unsigned int)(cap - 1);
+            lists[j] = g_names.lists[i];
+        }
+        free(g_names.lists);
+        g_names.lists = lists;
+        g_names.listCap = cap;
+    }
+    if (!g_names.listCap) return NULL;
+    unsigned int mask = (unsigned int)g_names.listCap - 1;
+    unsigned int i = hashTrigram(key) & mask;
+    while (g_names.lists[i].key && g_names.lists[i].key != key) i = (i + 1) & mask;
+    if (g_names.lists[i].key) return &g_names.lists[i];
+    if (!create) return NULL;
+    g_names.lists[i].key = key;
+    g_names.listCount++;
+    return &g_names.lists[i];
+}
+
+static int nameIndexAdd(int row, const char *name) {
+    unsigned char text[MAX_NAME + 1];
+    unsigned int keys[MAX_NAME];
+    int k = textTrigrams(text, nameFold(name, text), keys);
+    for (int i = 0; i < k; i++) {
+        TrigramList *list = trigramList(keys[i], 1);
+        if (!list) return -1;
+        if (list->count == list->cap) {
+            int cap = list->cap ? list->cap * 2 : 4;
+            int *rows = realloc(list->rows, (size_t)cap * sizeof(int));
+            if (!rows) return -1;
+            list->rows = rows;
+            list->cap = cap;
+        }
+        list->rows[list->count++] = row;
+    }
+    g_names.postings += k;
+    return 0;
+}
+
+static void nameIndexClear() {
+    for (int i = 0; i < g_names.listCap; i++) free(g_names.lists[i].rows);
+    free(g_names.lists);
+    memset(&g_names, 0, sizeof(g_names));
+    g_names.stale = 1;
+}
+
+/* row changed from before (NULL: it did not exist or was deleted) to its current state;
+   both are in the working arena, where an unchanged name keeps its offset */
+static void nameIndexRow(int row, const StudentRec *before) {
+    const StudentRec *now = g_students.live[row] ? &g_students.rows[row] : NULL;
+    if (before && now && before->nameOff == now->nameOff) return;
+    if (before) {
+        unsigned char text[MAX_NAME + 1];
+        unsigned int keys[MAX_NAME];
+        g_names.dead += textTrigrams(text, nameFold(arenaName(g_nameArena, before->nameOff), text), keys);
+    }
+    if (now && nameIndexAdd(row, arenaName(g_nameArena, now->nameOff)) != 0) g_names.stale = 1;
+    if (g_names.dead * 2 > g_names.postings) g_names.stale = 1;
+}
+
+// build the index if it is stale; 1 when current, -1 otherwise
+static int ensureNameIndex() {
+    if (!g_names.stale) return 1;
+    if (t_readOnlyCaches) return -1;
+    nameIndexClear();
+    for (int r = 0; r < g_students.count; r++) {
+        if (g_students.live[r] && nameIndexAdd(r, arenaName(g_nameArena, g_students.rows[r].nameOff)) != 0) {
+            nameIndexClear();
+            return -1;
+        }
+    }
+    g_names.stale = 0;
+    return 1;
+}
+
+/* How well folded name (without NAME_START) matches folded query q: 0 = the whole name,
+   1 = start of the name, 2 = start of a later word, 3 = inside a word, -1 = no match.
+   With wordStart, only scores up to 2 count. */
+static int nameMatchScore(const unsigned char *name, int len, const unsigned char *q, int qlen, int wordStart) {
+    int best = -1;
+    for (int i = 0; i + qlen <= len; i++) {
+        if (name[i] != q[0] || memcmp(name + i, q, (size_t)qlen) != 0) continue;
+        int score = (i == 0) ? (len == qlen ? 0 : 1) : (name[i - 1] == ' ') ? 2 : 3;
+        if (best < 0 || score < best) best = score;
+        if (best <= 1) break;
+    }
+    return (wordStart && best > 2) ? -1 : best;
+}
+
+/* ---------- Keeping the derived indexes current ---------- */
+/* Called by studentSnapshotPublish with the version it replaced, for the rows of every
+   page it copied. Each index that is built takes the change: the row is unlinked from
+   the ranking under its old column values and relinked under the new ones, and a new
+   or renamed row gets its name trigrams. When every row changed (load, compaction) the
+   indexes go stale instead, and the next query that needs one rebuilds it. */
+static void studentIndexesRefresh(const StudentVersion *old) {
+    if (g_snapAllDirty || !old) {
+        g_cols.stale = 1;
+        g_rankStale = 1;
+        g_names.stale = 1;
+        return;
+    }
+    if (!g_cols.stale && studentColumnsReserve(g_students.count) != 0) g_cols.stale = 1;
+    if (g_cols.stale) g_rankStale = 1;
+    if (!g_rankStale && rankReserve(g_students.count) != 0) g_rankStale = 1;
+    if (g_cols.stale && g_names.stale) return;
+    int oldCount = g_cols.count;
+    for (int first = 0; first < g_students.count; first += SNAP_PAGE_ROWS) {
+        if (!snapPageDirty(old, first / SNAP_PAGE_ROWS)) continue;
+        int end = first + SNAP_PAGE_ROWS < g_students.count ? first + SNAP_PAGE_ROWS : g_students.count;
+        for (int r = first; r < end; r++) {
+            if (!g_cols.stale) {
+                if (!g_rankStale && r < oldCount) rankUnlinkRow(r);
+                studentColumnsSet(r);
+                if (!g_rankStale && rankLinkRow(r) != 0) g_rankStale = 1;
+            }
+            if (!g_names.stale) nameIndexRow(r, r < old->count ? snapshotRow(old, r) : NULL);
+        }
+    }
+    if (!g_cols.stale) g_cols.count = g_students.count;
+}
+
+static unsigned int hashStudentId(int id) {
+    unsigned int h = (unsigned int)id * 2654435761u; // Knuth multiplicative hash
+    return h ^ (h >> 16);
+}
+
+// returns slot holding id, or -1 if id is not indexed
+static int studentSlotOf(int id) {
+    if (!g_students.slots) return -1;
+    unsigned int mask = (unsigned int)g_students.slotCap - 1;
+    unsigned int i = hashStudentId(id) & mask;
+    while (1) {
+        int row = g_students.slots[i];
+        if (row == SLOT_EMPTY) return -1;
+        if (row >= 0 && g_students.rows[row].id == id) return (int)i;
+        i = (i + 1) & mask;
+    }
+}
+
+// returns row number for id, or -1
+static int studentRowOf(int id) {
+    int slot = studentSlotOf(id);
+    return (slot < 0) ? -1 : g_students.slots[slot];
+}
+
+static void studentIndexPut(int row) {
+    unsigned int mask = (unsigned int)g_students.slotCap - 1;
+    unsigned int i = hashStudentId(g_students.rows[row].id) & mask;
+    while (g_students.slots[i] >= 0) i = (i + 1) & mask;
+    if (g_students.slots[i] == SLOT_EMPTY) g_students.slotUsed++;
+    g_students.slots[i] = row;
+}
+
+// rebuild the hash index with room for at least `want` live rows (load factor <= 0.5)
+static int studentIndexRebuild(int want) {
+    int cap = TABLE_MIN_SLOTS;
+    while (cap < want * 2) cap *= 2;
+    int *slots = malloc((size_t)cap * sizeof(int));
+    if (!slots) return -1;
+    for (int i = 0; i < cap; i++) slots[i] = SLOT_EMPTY;
+    free(g_students.slots);
+    g_students.slots = slots;
+    g_students.slotCap = cap;
+    g_students.slotUsed = 0;
+    for (int r = 0; r < g_students.count; r++) {
+        if (g_students.live[r]) studentIndexPut(r);
+    }
+    return 0;
+}
+
+static void arenaRetire(NameArena *a) {
+    for (int c = 0; c < a->nChunks; c++) snapRetire(a->chunks[c]);
+    snapRetire(a);
+}
+
+// copy the live rows' names into a fresh arena; the old one is retired
+static void nameArenaCompact() {
+    NameArena *a = calloc(1, sizeof(NameArena));
+    unsigned int *offs = malloc((size_t)(g_students.count ? g_students.count : 1) * sizeof(unsigned int));
+    int ok = (a && offs);
+    for (int r = 0; ok && r < g_students.count; r++) {
+        const StudentRec *rec = &g_students.rows[r];
+        if (g_students.live[r] && arenaAdd(a, arenaName(g_nameArena, rec->nameOff), rec->nameLen, &offs[r]) != 0) ok = 0;
+    }
+    if (!ok) {
+        for (int c = 0; a && c < a->nChunks; c++) free(a->chunks[c]);
+        free(a);
+        free(offs);
+        return; // keep the old arena
+    }
+    for (int r = 0; r < g_students.count; r++) {
+        if (g_students.live[r]) g_students.rows[r].nameOff = offs[r];
+    }
+    free(offs);
+    arenaRetire(g_nameArena);
+    g_nameArena = a;
+    g_snapAllDirty = 1; // every name moved
+}
+
+/* drop deleted rows (keeps order) once they make up half the table, and rewrite the
+   name arena once dead names make up half of it */
+static void studentTableCompact() {
+    if (g_students.count - g_students.liveCount > g_students.count / 2) {
+        int w = 0;
+        for (int r = 0; r < g_students.count; r++) {
+            if (!g_students.live[r]) continue;
+            g_students.rows[w] = g_students.rows[r];
+            g_students.live[w] = 1;
+            w++;
+        }
+        g_students.count = w;
+        g_snapAllDirty = 1; // rows moved
+        studentIndexRebuild(w);
+    }
+    // within the first chunk there is nothing to give back
+    if (g_nameArena && g_nameArena->nChunks > 1 && g_nameArena->dead * 2 > g_nameArena->used) nameArenaCompact();
+}
+
+/* s as a row in out: the department is interned and the name added to the arena,
+   unless prev (the row s replaces, or NULL) already has it. Returns 0, or -1 if the
+   dictionary or the arena is full or out of memory. */
+static int studentPack(const Student *s, const StudentRec *prev, StudentRec *out) {
+    int dept = departmentId(s->department);
+    if (dept == DEPT_NONE) return -1;
+    size_t len = strlen(s->name);
+    if (len >= MAX_NAME) len = MAX_NAME - 1;
+    if (prev && prev->nameLen == len && memcmp(arenaName(g_nameArena, prev->nameOff), s->name, len) == 0) {
+        out->nameOff = prev->nameOff;
+    } else {
+        if (!g_nameArena && !(g_nameArena = calloc(1, sizeof(NameArena)))) return -1;
+        if (arenaAdd(g_nameArena, s->name, len, &out->nameOff) != 0) return -1;
+    }
+    out->id = s->id;
+    out->nameLen = (unsigned char)len;
+    out->dept = (unsigned short)dept;
+    out->semester = s->semester;
+    out->cgpa = s->cgpa;
+    return 0;
+}
+
+// append a row and index it; returns row number or -1 on allocation failure
+static int studentTableInsert(const Student *s) {
+    if (g_students.count == g_students.capacity) {
+        int cap = g_students.capacity ? g_students.capacity * 2 : 1024;
+        StudentRec *rows = realloc(g_students.rows, (size_t)cap * sizeof(StudentRec));
+        if (!rows) return -1;
+        g_students.rows = rows;
+        unsigned char *live = realloc(g_students.live, (size_t)cap);
+        if (!live) return -1;
+        g_students.live = live;
+        g_students.capacity = cap;
+    }
+    if (!g_students.slots || (g_students.slotUsed + 1) * 2 > g_students.slotCap) {
+        if (studentIndexRebuild(g_students.liveCount + 1) != 0) return -1;
+    }
+    int row = g_students.count;
+    if (studentPack(s, NULL, &g_students.rows[row]) != 0) return -1;
+    g_students.count++;
+    g_students.live[row] = 1;
+    g_students.liveCount++;
+    studentRowChanged(row);
+    if (s->id > g_students.maxId) g_students.maxId = s->id;
+    studentIndexPut(row);
+    return row;
+}
+
+// overwrite row `row` with s (same id); 0, or -1 if it could not be packed
+static int studentTableSet(int row, const Student *s) {
+    StudentRec *rec = &g_students.rows[row], packed;
+    if (studentPack(s, rec, &packed) != 0) return -1;
+    if (packed.nameOff != rec->nameOff) g_nameArena->dead += (unsigned long long)rec->nameLen + 1;
+    *rec = packed;
+    studentRowChanged(row);
+    return 0;
+}
+
+static void studentTableRemove(int id) {
+    int slot = studentSlotOf(id);
+    if (slot < 0) return;
+    int row = g_students.slots[slot];
+    g_students.slots[slot] = SLOT_DELETED;
+    g_students.live[row] = 0;
+    g_students.liveCount--;
+    g_nameArena->dead += (unsigned long long)g_students.rows[row].nameLen + 1;
+    studentRowChanged(row);
+    studentTableCompact();
+}
+
+// Fill out from fields first.. first + 4 of rec (id,name,department,semester,cgpa).
+// Returns 1 on success, 0 if fields are missing or empty.
+static int studentFromRecord(const Record *rec, int first, Student *out) {
+    if (rec->n < first + 5) return 0;
+    const FieldView *f = &rec->f[first];
+    for (int i = 0; i < 5; i++) {
+        if (f[i].len == 0) return 0;
+    }
+    out->id = fieldInt(&f[0]);
+    fieldCopy(&f[1], out->name, sizeof(out->name));
+    fieldCopy(&f[2], out->department, sizeof(out->department));
+    out->semester = fieldInt(&f[3]);
+    out->cgpa = fieldHundredths(&f[4]);
+    return 1;
+}
+
+// s as "id,name,department,semester,cgpa" (no newline) in buf; returns buf. Built by
+// hand rather than with snprintf: this runs for every row written.
+static char *studentCsvLine(const Student *s, char *buf, size_t size) {
+    char name[CSV_FIELD_SIZE(MAX_NAME)], dept[CSV_FIELD_SIZE(MAX_DEPT)];
+    char id[NUM_BUF], semester[NUM_BUF], cgpa[NUM_BUF];
+    formatInt(s->id, id);
+    formatInt(s->semester, semester);
+    formatHundredths(s->cgpa, cgpa);
+    const char *parts[5] = { id, csvField(s->name, name, sizeof(name)),
+                             csvField(s->department, dept, sizeof(dept)), semester, cgpa };
+    size_t len = 0;
+    for (int i = 0; i < 5 && len + 1 < size; i++) {
+        if (i) buf[len++] = ',';
+        size_t n = strlen(parts[i]);
+        if (n > size - 1 - len) n = size - 1 - len;
+        memcpy(buf + len, parts[i], n);
+        len += n;
+    }
+    buf[len] = '\0';
+    return buf;
+}
+
+static void writeStudentLine(FILE *fp, const Student *s) {
+    char line[MAX_LINE];
+    fprintf(fp, "%s\n", studentCsvLine(s, line, sizeof(line)));
+}
+
+/* ---------- Storage backends ---------- */
+/* STORAGE_CSV    : students.txt, appends for inserts, full rewrite for update/delete.
+   STORAGE_BINARY : students.dat, one fixed-size record per id at
+                    header + (id - FIRST_STUDENT_ID) * sizeof(StudentDiskRecord),
+                    so update/delete is a single positioned write.
+   Selected with --storage=csv|binary on the command line. */
+
+typedef enum { STORAGE_CSV = 0, STORAGE_BINARY = 1 } StorageBackend;
+static StorageBackend g_storage = STORAGE_CSV;
+
+#define BIN_MAGIC        "SMSSTU1"
+#define BIN_VERSION      2   // 2: cgpa in hundredths; 1 held a float (converted by binOpen)
+#define REC_EMPTY        0   // never written (gap between ids)
+#define REC_LIVE         1
+#define REC_TOMBSTONE    2   // deleted by deleteStudentRecord
+
+typedef struct {
+    char magic[8];
+    int version;
+    int recordSize;         // sizeof(StudentDiskRecord) when the file was created
+} StudentDiskHeader;
+
+typedef struct {
+    int id;
+    int status;             // REC_EMPTY / REC_LIVE / REC_TOMBSTONE
+    char name[MAX_NAME];
+    char department[MAX_DEPT];
+    int semester;
+    int cgpa;               // hundredths
+} StudentDiskRecord;
+
+#ifdef _WIN32
+static FILE *g_binFp = NULL;
+#else
+static int g_binFd = -1;
+#endif
+
+static long long binOffsetOf(int id) {
+    return (long long)sizeof(StudentDiskHeader) +
+           (long long)(id - FIRST_STUDENT_ID) * (long long)sizeof(StudentDiskRecord);
+}
+
+// positioned read/write on students.dat; return 1 on success, 0 on short read, -1 on error
+static int binReadAt(long long off, void *buf, size_t len) {
+#ifdef _WIN32
+    if (_fseeki64(g_binFp, off, SEEK_SET) != 0) return -1;
+    size_t n = fread(buf, 1, len, g_binFp);
+#else
+    ssize_t n = pread(g_binFd, buf, len, (off_t)off);
+    if (n < 0) return -1;
+#endif
+    statsRead((size_t)n);
+    return ((size_t)n == len) ? 1 : 0;
+}
+
+static int binWriteAt(long long off, const void *buf, size_t len) {
+    g_locks.written[TBL_STUDENTS] = 1;
+#ifdef _WIN32
+    if (_fseeki64(g_binFp, off, SEEK_SET) != 0) return -1;
+    if (fwrite(buf, 1, len, g_binFp) != len) return -1;
+    fflush(g_binFp);
+    statsWrote(len);
+    return 1;
+#else
+    ssize_t n = pwrite(g_binFd, buf, len, (off_t)off);
+    if (n > 0) statsWrote((size_t)n);
+    return ((size_t)n == len) ? 1 : -1;
+#endif
+}
+
+static void studentToDisk(const Student *s, int status, StudentDiskRecord *rec) {
+    memset(rec, 0, sizeof(*rec));
+    rec->id = s->id;
+    rec->status = status;
+    snprintf(rec->name, sizeof(rec->name), "%s", s->name);
+    snprintf(rec->department, sizeof(rec->department), "%s", s->department);
+    rec->semester = s->semester;
+    rec->cgpa = s->cgpa;
+}
+
+static void studentFromDisk(const StudentDiskRecord *rec, Student *s) {
+    s->id = rec->id;
+    memcpy(s->name, rec->name, sizeof(s->name)); s->name[sizeof(s->name)-1] = 0;
+    memcpy(s->department, rec->department, sizeof(s->department)); s->department[sizeof(s->department)-1] = 0;
+    s->semester = rec->semester;
+    s->cgpa = rec->cgpa;
+}
+
+static void fillDiskHeader(StudentDiskHeader *h) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, BIN_MAGIC, sizeof(BIN_MAGIC));
+    h->version = BIN_VERSION;
+    h->recordSize = (int)sizeof(StudentDiskRecord);
+}
+
+static void binClose() {
+#ifdef _WIN32
+    if (g_binFp) fclose(g_binFp);
+    g_binFp = NULL;
+#else
+    if (g_binFd >= 0) close(g_binFd);
+    g_binFd = -1;
+#endif
+}
+
+// Rewrite a version 1 students.dat (cgpa stored as a float) in the current format, in
+// a temp file that then replaces it. Returns 1 on success, -1 on error.
+static int binUpgradeV1() {
+    FILE *in = fopen(STUDENTS_BIN_FILE, "rb");
+    if (!in) return -1;
+    char tmpPath[64];
+    processTempName(STUDENTS_BIN_FILE, tmpPath, sizeof(tmpPath));
+    FILE *out = fopen(tmpPath, "wb");
+    if (!out) {
+        fclose(in);
+        return -1;
+    }
+    StudentDiskHeader h;
+    int ok = fread(&h, sizeof(h), 1, in) == 1;
+    fillDiskHeader(&h);
+    if (ok) ok = fwrite(&h, sizeof(h), 1, out) == 1;
+    StudentDiskRecord rec;
+    while (ok && fread(&rec, sizeof(rec), 1, in) == 1) {
+        float cgpa;
+        memcpy(&cgpa, &rec.cgpa, sizeof(cgpa));
+        rec.cgpa = toHundredths(cgpa);
+        ok = fwrite(&rec, sizeof(rec), 1, out) == 1;
+    }
+    if (ferror(in)) ok = 0;
+    fclose(in);
+    if (fclose(out) != 0) ok = 0;
+    if (!ok || replaceFile(tmpPath, STUDENTS_BIN_FILE) != 0) {
+        remove(tmpPath);
+        return -1;
+    }
+    return 1;
+}
+
+// Open (or create) students.dat and check its header; a version 1 file is upgraded
+// first. Returns 1 on success, -1 on error.
+static int binOpen() {
+#ifdef _WIN32
+    if (g_binFp) return 1;
+    g_binFp = fopen(STUDENTS_BIN_FILE, "r+b");
+    if (!g_binFp) g_binFp = fopen(STUDENTS_BIN_FILE, "w+b");
+    if (!g_binFp) return -1;
+#else
+    if (g_binFd >= 0) return 1;
+    g_binFd = open(STUDENTS_BIN_FILE, O_RDWR | O_CREAT, 0644);
+    if (g_binFd < 0) return -1;
+#endif
+    StudentDiskHeader h, want;
+    fillDiskHeader(&want);
+    int r = binReadAt(0, &h, sizeof(h));
+    if (r == 0) return binWriteAt(0, &want, sizeof(want)); // new, empty file
+    if (r > 0 && memcmp(h.magic, want.magic, sizeof(h.magic)) == 0 && h.version == 1 &&
+        h.recordSize == want.recordSize && sizeof(float) == sizeof(int)) {
+        binClose();
+        if (binUpgradeV1() != 1) {
+            printf("❌ Unable to convert %s to the current format.\n", STUDENTS_BIN_FILE);
+            return -1;
+        }
+        return binOpen();
+    }
+    if (r < 0 || memcmp(h.magic, want.magic, sizeof(h.magic)) != 0 ||
+        h.version != want.version || h.recordSize != want.recordSize) {
+        printf("❌ %s has an unknown format.\n", STUDENTS_BIN_FILE);
+        return -1;
+    }
+    return 1;
+}
+
+// Flush in-place record writes to disk (commit with --durability=batch|op). 1 on success.
+static int storeSync() {
+#ifdef _WIN32
+    if (!g_binFp) return 1;
+    return (fflush(g_binFp) == 0 && _commit(_fileno(g_binFp)) == 0) ? 1 : -1;
+#else
+    if (g_binFd < 0) return 1;
+    return fsync(g_binFd) == 0 ? 1 : -1;
+#endif
+}
+
+static int binLoad() {
+    if (binOpen() != 1) return -1;
+    enum { CHUNK = 4096 };
+    StudentDiskRecord *buf = malloc(CHUNK * sizeof(StudentDiskRecord));
+    if (!buf) return -1;
+    long long off = sizeof(StudentDiskHeader);
+    while (1) {
+#ifdef _WIN32
+        if (_fseeki64(g_binFp, off, SEEK_SET) != 0) break;
+        size_t got = fread(buf, 1, CHUNK * sizeof(StudentDiskRecord), g_binFp);
+#else
+        ssize_t got = pread(g_binFd, buf, CHUNK * sizeof(StudentDiskRecord), (off_t)off);
+        if (got < 0) { free(buf); return -1; }
+#endif
+        size_t n = (size_t)got / sizeof(StudentDiskRecord);
+        if (n == 0) break;
+        statsRead(n * sizeof(StudentDiskRecord));
+        for (size_t i = 0; i < n; i++) {
+            if (buf[i].status != REC_LIVE) continue;
+            Student s;
+            studentFromDisk(&buf[i], &s);
+            if (studentTableInsert(&s) < 0) { free(buf); return -1; }
+        }
+        off += (long long)(n * sizeof(StudentDiskRecord));
+    }
+    free(buf);
+    return 1;
+}
+
+static int binPut(const Student *s, int status) {
+    if (s->id < FIRST_STUDENT_ID) return -1; // no slot below the first id
+    if (binOpen() != 1) return -1;
+    StudentDiskRecord rec;
+    studentToDisk(s, status, &rec);
+    return binWriteAt(binOffsetOf(s->id), &rec, sizeof(rec));
+}
+
+/* ---------- CSV backend: base file + journal ---------- */
+/* Inserts, updates and deletes are appended to STUDENTS_JOURNAL as one short line each
+   (U,<student line> or D,id); loading replays the journal over STUDENTS_FILE. Once the
+   journal passes JOURNAL_COMPACT_BYTES it is renamed to STUDENTS_JOURNAL_OLD and a
+   forked child writes the table out as the new STUDENTS_FILE, then removes the old
+   journal. A crash at any point leaves base + journals that replay to the same table.
+   The child swaps its file in under the students lock, and only if the old journal it
+   folded is still the one on disk: another process may have folded it meanwhile.
+   The daemon does not fork from its worker threads; it folds in place under the
+   write lock instead. */
+
+static long g_journalBytes = 0;
+#ifndef _WIN32
+static pid_t g_compactPid = 0;
+static int g_compactInPlace = 0; // set by runDaemon
+#endif
+
+typedef struct {
+    char op;                // 'U' (insert or update) or 'D' (delete s.id)
+    Student s;
+} JournalEntry;
+
+// scanner callback: one journal line -> JournalEntry
+static int scanJournalLine(const char *line, const char *end, long offset, void *rec) {
+    (void)offset;
+    JournalEntry *e = rec;
+    Record r;
+    if (recordParse(line, end, &r, 6) < 2 || r.f[0].len != 1) return 0;
+    e->op = r.f[0].p[0];
+    if (e->op == 'U') return studentFromRecord(&r, 1, &e->s);
+    if (e->op == 'D') {
+        e->s.id = fieldInt(&r.f[1]);
+        return 1;
+    }
+    return 0;
+}
+
+// apply one journal entry to the table
+static void replayJournalEntry(const JournalEntry *e) {
+    if (e->op == 'D') {
+        studentTableRemove(e->s.id);
+        return;
+    }
+    int row = studentRowOf(e->s.id);
+    if (row >= 0) {
+        studentTableSet(row, &e->s);
+    } else {
+        studentTableInsert(&e->s);
+    }
+}
+
+// Returns the number of entries replayed, -1 if the journal cannot be read.
+static int replayJournal(const char *path) {
+    appendFlushPath(path);
+    FileScan scan;
+    if (scanFile(path, scanJournalLine, sizeof(JournalEntry), &scan) < 0) return -1;
+    int n = 0;
+    for (int c = 0; c < scan.nChunks; c++) {
+        ScanChunk *chunk = &scan.chunks[c];
+        for (int i = 0; i < chunk->count; i++) replayJournalEntry(SCAN_RECORD(chunk, i));
+        n += chunk->count;
+    }
+    scanFree(&scan);
+    return n;
+}
+
+// Write the live table to tmpPath. Returns 1 on success, -1 on error (tmpPath is removed).
+static int writeStudentsTemp(const char *tmpPath) {
+    FILE *tmp = fopen(tmpPath, "w");
+    if (!tmp) return -1;
+    for (int r = 0; r < g_students.count; r++) {
+        if (!g_students.live[r]) continue;
+        Student s;
+        studentAt(r, &s);
+        writeStudentLine(tmp, &s);
+    }
+    if (fclose(tmp) != 0) {
+        remove(tmpPath);
+        return -1;
+    }
+    return 1;
+}
+
+// Fold everything into STUDENTS_FILE right now and empty both journals.
+static int compactJournalNow() {
+    char tmpPath[64];
+    processTempName(STUDENTS_FILE, tmpPath, sizeof(tmpPath));
+    appendFlushPath(STUDENTS_JOURNAL);
+    if (writeStudentsTemp(tmpPath) != 1 || replaceFile(tmpPath, STUDENTS_FILE) != 0) return -1;
+    remove(STUDENTS_JOURNAL_OLD);
+    remove(STUDENTS_JOURNAL);
+    g_journalBytes = 0;
+    return 1;
+}
+
+// 1 while a background compaction is still running
+static int compactionRunning() {
+#ifndef _WIN32
+    if (g_compactPid > 0) {
+        if (waitpid(g_compactPid, NULL, WNOHANG) == 0) return 1;
+        g_compactPid = 0;
+    }
+#endif
+    return 0;
+}
+
+static void startJournalCompaction() {
+    if (compactionRunning()) return;
+    if (fileExists(STUDENTS_JOURNAL_OLD)) {
+        // an earlier compaction did not finish; fold everything in the foreground
+        compactJournalNow();
+        return;
+    }
+#ifdef _WIN32
+    compactJournalNow();
+#else
+    if (g_compactInPlace) {
+        // the child of a threaded process may only call async-signal-safe functions
+        compactJournalNow();
+        return;
+    }
+    if (appendFlushPath(STUDENTS_JOURNAL) != 1) return;
+    if (rename(STUDENTS_JOURNAL, STUDENTS_JOURNAL_OLD) != 0) return;
+    g_journalBytes = 0;
+    struct stat folding;
+    if (stat(STUDENTS_JOURNAL_OLD, &folding) != 0) return;
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // child: its copy of the table is exactly base + the rotated journal
+        char tmpPath[64];
+        processTempName(STUDENTS_FILE, tmpPath, sizeof(tmpPath));
+        if (writeStudentsTemp(tmpPath) != 1) _exit(1);
+        // record locks are per process, so this waits for the parent to let go too
+        struct stat now;
+        int ok = (lockSlot(TBL_STUDENTS, TLOCK_EXCLUSIVE) == 0 &&
+                  stat(STUDENTS_JOURNAL_OLD, &now) == 0 &&
+                  now.st_ino == folding.st_ino && now.st_size == folding.st_size);
+        if (ok) ok = (replaceFile(tmpPath, STUDENTS_FILE) == 0);
+        if (ok) remove(STUDENTS_JOURNAL_OLD);
+        else remove(tmpPath);
+        _exit(ok ? 0 : 1);
+    }
+    if (pid < 0) {
+        compactJournalNow();
+        return;
+    }
+    g_compactPid = pid;
+#endif
+}
+
+// Wait for a running compaction (called at exit so a restart never races it).
+void finishStudentJournal() {
+    appendFlushPath(STUDENTS_JOURNAL);
+#ifndef _WIN32
+    if (g_compactPid > 0) waitpid(g_compactPid, NULL, 0);
+    g_compactPid = 0;
+#endif
+}
+
+static int appendJournal(const char *entry) {
+    if (appendQueue(APPEND_JOURNAL, entry) < 0) return -1;
+    g_journalBytes += (long)strlen(entry);
+    return 1;
+}
+
+// scanner callback: one STUDENTS_FILE line -> Student
+static int scanStudentLine(const char *line, const char *end, long offset, void *rec) {
+    (void)offset;
+    Record r;
+    return recordParse(line, end, &r, 5) == 5 && studentFromRecord(&r, 0, rec);
+}
+
+static int csvLoad() {
+    FileScan scan;
+    if (scanFile(STUDENTS_FILE, scanStudentLine, sizeof(Student), &scan) < 0) return -1;
+    for (int c = 0; c < scan.nChunks; c++) {
+        ScanChunk *chunk = &scan.chunks[c];
+        for (int i = 0; i < chunk->count; i++) {
+            const Student *s = SCAN_RECORD(chunk, i);
+            // a repeated id keeps the first line, as the old linear scan did
+            if (studentRowOf(s->id) >= 0) continue;
+            if (studentTableInsert(s) < 0) {
+                scanFree(&scan);
+                return -1;
+            }
+        }
+    }
+    scanFree(&scan);
+    int hadOld = fileExists(STUDENTS_JOURNAL_OLD);
+    if (replayJournal(STUDENTS_JOURNAL_OLD) < 0 || replayJournal(STUDENTS_JOURNAL) < 0) return -1;
+    FILE *jf = fopen(STUDENTS_JOURNAL, "r");
+    if (jf) {
+        fseek(jf, 0, SEEK_END);
+        g_journalBytes = ftell(jf);
+        fclose(jf);
+    }
+    // leftovers from an interrupted compaction are folded right away (by a writer: a
+    // reader must not pull the files from under other readers)
+    if (hadOld && tableHeldExclusive(TBL_STUDENTS)) compactJournalNow();
+    return 1;
+}
+
+static int csvPut(const Student *s) {
+    char line[MAX_LINE], entry[MAX_LINE + 4];
+    snprintf(entry, sizeof(entry), "U,%s\n", studentCsvLine(s, line, sizeof(line)));
+    return appendJournal(entry);
+}
+
+static int csvTombstone(int id) {
+    char entry[32];
+    snprintf(entry, sizeof(entry), "D,%d\n", id);
+    return appendJournal(entry);
+}
+
+// Persist an insert / an update / a delete that is already applied to the table.
+// Each returns 1 on success, -1 on error.
+static int storeInsert(const Student *s) {
+    return (g_storage == STORAGE_BINARY) ? binPut(s, REC_LIVE) : csvPut(s);
+}
+
+static int storeUpdate(const Student *s) {
+    return (g_storage == STORAGE_BINARY) ? binPut(s, REC_LIVE) : csvPut(s);
+}
+
+static int storeDelete(const Student *s) {
+    return (g_storage == STORAGE_BINARY) ? binPut(s, REC_TOMBSTONE) : csvTombstone(s->id);
+}
+
+// Called once the table reflects a persisted change; compaction must snapshot that state.
+static void storeAfterWrite() {
+    studentSnapshotPublish();
+    if (g_storage == STORAGE_CSV && g_journalBytes > JOURNAL_COMPACT_BYTES) startJournalCompaction();
+}
+
+static void recoverBulkDelete();
+
+/* ---------- Load student table (once, at startup) ---------- */
+/* Returns 1 on success (a missing file is an empty table), -1 on error */
+static int loadStudentTableImpl() {
+    if (g_students.loaded) return 1;
+    if (studentIndexRebuild(0) != 0) return -1;
+    int r = (g_storage == STORAGE_BINARY) ? binLoad() : csvLoad();
+    if (r != 1) return -1;
+    g_students.loaded = 1;
+    recoverBulkDelete();
+    studentSnapshotPublish();
+    return 1;
+}
+
+int loadStudentTable() {
+    StatScope sc = statsBegin(STAT_LOAD);
+    int r = -1;
+    if (lockTables(TBL(TBL_STUDENTS), 0) == 1) {
+        r = loadStudentTableImpl();
+        unlockTables(TBL(TBL_STUDENTS));
+    }
+    statsEnd(sc);
+    return r;
+}
+
+// Another process changed the student store: forget the resident copy, it is
+// reloaded on next use.
+static void studentTableInvalidate() {
+    g_students.count = 0;
+    g_students.liveCount = 0;
+    g_students.maxId = 0;
+    g_students.loaded = 0;
+    g_snapAllDirty = 1;
+    if (g_nameArena) arenaRetire(g_nameArena); // the published version may still read it
+    g_nameArena = NULL;
+    g_journalBytes = 0;
+    binClose();
+}
+
+static int ensureStudentTable() {
+    return g_students.loaded ? 1 : loadStudentTable();
+}
+
+int studentTableMaxId() {
+    return g_students.maxId;
+}
+
+static int compareRowsById(const void *a, const void *b) {
+    int ia = g_students.rows[*(const int *)a].id;
+    int ib = g_students.rows[*(const int *)b].id;
+    return (ia > ib) - (ia < ib);
+}
+
+/* ---------- Convert students.txt -> students.dat ---------- */
+/* Writes every student from STUDENTS_FILE into a fresh STUDENTS_BIN_FILE (gaps between
+   ids become empty slots). Returns number of records written, or -1 on error. */
+static int convertStudentsToBinaryImpl() {
+    StorageBackend saved = g_storage;
+    g_storage = STORAGE_CSV;
+    int r = loadStudentTable();
+    g_storage = saved;
+    if (r != 1) return -1;
+
+    int *order = malloc((size_t)(g_students.count ? g_students.count : 1) * sizeof(int));
+    if (!order) return -1;
+    int n = 0;
+    for (int i = 0; i < g_students.count; i++) {
+        if (!g_students.live[i]) continue;
+        if (g_students.rows[i].id < FIRST_STUDENT_ID) {
+            printf("❌ Student ID %d is below %d and cannot be stored in %s. Skipped.\n",
+                   g_students.rows[i].id, FIRST_STUDENT_ID, STUDENTS_BIN_FILE);
+            continue;
+        }
+        order[n++] = i;
+    }
+    qsort(order, (size_t)n, sizeof(int), compareRowsById);
+
+    char tmpPath[64];
+    processTempName(STUDENTS_BIN_FILE, tmpPath, sizeof(tmpPath));
+    FILE *out = fopen(tmpPath, "wb");
+    if (!out) { free(order); return -1; }
+    StudentDiskHeader h;
+    fillDiskHeader(&h);
+    fwrite(&h, sizeof(h), 1, out);
+    StudentDiskRecord rec, empty;
+    memset(&empty, 0, sizeof(empty));
+    int nextSlotId = FIRST_STUDENT_ID;
+    for (int i = 0; i < n; i++) {
+        Student s;
+        studentAt(order[i], &s);
+        while (nextSlotId < s.id) { fwrite(&empty, sizeof(empty), 1, out); nextSlotId++; }
+        studentToDisk(&s, REC_LIVE, &rec);
+        fwrite(&rec, sizeof(rec), 1, out);
+        nextSlotId = s.id + 1;
+    }
+    free(order);
+    if (fclose(out) != 0) {
+        remove(tmpPath);
+        return -1;
+    }
+    binClose();
+    if (replaceFile(tmpPath, STUDENTS_BIN_FILE) != 0) return -1;
+    return n;
+}
+
+int convertStudentsToBinary() {
+    if (lockTables(TBL(TBL_STUDENTS), TBL(TBL_STUDENTS)) != 1) return -1;
+    int r = convertStudentsToBinaryImpl();
+    unlockTables(TBL(TBL_STUDENTS));
+    return r;
+}
+
+/* ---------- Marksheet index ---------- */
+/* studentId -> byte offsets of that student's lines in MARKSHEET_FILE, built by one
+   scan on first use. addMarksheet appends offsets as it writes, and the marksheet
+   rewrite in deleteStudentRecord moves the offsets to where it writes the lines, so
+   a view reads just the student's lines, from a mapping of the file that is kept with
+   the index. The expected file size is kept too:
+   if the file changed behind our back the index is rebuilt.
+   Next to each offset the index keeps that marksheet's (semester's) score total and
+   subject count, and per student the cumulative total and count, all in hundredths so
+   that adding and taking away marksheets never drifts. Semester averages and the
+   cumulative CGPA are then read without touching the file. */
+
+typedef struct {
+    int sum;        // scores of one marksheet line, in hundredths
+    int subjects;
+} MarkTotals;
+
+typedef struct {
+    long *offsets;
+    MarkTotals *sheets;     // parallel to offsets
+    int count;
+    int cap;
+    long long sum;          // every marksheet of the student, in hundredths
+    int subjects;
+    int seen;               // lines matched so far by a rewrite or a verify pass
+} OffsetList;
+
+typedef struct {
+    int *keys;              // student id per slot (0 = empty)
+    OffsetList *lists;      // parallel to keys
+    int cap;                // power of two
+    int used;
+    long fileSize;          // size of MARKSHEET_FILE the offsets describe
+    int loaded;
+    MappedFile file;        // MARKSHEET_FILE, mapped by marksheetMapping()
+} MarksheetIndex;
+
+static MarksheetIndex g_marks;
+
+static void marksheetIndexClear() {
+    for (int i = 0; i < g_marks.cap; i++) {
+        free(g_marks.lists[i].offsets);
+        free(g_marks.lists[i].sheets);
+    }
+    free(g_marks.keys);
+    free(g_marks.lists);
+    unmapFile(&g_marks.file);
+    memset(&g_marks, 0, sizeof(g_marks));
+}
+
+static OffsetList *marksheetListFor(int studentId, int create) {
+    if (g_marks.cap == 0 || (create && (g_marks.used + 1) * 2 > g_marks.cap)) {
+        if (!create) return NULL;
+        int cap = g_marks.cap ? g_marks.cap * 2 : 1024;
+        int *keys = calloc((size_t)cap, sizeof(int));
+        OffsetList *lists = calloc((size_t)cap, sizeof(OffsetList));
+        if (!keys || !lists) { free(keys); free(lists); return NULL; }
+        for (int i = 0; i < g_marks.cap; i++) {
+            if (!g_marks.keys[i]) continue;
+            unsigned int j = hashStudentId(g_marks.keys[i]) & (unsigned int)(cap - 1);
+            while (keys[j]) j = (j + 1) & (unsigned int)(cap - 1);
+            keys[j] = g_marks.keys[i];
+            lists[j] = g_marks.lists[i];
+        }
+        free(g_marks.keys);
+        free(g_marks.lists);
+        g_marks.keys = keys;
+        g_marks.lists = lists;
+        g_marks.cap = cap;
+    }
+    unsigned int mask = (unsigned int)g_marks.cap - 1;
+    unsigned int j = hashStudentId(studentId) & mask;
+    while (g_marks.keys[j]) {
+        if (g_marks.keys[j] == studentId) return &g_marks.lists[j];
+        j = (j + 1) & mask;
+    }
+    if (!create) return NULL;
+    g_marks.keys[j] = studentId;
+    g_marks.used++;
+    return &g_marks.lists[j];
+}
+
+static void marksheetIndexAdd(int studentId, long offset, MarkTotals totals) {
+    OffsetList *l = marksheetListFor(studentId, 1);
+    if (!l) {
+        g_marks.loaded = 0; // out of memory: fall back to a rebuild on next use
+        return;
+    }
+    if (l->count == l->cap) {
+        int cap = l->cap ? l->cap * 2 : 4;
+        long *grown = realloc(l->offsets, (size_t)cap * sizeof(long));
+        if (grown) l->offsets = grown;
+        MarkTotals *sheets = grown ? realloc(l->sheets, (size_t)cap * sizeof(MarkTotals)) : NULL;
+        if (!sheets) { g_marks.loaded = 0; return; }
+        l->sheets = sheets;
+        l->cap = cap;
+    }
+    l->offsets[l->count] = offset;
+    l->sheets[l->count++] = totals;
+    l->sum += totals.sum;
+    l->subjects += totals.subjects;
+}
+
+// totals of a parsed marksheet line: id,semester, then subject,score,grade triplets
+static MarkTotals marksheetTotals(const Record *rec) {
+    MarkTotals t = { 0, 0 };
+    for (int f = 2; f + 2 < rec->n; f += 3) {
+        t.sum += fieldHundredths(&rec->f[f + 1]);
+        t.subjects++;
+    }
+    return t;
+}
+
+// hundredths average of sum over count, rounded half up; 0 when count is 0
+static int averageHundredths(long long sum, int count) {
+    if (count <= 0) return 0;
+    return (int)((2 * sum + count) / (2LL * count));
+}
+
+// Make sure the index matches MARKSHEET_FILE (a missing file is an empty index).
+// Returns 1 on success, -1 if the file cannot be read.
+typedef struct {
+    int studentId;
+    long offset;
+    MarkTotals totals;
+} MarksheetLineRef;
+
+// scanner callback: where a marksheet line starts, whose it is and its totals
+static int scanMarksheetLine(const char *line, const char *end, long offset, void *rec) {
+    MarksheetLineRef *ref = rec;
+    Record r;
+    if (recordParse(line, end, &r, REC_MAX_FIELDS) < 1) return 0;
+    ref->studentId = fieldInt(&r.f[0]);
+    ref->offset = offset;
+    ref->totals = marksheetTotals(&r);
+    return ref->studentId != 0;
+}
+
+static int ensureMarksheetIndex() {
+    long size = appendEnd(APPEND_MARKSHEETS); // queued lines are already indexed
+    if (g_marks.loaded && g_marks.fileSize == size) return 1;
+    marksheetIndexClear();
+    if (appendFlushPath(MARKSHEET_FILE) != 1) return -1;
+    FileScan scan;
+    if (scanFile(MARKSHEET_FILE, scanMarksheetLine, sizeof(MarksheetLineRef), &scan) < 0) return -1;
+    for (int c = 0; c < scan.nChunks; c++) {
+        ScanChunk *chunk = &scan.chunks[c];
+        for (int i = 0; i < chunk->count; i++) {
+            const MarksheetLineRef *ref = SCAN_RECORD(chunk, i);
+            marksheetIndexAdd(ref->studentId, ref->offset, ref->totals);
+        }
+    }
+    g_marks.fileSize = scan.size;
+    g_marks.loaded = 1;
+    scanFree(&scan);
+    return 1;
+}
+
+/* A rewrite that drops some students' lines keeps every other line in order, so a
+   kept line is the next not yet seen entry of its student's list: it keeps its totals
+   and only its offset moves. Lists left with no lines (the dropped students) lose
+   their totals. A line the index does not know means the index was stale; it is then
+   cleared and rebuilt by the next ensureMarksheetIndex(). */
+static int g_marksRewriteOk;
+
+static void marksheetRewriteBegin() {
+    g_marksRewriteOk = g_marks.loaded && appendEnd(APPEND_MARKSHEETS) == g_marks.fileSize;
+    for (int i = 0; i < g_marks.cap; i++) g_marks.lists[i].seen = 0;
+}
+
+static void marksheetRewriteLine(int studentId, long offset) {
+    if (!g_marksRewriteOk) return;
+    OffsetList *l = marksheetListFor(studentId, 0);
+    if (!l || l->seen >= l->count) {
+        g_marksRewriteOk = 0;
+        return;
+    }
+    l->offsets[l->seen++] = offset;
+}
+
+static void marksheetRewriteEnd(long size) {
+    for (int i = 0; g_marksRewriteOk && i < g_marks.cap; i++) {
+        OffsetList *l = &g_marks.lists[i];
+        if (!g_marks.keys[i] || l->seen == l->count) continue;
+        if (l->seen != 0) g_marksRewriteOk = 0; // only whole students are dropped
+        l->count = 0;
+        l->sum = 0;
+        l->subjects = 0;
+    }
+    if (!g_marksRewriteOk) {
+        marksheetIndexClear();
+        return;
+    }
+    g_marks.fileSize = size;
+    g_marks.loaded = 1;
+}
+
+// MARKSHEET_FILE mapped as far as the index describes it; the mapping is kept between
+// views and dropped with the index. Returns NULL if the file cannot be mapped.
+static const MappedFile *marksheetMapping() {
+    if (g_marks.file.size != (size_t)g_marks.fileSize) {
+        unmapFile(&g_marks.file);
+        if (mapFile(MARKSHEET_FILE, &g_marks.file) < 0) return NULL;
+    }
+    return &g_marks.file;
+}
+
+/* ---------- Resident copies vs. other processes ---------- */
+// called by lockTables() when another process has changed table t since we loaded it
+static void tableCacheInvalidate(TableId t) {
+    switch (t) {
+        case TBL_SEQUENCES:  g_sequencesLoaded = 0; break;
+        case TBL_ADMISSIONS:
+        case TBL_LOGINS:     usernameIndexClear(); break;
+        case TBL_STUDENTS:   studentTableInvalidate(); break;
+        case TBL_MARKSHEETS: marksheetIndexClear(); break;
+        default: break;
+    }
+}
+
+/* ---------- Add student record (students.txt) ---------- */
+/* Returns 1 on success, 0 if duplicate id, -1 on error */
+static int addStudentRecordImpl(const Student *s) {
+    if (!s) return -1;
+    if (ensureStudentTable() != 1) return -1;
+
+    // Check duplicate id first
+    if (studentRowOf(s->id) >= 0) return 0; // duplicate
+
+    if (storeInsert(s) != 1) return -1;
+    if (studentTableInsert(s) < 0) return -1;
+    observeId(SEQ_STUDENTS, s->id);
+    storeAfterWrite();
+    return 1;
+}
+
+int addStudentRecord(const Student *s) {
+    StatScope sc = statsBegin(STAT_ADD_STUDENT);
+    unsigned tables = TBL(TBL_SEQUENCES) | TBL(TBL_STUDENTS);
+    int r;
+    if (g_remote) {
+        r = remoteAddStudentRecord(s);
+    } else if (lockTables(tables, tables) != 1) {
+        r = -1;
+    } else {
+        r = addStudentRecordImpl(s);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Add many students with one store write ---------- */
+/* status[i] (optional) gets 1 if list[i] was added, 0 if its id already existed.
+   Returns number added, or -1 on error (nothing is added then). */
+static int addStudentRecordsBatchImpl(const Student *list, int count, int *status) {
+    if (!list || count < 0) return -1;
+    if (ensureStudentTable() != 1) return -1;
+    unsigned char *mine = calloc((size_t)(count > 0 ? count : 1), 1); // rows this call inserted
+    if (!mine) return -1;
+    TextBuf journal = {0};
+    int added = 0, maxId = 0, failed = 0;
+    for (int i = 0; i < count && !failed; i++) {
+        const Student *s = &list[i];
+        if (studentRowOf(s->id) >= 0) continue; // duplicate id
+        char line[MAX_LINE];
+        if (g_storage == STORAGE_CSV &&
+            textBufPrintf(&journal, "U,%s\n", studentCsvLine(s, line, sizeof(line))) != 0) failed = 1;
+        if (!failed && g_storage == STORAGE_BINARY && binPut(s, REC_LIVE) != 1) failed = 1;
+        if (!failed && studentTableInsert(s) < 0) failed = 1;
+        if (failed) break;
+        mine[i] = 1;
+        added++;
+        if (s->id > maxId) maxId = s->id;
+    }
+    if (!failed && g_storage == STORAGE_CSV && journal.len > 0 && appendJournal(journal.data) != 1) failed = 1;
+    textBufFree(&journal);
+    for (int i = 0; i < count; i++) {
+        if (failed && mine[i]) {
+            // take the row back out (binary slots already written become tombstones)
+            if (g_storage == STORAGE_BINARY) binPut(&list[i], REC_TOMBSTONE);
+            studentTableRemove(list[i].id);
+            mine[i] = 0;
+        }
+        if (status) status[i] = mine[i];
+    }
+    free(mine);
+    if (failed) return -1;
+    if (maxId > 0) observeId(SEQ_STUDENTS, maxId);
+    storeAfterWrite();
+    return added;
+}
+
+int addStudentRecordsBatch(const Student *list, int count, int *status) {
+    StatScope sc = statsBegin(STAT_ADD_STUDENTS);
+    unsigned tables = TBL(TBL_SEQUENCES) | TBL(TBL_STUDENTS);
+    int r;
+    if (g_remote) {
+        r = remoteAddStudentRecordsBatch(list, count, status);
+    } else if (lockTables(tables, tables) != 1) {
+        r = -1;
+    } else {
+        r = addStudentRecordsBatchImpl(list, count, status);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Find student by id ---------- */
+/* Returns 1 if found and fills out, 0 if not found, -1 if the table could not be loaded */
+static int findStudentByIdImpl(int id, Student *out) {
+    if (ensureStudentTable() != 1) return -1;
+    int row = studentRowOf(id);
+    if (row < 0) return 0;
+    if (out) studentAt(row, out);
+    return 1;
+}
+
+int findStudentById(int id, Student *out) {
+    StatScope sc = statsBegin(STAT_FIND);
+    unsigned tables = TBL(TBL_STUDENTS);
+    int r;
+    if (g_remote) {
+        r = remoteFindStudentById(id, out);
+    } else if (lockTables(tables, 0) != 1) {
+        r = -1;
+    } else {
+        r = findStudentByIdImpl(id, out);
+        unlockTables(tables);
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Update student record ---------- */
+/* Returns 1 on success, 0 if not found, -1 on error */
+static int updateStudentRecordImpl(int id, const Student *newData) {
+    if (ensureStudentTable() != 1) return -1;
+    int row = studentRowOf(id);
+    if (row < 0) return 0;
+
+    Student old, s = *newData;
+    studentAt(row, &old);
+    s.id = id;
+    if (studentTableSet(row, &s) != 0) return -1;
+    if (storeUpdate(&s) != 1) {
+        studentTableSet(row, &old); // keep memory in line with the file
+        return -1;
+    }
+    studentTableCompact();
+    storeAfterWrite();
+    return 1;
+}
+
+int updateStudentRecord(int id, const Student *newData) {
+    StatScope sc = statsBegin(STAT_UPDATE);
+    unsigned tables = TBL(TBL_STUDENTS);
+    int r;
+    if (g_remote) {
+        r = remoteUpdateStudentRecord(id, newData);
+    } else if (lockTables(tables, tables) != 1) {
+        r = -1;
+    } else {
+        r = updateStudentRecordImpl(id, newData);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Bulk delete (students + marksheets + logins) ---------- */
+/* One id set is applied to all three tables: students get one batch of tombstones
+   (a single journal append, or in-place slots for the binary store), MARKSHEET_FILE
+   and LOGINS_FILE are each rewritten exactly once into their own temp file.
+   The change is published through DELETE_COMMIT_FILE: once it exists the delete
+   is decided, and loadStudentTable() finishes any renames a crash interrupted, so
+   the three files never disagree about which students exist. */
+
+typedef struct {
+    int *keys;      // 0 = empty
+    int cap;        // power of two
+} IdSet;
+
+static int idSetInit(IdSet *set, int count) {
+    set->cap = 64;
+    while (set->cap < count * 2) set->cap *= 2;
+    set->keys = calloc((size_t)set->cap, sizeof(int));
+    return set->keys ? 0 : -1;
+}
+
+static void idSetAdd(IdSet *set, int id) {
+    unsigned int mask = (unsigned int)set->cap - 1;
+    unsigned int j = hashStudentId(id) & mask;
+    while (set->keys[j] && set->keys[j] != id) j = (j + 1) & mask;
+    set->keys[j] = id;
+}
+
+static int idSetHas(const IdSet *set, int id) {
+    unsigned int mask = (unsigned int)set->cap - 1;
+    unsigned int j = hashStudentId(id) & mask;
+    while (set->keys[j]) {
+        if (set->keys[j] == id) return 1;
+        j = (j + 1) & mask;
+    }
+    return 0;
+}
+
+// Copy `path` to `tmpPath` without the lines whose `field`-th value (1-based) is in ids.
+// Marksheet offsets are re-indexed on the way. Returns lines dropped, or -1 on error.
+static int rewriteWithoutIds(const char *path, const char *tmpPath, int field, const IdSet *ids,
+                             int reindexMarks, TextBuf *droppedUsers) {
+    if (appendFlushPath(path) != 1) return -1;
+    RecordReader rd;
+    int r = recordReaderOpen(&rd, path);
+    if (r <= 0) return r; // nothing to rewrite, or unreadable
+    FILE *out = fopen(tmpPath, "wb");
+    if (!out) {
+        recordReaderClose(&rd);
+        return -1;
+    }
+    // the kept lines keep their totals; only their offsets move (see marksheetRewriteLine)
+    if (reindexMarks) marksheetRewriteBegin();
+    Record rec;
+    long off = 0;
+    int dropped = 0;
+    while (recordNext(&rd, &rec, field)) {
+        if (rec.n >= field && rec.f[field - 1].len > 0 && idSetHas(ids, fieldInt(&rec.f[field - 1]))) {
+            dropped++;
+            if (droppedUsers) {
+                // logins: remember the username (first field) to clear it from the index
+                char username[MAX_LINE];
+                textBufPrintf(droppedUsers, "%s%c", fieldCopy(&rec.f[0], username, sizeof(username)), '\0');
+            }
+            continue;
+        }
+        fprintf(out, "%.*s\n", rec.lineLen, rec.line);
+        if (reindexMarks) marksheetRewriteLine(fieldInt(&rec.f[0]), off);
+        off += rec.lineLen + 1;
+    }
+    recordReaderClose(&rd);
+    if (fclose(out) != 0) {
+        remove(tmpPath);
+        if (reindexMarks) marksheetIndexClear(); // offsets were half moved
+        return -1;
+    }
+    // describes tmpPath, which replaces path when the delete is published
+    if (reindexMarks) marksheetRewriteEnd(off);
+    return dropped;
+}
+
+// tombstone the students (table + store); the ids must all be in the table
+static int deleteStudentRows(const int *ids, int count) {
+    TextBuf journal = {0};
+    int rc = 1;
+    for (int i = 0; i < count; i++) {
+        int row = studentRowOf(ids[i]);
+        if (row < 0) continue;
+        if (g_storage == STORAGE_BINARY) {
+            Student old;
+            studentAt(row, &old);
+            if (storeDelete(&old) != 1) rc = -1;
+        } else if (textBufPrintf(&journal, "D,%d\n", ids[i]) != 0) {
+            rc = -1;
+        }
+        studentTableRemove(ids[i]);
+    }
+    if (rc == 1 && journal.len > 0) rc = appendJournal(journal.data);
+    textBufFree(&journal);
+    return rc;
+}
+
+/* Finish a bulk delete whose commit file was written (also used for crash recovery).
+   Every step can be repeated, so the commit file is removed only once all of them
+   succeeded; otherwise it stays for the next load to finish. Returns 1 on success,
+   -1 on error. */
+static int applyDeleteCommit() {
+    FILE *fp = fopen(DELETE_COMMIT_FILE, "r");
+    if (!fp) return -1;
+    int *ids = NULL, n = 0, cap = 0, ok = 1;
+    char line[MAX_LINE];
+    while (ok && readLine(line, sizeof(line), fp)) {
+        trim(line);
+        if (line[0] == 'S' && line[1] == ',') {
+            if (n == cap) {
+                cap = cap ? cap * 2 : 256;
+                int *grown = realloc(ids, (size_t)cap * sizeof(int));
+                if (!grown) {
+                    ok = 0;
+                    break;
+                }
+                ids = grown;
+            }
+            ids[n++] = atoi(line + 2);
+        }
+    }
+    if (ferror(fp)) ok = 0;
+    // tombstones first, and on disk rather than queued for the group commit: the
+    // renames below make the delete visible, and a rename is not repeated
+    if (ok && deleteStudentRows(ids, n) != 1) ok = 0;
+    if (ok && g_storage == STORAGE_CSV && appendFlushPath(STUDENTS_JOURNAL) != 1) ok = 0;
+    if (ok && g_storage == STORAGE_BINARY && g_durability != DURABILITY_NONE && storeSync() != 1) ok = 0;
+    free(ids);
+    rewind(fp);
+    while (ok && readLine(line, sizeof(line), fp)) {
+        trim(line);
+        if (line[0] == 'R' && line[1] == ',') {
+            char *parts[3];
+            if (splitFields(line, parts, 3) != 3) ok = 0;
+            else if (fileExists(parts[1]) && replaceFile(parts[1], parts[2]) != 0) ok = 0;
+        }
+    }
+    fclose(fp);
+    storeAfterWrite();
+    if (!ok) return -1;
+    remove(DELETE_COMMIT_FILE);
+    return 1;
+}
+
+// called after the student table is loaded: finish or discard an interrupted bulk delete
+static void recoverBulkDelete() {
+    if (fileExists(DELETE_COMMIT_FILE)) {
+        if (applyDeleteCommit() != 1 && !g_quiet) {
+            printf("❌ Unable to finish an interrupted delete (%s is kept for the next start).\n", DELETE_COMMIT_FILE);
+        }
+        g_marks.loaded = 0;
+        usernameIndexClear(); // rebuilt lazily from the final files
+    }
+    // temp files without a commit record belong to a delete that never happened
+    remove(DELETE_COMMIT_TMP);
+    remove(MARKSHEET_DELETE_TMP);
+    remove(LOGINS_DELETE_TMP);
+}
+
+/* Delete every listed student with their marksheets and logins.
+   Returns number of students deleted (ids not in the table are ignored), -1 on error. */
+static int deleteStudentsBatchImpl(const int *ids, int count) {
+    if (ensureStudentTable() != 1) return -1;
+    IdSet set;
+    if (idSetInit(&set, count) != 0) return -1;
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        if (studentRowOf(ids[i]) >= 0 && !idSetHas(&set, ids[i])) {
+            idSetAdd(&set, ids[i]);
+            found++;
+        }
+    }
+    if (found == 0) {
+        free(set.keys);
+        return 0;
+    }
+
+    // 1) one rewrite of each dependent file, into private temp files
+    TextBuf droppedUsers = {0};
+    int rm = rewriteWithoutIds(MARKSHEET_FILE, MARKSHEET_DELETE_TMP, 1, &set, 1, NULL);
+    int rl = (rm < 0) ? -1 : rewriteWithoutIds(LOGINS_FILE, LOGINS_DELETE_TMP, 4, &set, 0, &droppedUsers);
+    // a file only exists once its queued appends are flushed, which the rewrite does
+    int hadMarks = fileExists(MARKSHEET_DELETE_TMP), hadLogins = fileExists(LOGINS_DELETE_TMP);
+
+    // 2) commit record: from here on the delete happens, even after a crash
+    FILE *commit = (rl < 0) ? NULL : fopen(DELETE_COMMIT_TMP, "w");
+    int ok = (commit != NULL);
+    for (int i = 0; ok && i < set.cap; i++) {
+        if (set.keys[i]) fprintf(commit, "S,%d\n", set.keys[i]);
+    }
+    if (ok && hadMarks) fprintf(commit, "R,%s,%s\n", MARKSHEET_DELETE_TMP, MARKSHEET_FILE);
+    if (ok && hadLogins) fprintf(commit, "R,%s,%s\n", LOGINS_DELETE_TMP, LOGINS_FILE);
+    if (commit && fclose(commit) != 0) ok = 0;
+    if (ok && replaceFile(DELETE_COMMIT_TMP, DELETE_COMMIT_FILE) != 0) ok = 0;
+    free(set.keys);
+    if (!ok) {
+        remove(DELETE_COMMIT_TMP);
+        remove(MARKSHEET_DELETE_TMP);
+        remove(LOGINS_DELETE_TMP);
+        g_marks.loaded = 0; // offsets were rebuilt for a file that was not published
+        textBufFree(&droppedUsers);
+        return -1;
+    }
+
+    // 3) publish: student tombstones, then the two renames
+    if (applyDeleteCommit() != 1) {
+        // the commit file stays, so the next load finishes the delete
+        studentTableInvalidate(); // rows may be gone from the table but not from disk
+        g_marks.loaded = 0;
+        usernameIndexClear();
+        textBufFree(&droppedUsers);
+        return -1;
+    }
+    for (size_t p = 0; p < droppedUsers.len; p += strlen(droppedUsers.data + p) + 1) {
+        usernameIndexRemove(droppedUsers.data + p, UNAME_IN_LOGINS);
+    }
+    textBufFree(&droppedUsers);
+    return found;
+}
+
+int deleteStudentsBatch(const int *ids, int count) {
+    StatScope sc = statsBegin(STAT_DELETE_BATCH);
+    unsigned tables = TBL(TBL_STUDENTS) | TBL(TBL_LOGINS) | TBL(TBL_MARKSHEETS);
+    int r;
+    if (g_remote) {
+        r = remoteDeleteStudentsBatch(ids, count);
+    } else if (lockTables(tables, tables) != 1) {
+        r = -1;
+    } else {
+        r = deleteStudentsBatchImpl(ids, count);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* Delete every student for which pred(student, ctx) is non-zero (e.g. semester > 8).
+   Returns number deleted, or -1 on error. */
+static int deleteStudentsWhereImpl(int (*pred)(const Student *, void *), void *ctx) {
+    if (ensureStudentTable() != 1) return -1;
+    int *ids = malloc((size_t)(g_students.liveCount > 0 ? g_students.liveCount : 1) * sizeof(int));
+    if (!ids) return -1;
+    int n = 0;
+    for (int r = 0; r < g_students.count; r++) {
+        if (!g_students.live[r]) continue;
+        Student s;
+        studentAt(r, &s);
+        if (pred(&s, ctx)) ids[n++] = s.id;
+    }
+    int deleted = (n > 0) ? deleteStudentsBatch(ids, n) : 0;
+    free(ids);
+    return deleted;
+}
+
+int deleteStudentsWhere(int (*pred)(const Student *, void *), void *ctx) {
+    StatScope sc = statsBegin(STAT_DELETE_WHERE);
+    unsigned tables = TBL(TBL_STUDENTS) | TBL(TBL_LOGINS) | TBL(TBL_MARKSHEETS);
+    int r;
+    if (g_remote) {
+        r = remoteDeleteStudentsWhere(pred, ctx);
+    } else if (lockTables(tables, tables) != 1) {
+        r = -1;
+    } else {
+        r = deleteStudentsWhereImpl(pred, ctx);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Delete student record ---------- */
+/* Returns 1 on success, 0 if not found, -1 on error */
+static int deleteStudentRecordImpl(int id) {
+    int r = deleteStudentsBatch(&id, 1);
+    return (r < 0) ? -1 : (r > 0 ? 1 : 0);
+}
+
+int deleteStudentRecord(int id) {
+    StatScope sc = statsBegin(STAT_DELETE);
+    int r = deleteStudentRecordImpl(id);
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- List all students ---------- */
+static void printStudentListHeader() {
+    printf("\n===== All Student Records =====\n");
+    printf("%-6s  %-25s  %-15s  %-8s  %-6s\n", "ID", "Name", "Department", "Semester", "CGPA");
+    printf("----------------------------------------------------------------------\n");
+}
+
+#define STUDENT_LIST_ROW "%-6d  %-25s  %-15s  %-8d  %-6s\n"
+
+static void printStudentListRow(const Student *s) {
+    char cgpa[NUM_BUF];
+    formatHundredths(s->cgpa, cgpa);
+    printf(STUDENT_LIST_ROW, s->id, s->name, s->department, s->semester, cgpa);
+}
+
+/* Long listings format their rows into one buffer and hand it to stdout
+   LIST_FLUSH_BYTES at a time, rather than one printf (and on a terminal, one write)
+   per row. */
+#define LIST_FLUSH_BYTES (256 * 1024)
+
+static void listOutFlush(TextBuf *b) {
+    if (b->len) fwrite(b->data, 1, b->len, stdout);
+    b->len = 0;
+}
+
+static void listOutStudent(TextBuf *b, const Student *s) {
+    char cgpa[NUM_BUF];
+    formatHundredths(s->cgpa, cgpa);
+    textBufPrintf(b, STUDENT_LIST_ROW, s->id, s->name, s->department, s->semester, cgpa);
+    if (b->len >= LIST_FLUSH_BYTES) listOutFlush(b);
+}
+
+static void listOutEnd(TextBuf *b) {
+    listOutFlush(b);
+    textBufFree(b);
+    fflush(stdout);
+}
+
+/* Catch the resident table up with other processes before a snapshot read. Daemon
+   readers skip this: their table is kept current under the daemon's write lock, and
+   they only look at the published version, since a writer may be reloading g_students
+   meanwhile (once published, there is always a version to read). */
+static int syncStudentTable() {
+    if (t_readOnlyCaches) return atomic_load(&g_snapCurrent) ? 1 : -1;
+    if (lockTables(TBL(TBL_STUDENTS), 0) != 1) return -1;
+    int r = ensureStudentTable();
+    unlockTables(TBL(TBL_STUDENTS));
+    return r;
+}
+
+static void listAllStudentsImpl() {
+    if (syncStudentTable() != 1) {
+        printf("❌ No student records found!\n");
+        return;
+    }
+    const StudentVersion *v = studentSnapshotPin();
+    if (!v || v->liveCount == 0) {
+        studentSnapshotRelease();
+        printf("❌ No student records found!\n");
+        return;
+    }
+    printStudentListHeader();
+    TextBuf buf = {0};
+    for (int r = 0; r < v->count; r++) {
+        Student s;
+        if (snapshotStudent(v, r, &s)) listOutStudent(&buf, &s);
+    }
+    studentSnapshotRelease();
+    listOutEnd(&buf);
+}
+
+void listAllStudents() {
+    StatScope sc = statsBegin(STAT_LIST);
+    if (g_remote) remoteListAllStudents();
+    else listAllStudentsImpl();
+    statsEnd(sc);
+}
+
+/* ---------- Paged student listing ---------- */
+#define LIST_PAGE_ROWS 50 // default page of the listing commands and menus
+
+// a ListFilter with the department resolved to its id in one version
+typedef struct {
+    int dept;           // -1 = any department
+    int semester;       // 0 = any
+} RowFilter;
+
+static RowFilter rowFilterFor(const StudentVersion *v, const ListFilter *f) {
+    RowFilter rf = { -1, f->semester };
+    if (f->department && f->department[0]) rf.dept = departmentScan(f->department, v->nDepts);
+    return rf;
+}
+
+// position of the first matching row from `from` stepping by step (+1 / -1), or -1
+static int studentScan(const StudentVersion *v, const RowFilter *f, int from, int step) {
+    for (int r = from; r >= 0 && r < v->count; r += step) {
+        const StudentRec *s = snapshotRow(v, r);
+        if (s && (f->dept < 0 || s->dept == f->dept) && (!f->semester || s->semester == f->semester)) return r;
+    }
+    return -1;
+}
+
+/* Walk the snapshot from the cursor in the page's direction, then one match further
+   each way to learn whether there is a page before and after. */
+static int listStudentsPageImpl(const ListFilter *f, int cursor, int limit, int backward,
+                                Student **out, ListPage *page) {
+    *out = NULL;
+    page->next = page->prev = -1;
+    if (syncStudentTable() != 1) return -1;
+    Student *list = malloc((size_t)limit * sizeof(Student));
+    if (!list) return -1;
+    const StudentVersion *v = studentSnapshotPin();
+    int n = 0;
+    if (v) {
+        RowFilter rf = rowFilterFor(v, f);
+        int step = backward ? -1 : 1;
+        if (cursor > v->count) cursor = v->count;
+        int start = studentScan(v, &rf, backward ? cursor - 1 : cursor, step);
+        int last = start, r;
+        for (r = start; r >= 0 && n < limit; r = studentScan(v, &rf, r + step, step)) {
+            snapshotStudent(v, r, &list[n++]);
+            last = r;
+        }
+        if (backward) {
+            for (int i = 0; i < n / 2; i++) {
+                Student t = list[i];
+                list[i] = list[n - 1 - i];
+                list[n - 1 - i] = t;
+            }
+            if (r >= 0) page->prev = last;
+            page->next = studentScan(v, &rf, cursor, 1);
+        } else {
+            page->next = r;
+            if (n && studentScan(v, &rf, start - 1, -1) >= 0) page->prev = start;
+        }
+    }
+    studentSnapshotRelease();
+    *out = list;
+    return n;
+}
+
+int listStudentsPage(const ListFilter *f, int cursor, int limit, int backward, Student **out, ListPage *page) {
+    StatScope sc = statsBegin(STAT_LIST_PAGE);
+    ListFilter any = {0};
+    if (!f) f = &any;
+    if (limit <= 0) limit = 1;
+    if (cursor < 0) cursor = 0;
+    int r = g_remote ? remoteListStudentsPage(f, cursor, limit, backward, out, page)
+                     : listStudentsPageImpl(f, cursor, limit, backward, out, page);
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Department and semester analytics ---------- */
+/* One pass over the analytics columns fills a department x CGPA histogram (CGPA in
+   hundredths) and a semester histogram. Counts, averages, medians and the CGPA
+   distribution are all read off the histograms, so no row is visited twice and
+   nothing is sorted. Past ANALYTICS_DEPT_BLOCK departments the pass is repeated per
+   block of departments, which keeps the histogram small enough to stay in cache. */
+
+#define ANALYTICS_DEPT_BLOCK 256
+#define CGPA_BINS (COL_CGPA_MAX + 1)
+
+static const char *const g_cgpaBucketLabels[ANALYTICS_BUCKETS] = {
+    "<2.00", "2.00-2.49", "2.50-2.99", "3.00-3.49", ">=3.50"
+};
+static const int g_cgpaBucketFloor[ANALYTICS_BUCKETS] = { 0, 200, 250, 300, 350 }; // hundredths
+
+// middle value of n > 0 values in bins (mean of the two middle ones, rounded half up,
+// when n is even)
+static int cgpaHistogramMedian(const unsigned *bins, long n) {
+    long lo = (n - 1) / 2, hi = n / 2, seen = 0;
+    int a = -1;
+    for (int v = 0; v < CGPA_BINS; v++) {
+        seen += bins[v];
+        if (a < 0 && seen > lo) a = v;
+        if (seen > hi) return (a + v + 1) / 2;
+    }
+    return 0;
+}
+
+/* Count departments first .. first + nDepts - 1 into hist (nDepts rows of CGPA_BINS);
+   when sem is given, also count every live row into it by semester. */
+static void analyticsScan(int first, int nDepts, unsigned *hist, unsigned *sem) {
+    const unsigned short *dept = g_cols.dept, *cgpa = g_cols.cgpa;
+    const unsigned char *semester = g_cols.semester;
+    int count = g_cols.count;
+    for (int r = 0; r < count; r++) {
+        unsigned d = dept[r];
+        if (d == DEPT_NONE) continue;
+        if (sem) sem[semester[r]]++;
+        d -= (unsigned)first;
+        if (d < (unsigned)nDepts) hist[d * CGPA_BINS + cgpa[r]]++;
+    }
+}
+
+static int compareDeptAnalytics(const void *a, const void *b) {
+    return strcmp(((const DeptAnalytics *)a)->department, ((const DeptAnalytics *)b)->department);
+}
+
+/* Returns 1 and fills out (the caller frees out->depts), -1 on error */
+static int studentAnalyticsImpl(AnalyticsReport *out) {
+    memset(out, 0, sizeof(*out));
+    if (ensureStudentTable() != 1 || ensureStudentColumns() != 1) return -1;
+    int nDepts = g_depts.count;
+    int block = nDepts < ANALYTICS_DEPT_BLOCK ? nDepts : ANALYTICS_DEPT_BLOCK;
+    DeptAnalytics *depts = calloc((size_t)(nDepts ? nDepts : 1), sizeof(DeptAnalytics));
+    unsigned *hist = malloc((size_t)(block ? block : 1) * CGPA_BINS * sizeof(unsigned));
+    unsigned *total = calloc(CGPA_BINS, sizeof(unsigned));
+    unsigned sem[ANALYTICS_SEMESTERS] = {0};
+    if (!depts || !hist || !total) {
+        free(depts);
+        free(hist);
+        free(total);
+        return -1;
+    }
+    long long sumAll = 0;
+    for (int first = 0; first < nDepts; first += block) {
+        int n = (nDepts - first < block) ? nDepts - first : block;
+        memset(hist, 0, (size_t)n * CGPA_BINS * sizeof(unsigned));
+        analyticsScan(first, n, hist, first == 0 ? sem : NULL);
+        for (int d = 0; d < n; d++) {
+            const unsigned *bins = &hist[(size_t)d * CGPA_BINS];
+            long count = 0;
+            long long sum = 0;
+            for (int v = 0; v < CGPA_BINS; v++) {
+                count += bins[v];
+                sum += (long long)bins[v] * v;
+                total[v] += bins[v];
+            }
+            if (count == 0) continue; // department no longer has students
+            DeptAnalytics *da = &depts[out->nDepts++];
+            strncpy(da->department, departmentName(first + d), sizeof(da->department)-1);
+            da->students = (int)count;
+            da->avgCgpa = averageHundredths(sum, (int)count);
+            da->medianCgpa = cgpaHistogramMedian(bins, count);
+            out->students += (int)count;
+            sumAll += sum;
+        }
+    }
+    if (out->students > 0) {
+        out->avgCgpa = averageHundredths(sumAll, out->students);
+        out->medianCgpa = cgpaHistogramMedian(total, out->students);
+    }
+    for (int b = 0; b < ANALYTICS_BUCKETS; b++) {
+        int end = (b + 1 < ANALYTICS_BUCKETS) ? g_cgpaBucketFloor[b + 1] : CGPA_BINS;
+        for (int v = g_cgpaBucketFloor[b]; v < end; v++) out->byCgpa[b] += (int)total[v];
+    }
+    for (int i = 0; i < ANALYTICS_SEMESTERS; i++) out->bySemester[i] = (int)sem[i];
+    qsort(depts, (size_t)out->nDepts, sizeof(DeptAnalytics), compareDeptAnalytics);
+    out->depts = depts;
+    free(hist);
+    free(total);
+    return 1;
+}
+
+int studentAnalytics(AnalyticsReport *out) {
+    StatScope sc = statsBegin(STAT_ANALYTICS);
+    unsigned tables = TBL(TBL_STUDENTS);
+    int r;
+    if (g_remote) {
+        r = remoteStudentAnalytics(out);
+    } else if (lockTables(tables, 0) != 1) {
+        memset(out, 0, sizeof(*out));
+        r = -1;
+    } else {
+        r = studentAnalyticsImpl(out);
+        unlockTables(tables);
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Merit lists (CGPA ranking) ---------- */
+/* Read in rank order off the CGPA ranking index: one O(log N) seek to the first row at
+   or below the upper CGPA bound, then one link per row, so a top-K list costs
+   O(log N + K) and nothing is sorted. */
+static int rankQueryImpl(const char *department, int minCgpa, int maxCgpa, int limit, Student **out) {
+    *out = NULL;
+    if (ensureStudentTable() != 1 || ensureRankIndex() != 1) return -1;
+    int dept = DEPT_NONE;
+    if (department && department[0]) {
+        dept = departmentLookup(department);
+        if (dept == DEPT_NONE) return 0; // no student ever had that department
+    }
+    int n = 0, cap = (limit > 0 && limit < 1024) ? limit : 1024;
+    Student *list = malloc((size_t)cap * sizeof(Student));
+    if (!list) return -1;
+    for (int row = rankSeek(dept, maxCgpa); row >= 0 && g_cols.cgpa[row] >= minCgpa; row = rankNextRow(dept, row)) {
+        if (limit > 0 && n == limit) break;
+        if (n == cap) {
+            Student *grown = realloc(list, (size_t)cap * 2 * sizeof(Student));
+            if (!grown) {
+                free(list);
+                return -1;
+            }
+            list = grown;
+            cap *= 2;
+        }
+        studentAt(row, &list[n++]);
+    }
+    *out = list;
+    return n;
+}
+
+static int rankQuery(StatOp op, const char *department, int minCgpa, int maxCgpa, int limit, Student **out) {
+    StatScope sc = statsBegin(op);
+    unsigned tables = TBL(TBL_STUDENTS);
+    int r;
+    if (g_remote) {
+        r = remoteRankQuery(department, minCgpa, maxCgpa, limit, op == STAT_TOP, out);
+    } else if (lockTables(tables, 0) != 1) {
+        *out = NULL;
+        r = -1;
+    } else {
+        r = rankQueryImpl(department, cgpaHundredths(minCgpa), cgpaHundredths(maxCgpa), limit, out);
+        unlockTables(tables);
+    }
+    statsEnd(sc);
+    return r;
+}
+
+int topStudentsByCgpa(const char *department, int k, Student **out) {
+    if (k <= 0) {
+        *out = NULL;
+        return 0;
+    }
+    return rankQuery(STAT_TOP, department, 0, COL_CGPA_MAX, k, out);
+}
+
+int studentsInCgpaRange(const char *department, int minCgpa, int maxCgpa, int limit, Student **out) {
+    return rankQuery(STAT_RANGE, department, minCgpa, maxCgpa, limit, out);
+}
+
+/* ---------- Name search ---------- */
+/* Candidates come from the name index (the rarest trigram of the query, or for a short
+   query the lists of "it starts the name" and "it starts a word"), and each one is
+   scored against the row's name: whole name, start of the name, start of a later
+   word, anywhere. Matches are ordered by that score, then in listing order. */
+
+static int compareMatches(const void *a, const void *b) {
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+    return (x > y) - (x < y);
+}
+
+static int searchStudentsImpl(const char *query, int offset, int limit, Student **out, int *total) {
+    *out = NULL;
+    *total = 0;
+    if (ensureStudentTable() != 1 || ensureNameIndex() != 1) return -1;
+    unsigned char q[MAX_NAME + 1];
+    int qlen = nameFold(query, q) - 1; // the folded query is q + 1
+    const TrigramList *lists[2] = { NULL, NULL };
+    int wordStart = (qlen < 3);
+    if (qlen < NAME_MIN_QUERY) {
+        // nothing to look up
+    } else if (wordStart) {
+        lists[0] = trigramList(1u << 24 | NAME_START << 16 | q[1] << 8 | q[2], 0);
+        lists[1] = trigramList(1u << 24 | ' ' << 16 | q[1] << 8 | q[2], 0);
+    } else {
+        unsigned int keys[MAX_NAME];
+        int k = textTrigrams(q + 1, qlen, keys);
+        for (int i = 0; i < k; i++) {
+            const TrigramList *list = trigramList(keys[i], 0);
+            if (!list) { // some trigram occurs in no name
+                lists[0] = NULL;
+                break;
+            }
+            if (!lists[0] || list->count < lists[0]->count) lists[0] = list;
+        }
+    }
+    size_t cap = 256, n = 0;
+    unsigned long long *matches = malloc(cap * sizeof(unsigned long long)); // score << 32 | row
+    if (!matches) return -1;
+    for (int l = 0; l < 2; l++) {
+        for (int i = 0; lists[l] && i < lists[l]->count; i++) {
+            int row = lists[l]->rows[i];
+            if (row >= g_students.count || !g_students.live[row]) continue; // left behind by a delete
+            unsigned char name[MAX_NAME + 1];
+            int len = nameFold(arenaName(g_nameArena, g_students.rows[row].nameOff), name) - 1;
+            int score = nameMatchScore(name + 1, len, q + 1, qlen, wordStart);
+            if (score < 0) continue;
+            if (n == cap) {
+                unsigned long long *grown = realloc(matches, cap * 2 * sizeof(unsigned long long));
+                if (!grown) {
+                    free(matches);
+                    return -1;
+                }
+                matches = grown;
+                cap *= 2;
+            }
+            matches[n++] = (unsigned long long)score << 32 | (unsigned int)row;
+        }
+    }
+    qsort(matches, n, sizeof(unsigned long long), compareMatches);
+    size_t unique = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (unique == 0 || (unsigned int)matches[unique - 1] != (unsigned int)matches[i]) matches[unique++] = matches[i];
+    }
+    *total = (int)unique;
+    int first = offset < 0 ? 0 : offset;
+    int count = (first < (int)unique) ? (int)unique - first : 0;
+    if (limit >= 0 && count > limit) count = limit;
+    Student *page = malloc((size_t)(count ? count : 1) * sizeof(Student));
+    if (!page) {
+        free(matches);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) studentAt((int)(unsigned int)matches[first + i], &page[i]);
+    free(matches);
+    *out = page;
+    return count;
+}
+
+int searchStudentsByName(const char *query, int offset, int limit, Student **out, int *total) {
+    StatScope sc = statsBegin(STAT_SEARCH);
+    unsigned tables = TBL(TBL_STUDENTS);
+    int r;
+    if (g_remote) {
+        r = remoteSearchStudentsByName(query, offset, limit, out, total);
+    } else if (lockTables(tables, 0) != 1) {
+        *out = NULL;
+        *total = 0;
+        r = -1;
+    } else {
+        r = searchStudentsImpl(query, offset, limit, out, total);
+        unlockTables(tables);
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- CGPA from marksheets ---------- */
+// cumulative CGPA of a student's marksheets in hundredths; -1 if they list no subject
+static int marksheetCgpa(int studentId) {
+    const OffsetList *l = marksheetListFor(studentId, 0);
+    return (l && l->subjects > 0) ? averageHundredths(l->sum, l->subjects) : -1;
+}
+
+/* Store the cumulative CGPA in the student's record. A student without scored
+   marksheets keeps the CGPA typed in by hand. Needs the students and marksheets
+   locked for writing. Returns 1 if the record is current, 0 if there is nothing to
+   store, -1 on error. */
+static int studentCgpaRefresh(int studentId) {
+    if (ensureMarksheetIndex() != 1 || ensureStudentTable() != 1) return -1;
+    int cgpa = marksheetCgpa(studentId), row = studentRowOf(studentId);
+    if (cgpa < 0 || row < 0) return 0;
+    if (g_students.rows[row].cgpa == cgpa) return 1;
+    Student s;
+    studentAt(row, &s);
+    s.cgpa = cgpa;
+    return updateStudentRecordImpl(studentId, &s);
+}
+
+/* ---------- Verify CGPA against a full recount ---------- */
+/* The file is rescanned from scratch (in parallel, by the same scanner that builds the
+   index) and each line's totals are checked against the entry the index holds for it,
+   in file order. Any difference clears the index, so the stored CGPAs are then checked
+   against a fresh count. */
+static int verifyCgpaImpl(int fix, CgpaReport *rep, CgpaMismatch **out) {
+    memset(rep, 0, sizeof(*rep));
+    *out = NULL;
+    if (ensureStudentTable() != 1 || ensureMarksheetIndex() != 1 || appendFlushPath(MARKSHEET_FILE) != 1) return -1;
+    FileScan scan;
+    if (scanFile(MARKSHEET_FILE, scanMarksheetLine, sizeof(MarksheetLineRef), &scan) < 0) return -1;
+    long long *sums = calloc((size_t)(g_marks.cap ? g_marks.cap : 1), sizeof(long long));
+    int *subjects = calloc((size_t)(g_marks.cap ? g_marks.cap : 1), sizeof(int));
+    if (!sums || !subjects) {
+        free(sums);
+        free(subjects);
+        scanFree(&scan);
+        return -1;
+    }
+    for (int i = 0; i < g_marks.cap; i++) g_marks.lists[i].seen = 0;
+    int stray = 0; // lines of students the index does not know
+    for (int c = 0; c < scan.nChunks; c++) {
+        for (int i = 0; i < scan.chunks[c].count; i++) {
+            const MarksheetLineRef *ref = SCAN_RECORD(&scan.chunks[c], i);
+            OffsetList *l = marksheetListFor(ref->studentId, 0);
+            if (!l) {
+                stray++;
+                continue;
+            }
+            int k = l->seen;
+            if (k >= l->count || l->offsets[k] != ref->offset || l->sheets[k].sum != ref->totals.sum ||
+                l->sheets[k].subjects != ref->totals.subjects) {
+                l->seen = l->count + 1; // seen != count marks the student as wrong
+                continue;
+            }
+            l->seen++;
+            sums[l - g_marks.lists] += ref->totals.sum;
+            subjects[l - g_marks.lists] += ref->totals.subjects;
+        }
+    }
+    int wrong = stray;
+    for (int i = 0; i < g_marks.cap; i++) {
+        const OffsetList *l = &g_marks.lists[i];
+        if (g_marks.keys[i] && (l->seen != l->count || l->sum != sums[i] || l->subjects != subjects[i])) wrong++;
+    }
+    free(sums);
+    free(subjects);
+    scanFree(&scan);
+    rep->totalsMismatched = wrong;
+    if (wrong) {
+        marksheetIndexClear();
+        if (ensureMarksheetIndex() != 1) return -1;
+    }
+
+    int n = 0, cap = 0, rc = 0;
+    for (int i = 0; i < g_marks.cap; i++) {
+        const OffsetList *l = &g_marks.lists[i];
+        if (!g_marks.keys[i] || l->subjects == 0) continue;
+        rep->students++;
+        rep->marksheets += l->count;
+        int row = studentRowOf(g_marks.keys[i]);
+        int cgpa = averageHundredths(l->sum, l->subjects);
+        if (row < 0 || g_students.rows[row].cgpa == cgpa) continue;
+        if (n == cap) {
+            cap = cap ? cap * 2 : 64;
+            CgpaMismatch *grown = realloc(*out, (size_t)cap * sizeof(CgpaMismatch));
+            if (!grown) {
+                rc = -1;
+                break;
+            }
+            *out = grown;
+        }
+        (*out)[n].id = g_marks.keys[i];
+        (*out)[n].stored = g_students.rows[row].cgpa;
+        (*out)[n].computed = cgpa;
+        n++;
+        if (fix) {
+            Student s;
+            studentAt(row, &s);
+            s.cgpa = cgpa;
+            if (updateStudentRecordImpl(s.id, &s) == 1) rep->fixed++;
+            else rc = -1;
+        }
+    }
+    rep->cgpaMismatched = n;
+    if (rc < 0) {
+        free(*out);
+        *out = NULL;
+        return -1;
+    }
+    return n;
+}
+
+int verifyCgpa(int fix, CgpaReport *report, CgpaMismatch **out) {
+    StatScope sc = statsBegin(STAT_VERIFY_CGPA);
+    unsigned tables = TBL(TBL_STUDENTS) | TBL(TBL_MARKSHEETS);
+    int r;
+    if (g_remote) {
+        r = remoteVerifyCgpa(fix, report, out);
+    } else if (lockTables(tables, fix ? TBL(TBL_STUDENTS) : 0) != 1) {
+        memset(report, 0, sizeof(*report));
+        *out = NULL;
+        r = -1;
+    } else {
+        r = verifyCgpaImpl(fix, report, out);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Append a marksheet line (no prompts) ---------- */
+/* subjects is "subject,score,grade,subject,score,grade,..." (may be empty).
+   Returns 1 on success, 0 if student not found, -1 on file error */
+static int addMarksheetEntryImpl(int studentId, const char *semesterLabel, const char *subjects) {
+    if (findStudentById(studentId, NULL) != 1) return 0;
+    TextBuf entry = {0};
+    // line: id,semesterLabel[,subject,score,grade...]
+    char label[CSV_FIELD_SIZE(MAX_LINE)];
+    if (textBufPrintf(&entry, "%d,%s%s%s\n", studentId, csvField(semesterLabel, label, sizeof(label)),
+                      (subjects && subjects[0]) ? "," : "", subjects ? subjects : "") != 0) {
+        textBufFree(&entry);
+        return -1;
+    }
+
+    Record rec;
+    recordParse(entry.data, entry.data + entry.len - 1, &rec, REC_MAX_FIELDS);
+    MarkTotals totals = marksheetTotals(&rec);
+
+    int indexed = (ensureMarksheetIndex() == 1);
+    long off = appendQueue(APPEND_MARKSHEETS, entry.data);
+    int ok = (off >= 0);
+    if (ok && indexed && off == g_marks.fileSize) {
+        marksheetIndexAdd(studentId, off, totals);
+        g_marks.fileSize = off + (long)entry.len;
+    }
+    textBufFree(&entry);
+    if (!ok) return -1;
+    return studentCgpaRefresh(studentId) < 0 ? -1 : 1;
+}
+
+int addMarksheetEntry(int studentId, const char *semesterLabel, const char *subjects) {
+    StatScope sc = statsBegin(STAT_ADD_MARKSHEET);
+    unsigned tables = TBL(TBL_STUDENTS) | TBL(TBL_MARKSHEETS);
+    int r;
+    if (g_remote) {
+        r = remoteAddMarksheetEntry(studentId, semesterLabel, subjects);
+    } else if (lockTables(tables, tables) != 1) {
+        r = -1;
+    } else {
+        r = addMarksheetEntryImpl(studentId, semesterLabel, subjects);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Add marksheet for a student ---------- */
+/* Format per line: id,semesterLabel,subject,score,grade,subject,score,grade,... */
+/* Returns 1 on success, 0 if student not found, -1 on file error */
+int addMarksheet(int studentId) {
+    // verify student exists
+    Student s;
+    int found = findStudentById(studentId, &s);
+    if (found != 1) return 0;
+
+    char semesterLabel[80];
+    getStringInput("Enter Semester label (e.g. Spring2025): ", semesterLabel, sizeof(semesterLabel));
+
+    // collect the subjects first so the line is written with a single append
+    TextBuf subjects = {0};
+    while (1) {
+        printf("\n1. Add Subject\n2. Done\n");
+        int ch = getIntInput("Enter choice: ");
+        if (ch == 2) break;
+        if (ch != 1) {
+            printf("❌ Invalid choice. Try again.\n");
+            continue;
+        }
+        char subject[MAX_SUBJECT];
+        char grade[8];
+        char score[NUM_BUF];
+        getStringInput("Enter Subject Name: ", subject, sizeof(subject));
+        formatHundredths(getHundredthsInput("Enter Subject CGPA (numeric): "), score);
+        getStringInput("Enter Grade (A/B/C/D/F): ", grade, sizeof(grade));
+
+        // append triplet
+        char sub[CSV_FIELD_SIZE(MAX_SUBJECT)], gr[CSV_FIELD_SIZE(8)];
+        textBufPrintf(&subjects, "%s%s,%s,%s", subjects.len ? "," : "", csvField(subject, sub, sizeof(sub)),
+                      score, csvField(grade, gr, sizeof(gr)));
+    }
+    int r = addMarksheetEntry(studentId, semesterLabel, subjects.data ? subjects.data : "");
+    textBufFree(&subjects);
+    return r;
+}
+
+/* ---------- Collect a student's marksheet lines ---------- */
+/* Appends each raw line (with '\n') to out. Returns number of lines, -1 on file error */
+static int collectMarksheetsImpl(int studentId, TextBuf *out) {
+    if (ensureMarksheetIndex() != 1 || appendFlushPath(MARKSHEET_FILE) != 1) return -1;
+    const MappedFile *file = marksheetMapping();
+    if (!file) return -1;
+    const char *end = file->data + file->size;
+    Record rec;
+    int n = 0;
+    // only this student's lines are read, via the offsets in the index
+    OffsetList *offs = marksheetListFor(studentId, 0);
+    for (int k = 0; offs && k < offs->count; k++) {
+        if (offs->offsets[k] < 0 || (size_t)offs->offsets[k] >= file->size) continue;
+        const char *line = file->data + offs->offsets[k];
+        const char *nl = findAny(line, end, '\n', '\n', '\n');
+        statsRead((size_t)(nl - line));
+        statsLines(1);
+        if (recordParse(line, nl, &rec, 1) < 1 || fieldInt(&rec.f[0]) != studentId) continue;
+        textBufPrintf(out, "%.*s\n", rec.lineLen, rec.line);
+        n++;
+    }
+    return n;
+}
+
+int collectMarksheets(int studentId, TextBuf *out) {
+    StatScope sc = statsBegin(STAT_COLLECT_MARKSHEETS);
+    unsigned tables = TBL(TBL_MARKSHEETS);
+    int r;
+    if (g_remote) {
+        r = remoteCollectMarksheets(studentId, out);
+    } else if (lockTables(tables, 0) != 1) {
+        r = -1;
+    } else {
+        r = collectMarksheetsImpl(studentId, out);
+        unlockTables(tables);
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Marksheet report layout ---------- */
+// Append one marksheet line [line, end) (id,semester, then subject,score,grade
+// triplets) to out in the official report layout. s is the student's record, NULL if
+// the id is not in the student table; totals are the line's totals from the marksheet
+// index, NULL to add them up here. Shared by the viewer and the bulk export.
+static void renderMarksheet(TextBuf *out, const char *line, const char *end, const Student *s,
+                            const MarkTotals *totals) {
+    Record rec;
+    recordParse(line, end, &rec, REC_MAX_FIELDS);
+    int id = fieldInt(&rec.f[0]);
+    char semester[MAX_LINE] = "Unknown";
+    if (rec.n > 1 && rec.f[1].len > 0) fieldCopy(&rec.f[1], semester, sizeof(semester));
+
+    // print nice header (A4-like)
+    textBufPrintf(out, "\n****************************************************\n");
+    textBufPrintf(out, "            OFFICIAL MARKSHEET REPORT\n");
+    textBufPrintf(out, "      DAFFODIL INTERNATIONAL UNIVERSITY\n");
+    textBufPrintf(out, "****************************************************\n");
+    if (s) {
+        textBufPrintf(out, "Student ID   : %d\n", s->id);
+        textBufPrintf(out, "Student Name : %s\n", s->name);
+        textBufPrintf(out, "Department   : %s\n", s->department);
+    } else {
+        textBufPrintf(out, "Student ID   : %d\n", id);
+        textBufPrintf(out, "Student Name : (Not found in students.txt)\n");
+    }
+    textBufPrintf(out, "Semester     : %s\n", semester);
+    textBufPrintf(out, "----------------------------------------------------\n");
+    textBufPrintf(out, "%-4s  %-30s  %-6s  %-6s\n", "No.", "Subject", "CGPA", "Grade");
+    textBufPrintf(out, "----------------------------------------------------\n");
+
+    int count = 0;
+    for (int f = 2; f + 2 < rec.n; f += 3) {
+        char sub[MAX_SUBJECT], grade[8];
+        fieldCopy(&rec.f[f], sub, sizeof(sub));
+        char score[NUM_BUF];
+        formatHundredths(fieldHundredths(&rec.f[f + 1]), score);
+        fieldCopy(&rec.f[f + 2], grade, sizeof(grade));
+        textBufPrintf(out, "%-4d  %-30s  %-6s  %-6s\n", ++count, sub, score, grade);
+    }
+    MarkTotals t = totals ? *totals : marksheetTotals(&rec);
+    char avg[NUM_BUF];
+    formatHundredths(averageHundredths(t.sum, t.subjects), avg);
+    textBufPrintf(out, "----------------------------------------------------\n");
+    textBufPrintf(out, " Semester Average CGPA: %s\n", avg);
+    textBufPrintf(out, "****************************************************\n");
+}
+
+// Render the student's marksheets from the mapped file, with the totals kept in the
+// index. Reads only; safe on the export threads. Returns the number rendered.
+static int renderMarksheetLines(TextBuf *out, const MappedFile *file, int studentId, const OffsetList *l,
+                                const Student *s) {
+    const char *end = file->data + file->size;
+    int n = 0;
+    for (int k = 0; l && k < l->count; k++) {
+        long off = l->offsets[k];
+        if (off < 0 || (size_t)off >= file->size) continue;
+        const char *line = file->data + off;
+        const char *nl = findAny(line, end, '\n', '\n', '\n');
+        Record rec;
+        if (recordParse(line, nl, &rec, 1) < 1 || fieldInt(&rec.f[0]) != studentId) continue;
+        renderMarksheet(out, line, nl, s, &l->sheets[k]);
+        n++;
+    }
+    return n;
+}
+
+/* Every marksheet of one student in the report layout. Through the daemon the raw
+   lines are fetched and added up here. Returns the number of marksheets, -1 on error. */
+static int renderStudentReport(int studentId, const Student *s, TextBuf *out) {
+    if (g_remote) {
+        TextBuf sheets = {0};
+        int n = collectMarksheets(studentId, &sheets);
+        const char *line = sheets.data;
+        for (int k = 0; k < n; k++) {
+            const char *nl = strchr(line, '\n');
+            renderMarksheet(out, line, nl, s, NULL);
+            line = nl + 1;
+        }
+        textBufFree(&sheets);
+        return n;
+    }
+    unsigned tables = TBL(TBL_MARKSHEETS);
+    if (lockTables(tables, 0) != 1) return -1;
+    int n = -1;
+    const MappedFile *file = NULL;
+    if (ensureMarksheetIndex() == 1 && appendFlushPath(MARKSHEET_FILE) == 1 && (file = marksheetMapping()) != NULL) {
+        n = renderMarksheetLines(out, file, studentId, marksheetListFor(studentId, 0), s);
+    }
+    unlockTables(tables);
+    return n;
+}
+
+/* ---------- View marksheet(s) for a student ---------- */
+/* If studentId <=0, interactive prompt is used; otherwise prints all marksheets for that id */
+/* Returns number of marksheets found (>0) or 0 if none, -1 on file error */
+static int viewMarksheetForImpl(int studentId) {
+    if (studentId <= 0) {
+        studentId = getIntInput("Enter Student ID to view marksheet: ");
+    }
+
+    // To display student basic info:
+    Student s;
+    int stFound = findStudentById(studentId, &s);
+
+    TextBuf report = {0};
+    int nSheets = renderStudentReport(studentId, stFound == 1 ? &s : NULL, &report);
+    if (nSheets < 0) {
+        textBufFree(&report);
+        return -1;
+    }
+    if (report.data) fputs(report.data, stdout);
+    textBufFree(&report);
+
+    if (nSheets == 0) {
+        printf("❌ No marksheet found for Student ID %d.\n", studentId);
+        return 0;
+    }
+    return 1;
+}
+
+int viewMarksheetFor(int studentId) {
+    StatScope sc = statsBegin(STAT_VIEW_MARKSHEET);
+    int r = viewMarksheetForImpl(studentId);
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Bulk marksheet export ---------- */
+/* Writes the official report of every student with marksheets to
+   dir/marksheet_<id>.txt. The marksheet index already groups MARKSHEET_FILE by
+   student; each group is joined with the student table once, up front, and ordered by
+   where it starts in the file. Worker threads then render and write the reports. Each
+   worker starts with an equal share of the students; once its share runs dry it steals
+   half of the largest share left, so students with many marksheets do not leave the
+   other threads idle at the end. Workers only read the index, the mapping and the
+   table, which stay put while the export holds the table locks. */
+
+#define EXPORT_MAX_THREADS 32
+
+typedef struct {
+    int studentId;
+    const OffsetList *offs;
+    const StudentRec *student;  // NULL if the id is not in the student table
+} ExportJob;
+
+typedef struct {
+    atomic_ullong range;        // jobs [lo, hi) still queued, packed as lo << 32 | hi
+    char pad[64 - sizeof(atomic_ullong)];
+} ExportQueue;
+
+typedef struct {
+    const ExportJob *jobs;
+    ExportQueue queues[EXPORT_MAX_THREADS];
+    int nQueues;
+    const char *dir;
+    const MappedFile *file;
+    atomic_int reports, marksheets, failed;
+} ExportRun;
+
+typedef struct {
+    ExportRun *run;
+    int self;
+} ExportWorker;
+
+// next job from the front of queue q, or -1 if it is empty
+static int exportTake(ExportQueue *q) {
+    unsigned long long r = atomic_load(&q->range);
+    while ((r >> 32) < (r & 0xFFFFFFFFu)) {
+        if (atomic_compare_exchange_weak(&q->range, &r, r + (1ULL << 32))) return (int)(r >> 32);
+    }
+    return -1;
+}
+
+// move the back half of the fullest other queue into queue self and return its first job
+static int exportSteal(ExportRun *run, int self) {
+    while (1) {
+        int victim = -1;
+        unsigned long long best = 0, r = 0;
+        for (int i = 0; i < run->nQueues; i++) {
+            unsigned long long q = atomic_load(&run->queues[i].range);
+            unsigned long long left = (q & 0xFFFFFFFFu) - (q >> 32);
+            if (i != self && (q >> 32) < (q & 0xFFFFFFFFu) && left > best) {
+                best = left;
+                victim = i;
+                r = q;
+            }
+        }
+        if (victim < 0) return -1;
+        unsigned long long lo = r >> 32, hi = r & 0xFFFFFFFFu, mid = lo + (hi - lo) / 2;
+        if (!atomic_compare_exchange_strong(&run->queues[victim].range, &r, lo << 32 | mid)) continue;
+        atomic_store(&run->queues[self].range, (mid + 1) << 32 | hi);
+        return (int)mid;
+    }
+}
+
+static void *exportWorkerRun(void *arg) {
+    ExportWorker *w = arg;
+    ExportRun *run = w->run;
+    TextBuf report = {0};
+    char path[4096];
+    int job;
+    while ((job = exportTake(&run->queues[w->self])) >= 0 || (job = exportSteal(run, w->self)) >= 0) {
+        const ExportJob *j = &run->jobs[job];
+        Student s;
+        if (j->student) studentView(j->student, g_nameArena, &s);
+        report.len = 0;
+        int sheets = renderMarksheetLines(&report, run->file, j->studentId, j->offs, j->student ? &s : NULL);
+        if (sheets == 0) continue;
+        snprintf(path, sizeof(path), "%s/marksheet_%d.txt", run->dir, j->studentId);
+        FILE *fp = fopen(path, "w");
+        int ok = fp && fwrite(report.data, 1, report.len, fp) == report.len;
+        if (fp && fclose(fp) != 0) ok = 0;
+        if (ok) {
+            atomic_fetch_add(&run->reports, 1);
+            atomic_fetch_add(&run->marksheets, sheets);
+        } else {
+            atomic_fetch_add(&run->failed, 1);
+        }
+    }
+    textBufFree(&report);
+    return NULL;
+}
+
+static int compareExportJobs(const void *a, const void *b) {
+    long x = ((const ExportJob *)a)->offs->offsets[0], y = ((const ExportJob *)b)->offs->offsets[0];
+    return (x > y) - (x < y);
+}
+
+static int exportThreadCount(int threads, int jobs) {
+#ifdef _WIN32
+    (void)threads;
+    (void)jobs;
+    return 1;
+#else
+    int n = threads > 0 ? threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > EXPORT_MAX_THREADS) n = EXPORT_MAX_THREADS;
+    if (n > jobs) n = jobs;
+    return n < 1 ? 1 : n;
+#endif
+}
+
+static int exportMarksheetReportsImpl(const char *dir, int threads, ExportReport *report) {
+    memset(report, 0, sizeof(*report));
+    double t0 = nowSeconds();
+    if (makeDir(dir) != 0) return -1;
+    if (ensureStudentTable() != 1 || ensureMarksheetIndex() != 1 || appendFlushPath(MARKSHEET_FILE) != 1) return -1;
+    const MappedFile *file = marksheetMapping();
+    if (!file) return -1;
+
+    // one pass over the index groups, one table lookup per student
+    ExportJob *jobs = malloc((size_t)(g_marks.used ? g_marks.used : 1) * sizeof(ExportJob));
+    ExportRun *run = calloc(1, sizeof(ExportRun));
+    if (!jobs || !run) {
+        free(jobs);
+        free(run);
+        return -1;
+    }
+    int nJobs = 0;
+    for (int i = 0; i < g_marks.cap; i++) {
+        if (!g_marks.keys[i] || g_marks.lists[i].count == 0) continue;
+        int row = studentRowOf(g_marks.keys[i]);
+        jobs[nJobs].studentId = g_marks.keys[i];
+        jobs[nJobs].offs = &g_marks.lists[i];
+        jobs[nJobs].student = (row >= 0) ? &g_students.rows[row] : NULL;
+        nJobs++;
+    }
+    qsort(jobs, (size_t)nJobs, sizeof(ExportJob), compareExportJobs);
+
+    int n = exportThreadCount(threads, nJobs);
+    run->jobs = jobs;
+    run->nQueues = n;
+    run->dir = dir;
+    run->file = file;
+    for (int k = 0; k < n; k++) {
+        unsigned long long lo = (unsigned long long)nJobs * (unsigned long long)k / (unsigned long long)n;
+        unsigned long long hi = (unsigned long long)nJobs * (unsigned long long)(k + 1) / (unsigned long long)n;
+        atomic_store(&run->queues[k].range, lo << 32 | hi);
+    }
+    ExportWorker workers[EXPORT_MAX_THREADS];
+    for (int k = 0; k < n; k++) {
+        workers[k].run = run;
+        workers[k].self = k;
+    }
+#ifndef _WIN32
+    pthread_t tids[EXPORT_MAX_THREADS];
+    int started[EXPORT_MAX_THREADS] = {0};
+    for (int k = 1; k < n; k++) started[k] = (pthread_create(&tids[k], NULL, exportWorkerRun, &workers[k]) == 0);
+    exportWorkerRun(&workers[0]); // a thread that failed to start has its share stolen
+    for (int k = 1; k < n; k++) {
+        if (started[k]) pthread_join(tids[k], NULL);
+    }
+#else
+    exportWorkerRun(&workers[0]);
+#endif
+
+    report->reports = atomic_load(&run->reports);
+    report->marksheets = atomic_load(&run->marksheets);
+    report->failed = atomic_load(&run->failed);
+    report->threads = n;
+    report->seconds = nowSeconds() - t0;
+    free(jobs);
+    free(run);
+    return report->reports;
+}
+
+int exportMarksheetReports(const char *dir, int threads, ExportReport *report) {
+    StatScope sc = statsBegin(STAT_EXPORT);
+    unsigned tables = TBL(TBL_STUDENTS) | TBL(TBL_MARKSHEETS);
+    int r;
+    if (g_remote) {
+        r = remoteExportMarksheetReports(dir, threads, report);
+    } else if (lockTables(tables, 0) != 1) {
+        memset(report, 0, sizeof(*report));
+        r = -1;
+    } else {
+        r = exportMarksheetReportsImpl(dir, threads, report);
+        unlockTables(tables);
+    }
+    statsEnd(sc);
+    return r;
+}
+
+/* ---------- Bulk import (CSV) ---------- */
+/* Input rows: name,department,semester,cgpa[,email,username,password]
+   An optional header row starting with "name" is skipped. Rows are validated with
+   isValidName / isValidEmail, usernames are checked against the username index and
+   against earlier rows of the same file, ids come from one reserveIds() block, and
+   accepted rows are written in chunks through addStudentRecordsBatch and
+   createLoginsBatch (one buffered append per chunk). Every rejected row is listed
+   in IMPORT_REJECTS_FILE.
+   Returns number of students imported, or -1 if the input cannot be read. */
+
+#define IMPORT_CHUNK        8192
+#define UNAME_IN_IMPORT     4   // username index flag: claimed by a row of the running import
+
+static void importReject(FILE *rej, ImportReport *report, int lineNo, const char *reason, const char *row) {
+    report->rejected++;
+    if (rej) fprintf(rej, "%d,%s,%s\n", lineNo, reason, row);
+    if (!g_quiet && report->rejected <= 20) printf("❌ line %d: %s\n", lineNo, reason);
+}
+
+// write one chunk; returns 0 on success, -1 on error
+static int importFlush(Student *students, LoginEntry *logins, int n, int nLogins, ImportReport *report) {
+    if (n == 0) return 0;
+    int *ok = malloc(sizeof(int) * (n > nLogins ? n : nLogins));
+    if (!ok) return -1;
+    // through --connect a failed batch can be partly written: count what went in
+    int added = addStudentRecordsBatch(students, n, ok);
+    if (added < 0) {
+        for (int k = 0; k < n; k++) report->imported += ok[k];
+        free(ok);
+        return -1;
+    }
+    report->imported += added;
+    if (nLogins > 0) {
+        for (int k = 0; k < nLogins; k++) usernameIndexRemove(logins[k].username, UNAME_IN_IMPORT);
+        int created = createLoginsBatch(logins, nLogins, ok);
+        if (created < 0) {
+            for (int k = 0; k < nLogins; k++) report->logins += ok[k];
+            free(ok);
+            return -1;
+        }
+        report->logins += created;
+    }
+    free(ok);
+    return 0;
+}
+
+static int importStudentsCsvImpl(const char *path, ImportReport *report) {
+    memset(report, 0, sizeof(*report));
+    double t0 = nowSeconds();
+    FILE *in = fopen(path, "r");
+    if (!in) return -1;
+    static char inBuf[1 << 20];
+    setvbuf(in, inBuf, _IOFBF, sizeof(inBuf));
+    if (ensureStudentTable() != 1 || loadUsernameIndex() != 1) {
+        fclose(in);
+        return -1;
+    }
+
+    // count rows first so the whole import takes one id block
+    char line[MAX_LINE];
+    int total = 0;
+    while (readLine(line, sizeof(line), in)) total++;
+    if (total == 0) {
+        fclose(in);
+        report->seconds = nowSeconds() - t0;
+        return 0;
+    }
+    rewind(in);
+    int firstId = reserveIds(SEQ_STUDENTS, total);
+    if (firstId < 0) {
+        fclose(in);
+        return -1;
+    }
+    int nextId = firstId;
+
+    FILE *rej = fopen(IMPORT_REJECTS_FILE, "w");
+    Student *students = malloc(IMPORT_CHUNK * sizeof(Student));
+    LoginEntry *logins = malloc(IMPORT_CHUNK * sizeof(LoginEntry));
+    int n = 0, nLogins = 0, lineNo = 0, failed = 0;
+    if (!students || !logins) failed = 1;
+
+    while (!failed && readLine(line, sizeof(line), in)) {
+        lineNo++;
+        trim(line);
+        if (line[0] == '\0') continue;
+        if (lineNo == 1 && strncmp(line, "name", 4) == 0) continue; // header
+        report->rows++;
+
+        char fields[MAX_LINE];
+        strcpy(fields, line);
+        char *parts[8];
+        int p = splitFields(fields, parts, 8);
+        for (int i = 0; i < p; i++) trim(parts[i]);
+        if (p < 4) { importReject(rej, report, lineNo, "too few fields", line); continue; }
+
+        Student *s = &students[n];
+        memset(s, 0, sizeof(*s));
+        char *end;
+        if (parts[0][0] == '\0' || !isValidName(parts[0])) { importReject(rej, report, lineNo, "invalid name", line); continue; }
+        if (parts[1][0] == '\0') { importReject(rej, report, lineNo, "empty department", line); continue; }
+        long sem = strtol(parts[2], &end, 10);
+        if (*end != '\0' || sem < 1) { importReject(rej, report, lineNo, "invalid semester", line); continue; }
+        int cgpa;
+        if (!textHundredths(parts[3], &cgpa) || cgpa < 0 || cgpa > 400) { importReject(rej, report, lineNo, "invalid cgpa", line); continue; }
+        const char *email = (p > 4) ? parts[4] : "";
+        const char *username = (p > 5) ? parts[5] : "";
+        const char *password = (p > 6) ? parts[6] : "";
+        if (email[0] && !isValidEmail(email)) { importReject(rej, report, lineNo, "invalid email", line); continue; }
+        if (username[0]) {
+            if (!password[0]) { importReject(rej, report, lineNo, "username without password", line); continue; }
+            if (strlen(username) >= MAX_USERNAME || strlen(password) >= MAX_PASS) { importReject(rej, report, lineNo, "username or password too long", line); continue; }
+            if (usernameExists(username)) { importReject(rej, report, lineNo, "duplicate username", line); continue; }
+        }
+
+        strncpy(s->name, parts[0], sizeof(s->name)-1);
+        strncpy(s->department, parts[1], sizeof(s->department)-1);
+        s->semester = (int)sem;
+        s->cgpa = cgpa;
+        s->id = nextId++;
+        n++;
+        if (username[0]) {
+            LoginEntry *e = &logins[nLogins++];
+            strcpy(e->username, username);
+            strcpy(e->password, password);
+            strcpy(e->role, "student");
+            e->studentId = s->id;
+            usernameIndexAdd(username, UNAME_IN_IMPORT); // later rows see it as taken
+        }
+        if (n == IMPORT_CHUNK) {
+            if (importFlush(students, logins, n, nLogins, report) != 0) failed = 1;
+            n = nLogins = 0;
+        }
+    }
+    if (!failed && importFlush(students, logins, n, nLogins, report) != 0) failed = 1;
+    if (failed) {
+        for (int k = 0; k < nLogins; k++) usernameIndexRemove(logins[k].username, UNAME_IN_IMPORT);
+    }
+    releaseIdTail(SEQ_STUDENTS, nextId, firstId + total);
+
+    free(students);
+    free(logins);
+    fclose(in);
+    if (rej) fclose(rej);
+    report->seconds = nowSeconds() - t0;
+    return failed ? -1 : report->imported;
+}
+
+int importStudentsCsv(const char *path, ImportReport *report) {
+    StatScope sc = statsBegin(STAT_IMPORT);
+    unsigned tables = TBL_ALL;
+    int r;
+    if (g_remote) {
+        r = remoteImportStudentsCsv(path, report);
+    } else if (lockTables(tables, tables) != 1) {
+        memset(report, 0, sizeof(*report));
+        r = -1;
+    } else {
+        r = importStudentsCsvImpl(path, report);
+        if (unlockTables(tables) != 1) r = -1;
+    }
+    statsEnd(sc);
+    return r;
+}
+
+// =========================
+// sms.c  — Batch mode
+// Headless, line-oriented commands for scripts and throughput runs:
+//   ./sms --batch [file]      (reads stdin when no file is given)
+// Each command is "name args" with comma-separated args, e.g. "add Jane Doe,CSE,3,3.50".
+// The same commands are the --daemon wire protocol (see the Daemon section).
+// Output is tab-separated: "row\t..." for data lines, then "ok\t<cmd>[\tkey=value...]"
+// or "err\t<cmd>\t<reason>" per command. A "# ..." summary line ends the run.
+// =========================
+
+static int batchErr(FILE *out, const char *cmd, const char *reason) {
+    fprintf(out, "err\t%s\t%s\n", cmd, reason);
+    return 0;
+}
+
+static void batchStudentRow(FILE *out, const Student *s) {
+    char cgpa[NUM_BUF];
+    formatHundredths(s->cgpa, cgpa);
+    fprintf(out, "row\t%d\t%s\t%s\t%d\t%s\n", s->id, s->name, s->department, s->semester, cgpa);
+}
+
+static void batchAdmissionRow(FILE *out, const AdmissionInfo *a) {
+    fprintf(out, "row\t%d\t%s\t%s\t%d\t%s\t%s\t%s\t%d\n", a->tempId, a->name, a->department,
+            a->semester, a->email, a->username, a->status, a->studentId);
+}
+
+// parse "name,dept,semester,cgpa" (starting at parts[0]) into s; returns 1 if valid
+static int batchParseStudent(char **parts, int n, Student *s) {
+    if (n < 4) return 0;
+    memset(s, 0, sizeof(*s));
+    char *end;
+    if (parts[0][0] == '\0' || !isValidName(parts[0]) || parts[1][0] == '\0') return 0;
+    strncpy(s->name, parts[0], sizeof(s->name)-1);
+    strncpy(s->department, parts[1], sizeof(s->department)-1);
+    s->semester = (int)strtol(parts[2], &end, 10);
+    if (*end != '\0') return 0;
+    return textHundredths(parts[3], &s->cgpa);
+}
+
+/* Execute one command line, writing results to out. Returns 1 if it succeeded,
+   0 if it failed (an "err" line was written). Blank lines and comments return -1. */
+int runBatchCommand(char *line, FILE *out) {
+    trim(line);
+    if (line[0] == '\0' || line[0] == '#') return -1;
+    char *args = line;
+    while (*args && !isspace((unsigned char)*args)) args++;
+    if (*args) *args++ = '\0';
+    while (isspace((unsigned char)*args)) args++;
+    const char *cmd = line;
+    // id lists ("120,125,130-180") are parsed whole, before args is split on commas
+    int *ids = NULL;
+    int nIds = -1;
+    if (strcmp(cmd, "delete") == 0 || (strcmp(cmd, "approve") == 0 && strcmp(args, "all") != 0)) {
+        nIds = (*args) ? parseIdList(args, &ids) : -1;
+    }
+    char *parts[64];
+    int n = (*args) ? splitFields(args, parts, 64) : 0;
+    for (int i = 0; i < n; i++) trim(parts[i]);
+
+    if (strcmp(cmd, "add") == 0) {
+        Student s;
+        if (!batchParseStudent(parts, n, &s)) return batchErr(out, cmd, "usage: add name,department,semester,cgpa");
+        s.id = nextStudentId();
+        if (s.id < 0) return batchErr(out, cmd, "cannot allocate id");
+        int r = addStudentRecord(&s);
+        if (r != 1) return batchErr(out, cmd, r == 0 ? "duplicate id" : "write failed");
+        fprintf(out, "ok\tadd\tid=%d\n", s.id);
+        return 1;
+    }
+    if (strcmp(cmd, "insert") == 0) {
+        // like add, with an id the caller reserved (nextid students)
+        Student s;
+        if (n < 5 || !batchParseStudent(parts + 1, n - 1, &s)) return batchErr(out, cmd, "usage: insert id,name,department,semester,cgpa");
+        s.id = atoi(parts[0]);
+        int r = addStudentRecord(&s);
+        if (r != 1) return batchErr(out, cmd, r == 0 ? "duplicate id" : "write failed");
+        fprintf(out, "ok\tinsert\tid=%d\n", s.id);
+        return 1;
+    }
+    if (strcmp(cmd, "nextid") == 0) {
+        // nextid students|admissions[,count]
+        int students = (n >= 1 && strcmp(parts[0], "students") == 0);
+        int count = (n >= 2) ? atoi(parts[1]) : 1;
+        if ((!students && (n < 1 || strcmp(parts[0], "admissions") != 0)) || count < 1)
+            return batchErr(out, cmd, "usage: nextid students|admissions[,count]");
+        int first = reserveIds(students ? SEQ_STUDENTS : SEQ_ADMISSIONS, count);
+        if (first < 0) return batchErr(out, cmd, "cannot allocate id");
+        fprintf(out, "ok\tnextid\tfirst=%d\tcount=%d\n", first, count);
+        return 1;
+    }
+    if (strcmp(cmd, "get") == 0) {
+        if (n < 1) return batchErr(out, cmd, "usage: get id");
+        Student s;
+        int r = findStudentById(atoi(parts[0]), &s);
+        if (r != 1) return batchErr(out, cmd, r == 0 ? "not found" : "read failed");
+        batchStudentRow(out, &s);
+        fprintf(out, "ok\tget\n");
+        return 1;
+    }
+    if (strcmp(cmd, "update") == 0) {
+        Student s;
+        if (n < 5 || !batchParseStudent(parts + 1, n - 1, &s)) return batchErr(out, cmd, "usage: update id,name,department,semester,cgpa");
+        int r = updateStudentRecord(atoi(parts[0]), &s);
+        if (r != 1) return batchErr(out, cmd, r == 0 ? "not found" : "write failed");
+        fprintf(out, "ok\tupdate\n");
+        return 1;
+    }
+    if (strcmp(cmd, "delete") == 0) {
+        // delete 120  |  delete 120,125,130-180
+        if (nIds <= 0) return batchErr(out, cmd, "usage: delete id[,id|from-to...]");
+        int r = deleteStudentsBatch(ids, nIds);
+        free(ids);
+        if (r < 0) return batchErr(out, cmd, "write failed");
+        if (r == 0) return batchErr(out, cmd, "not found");
+        fprintf(out, "ok\tdelete\tcount=%d\n", r);
+        return 1;
+    }
+    if (strcmp(cmd, "register") == 0) {
+        Student s;
+        memset(&s, 0, sizeof(s));
+        if (n < 6 || !isValidName(parts[0]) || !isValidEmail(parts[3]) || parts[4][0] == '\0' || parts[5][0] == '\0')
+            return batchErr(out, cmd, "usage: register name,department,semester,email,username,password");
+        strncpy(s.name, parts[0], sizeof(s.name)-1);
+        strncpy(s.department, parts[1], sizeof(s.department)-1);
+        s.semester = atoi(parts[2]);
+        int r = submitAdmission(&s, parts[3], parts[4], parts[5]);
+        if (r <= 0) return batchErr(out, cmd, r == 0 ? "username taken" : "write failed");
+        fprintf(out, "ok\tregister\ttempId=%d\n", r);
+        return 1;
+    }
+    if (strcmp(cmd, "approve") == 0) {
+        // approve all  |  approve 1001,1003,1010-1050
+        if (nIds == 0 || (nIds < 0 && strcmp(args, "all") != 0))
+            return batchErr(out, cmd, "usage: approve all | approve id[,id|from-to...]");
+        ApprovalResult *results = NULL;
+        int nResults = 0;
+        int approved = approveAdmissionsBatch(ids, nIds < 0 ? 0 : nIds, &results, &nResults);
+        free(ids);
+        if (approved < 0) {
+            free(results);
+            return batchErr(out, cmd, "write failed");
+        }
+        for (int i = 0; i < nResults; i++) {
+            fprintf(out, "row\t%d\t%s\t%d\n", results[i].tempId, approvalResultText(results[i].result), results[i].studentId);
+        }
+        free(results);
+        fprintf(out, "ok\tapprove\tapproved=%d\trequested=%d\n", approved, nResults);
+        return 1;
+    }
+    if (strcmp(cmd, "marksheet") == 0) {
+        if (n < 1) return batchErr(out, cmd, "usage: marksheet id");
+        TextBuf sheets = {0};
+        int r = collectMarksheets(atoi(parts[0]), &sheets);
+        if (r < 0) return batchErr(out, cmd, "read failed");
+        for (size_t p = 0; p < sheets.len; ) {
+            char *nl = strchr(sheets.data + p, '\n');
+            fprintf(out, "row\t%.*s\n", (int)(nl - (sheets.data + p)), sheets.data + p);
+            p = (size_t)(nl - sheets.data) + 1;
+        }
+        textBufFree(&sheets);
+        fprintf(out, "ok\tmarksheet\tcount=%d\n", r);
+        return 1;
+    }
+    if (strcmp(cmd, "addmarks") == 0) {
+        // addmarks id,semesterLabel,subject,score,grade,...
+        if (n < 2 || (n - 2) % 3 != 0) return batchErr(out, cmd, "usage: addmarks id,semester,subject,score,grade[,...]");
+        TextBuf subjects = {0};
+        char field[CSV_FIELD_SIZE(MAX_LINE)];
+        for (int i = 2; i < n; i++) {
+            textBufPrintf(&subjects, "%s%s", i > 2 ? "," : "", csvField(parts[i], field, sizeof(field)));
+        }
+        int r = addMarksheetEntry(atoi(parts[0]), parts[1], subjects.data ? subjects.data : "");
+        textBufFree(&subjects);
+        if (r != 1) return batchErr(out, cmd, r == 0 ? "student not found" : "write failed");
+        fprintf(out, "ok\taddmarks\n");
+        return 1;
+    }
+    if (strcmp(cmd, "list") == 0 && n > 0) {
+        // list department[,semester[,cursor[,limit[,back]]]]  (department may be empty)
+        ListFilter f = { parts[0], n > 1 ? atoi(parts[1]) : 0, NULL };
+        Student *list = NULL;
+        ListPage page;
+        int count = listStudentsPage(&f, n > 2 ? atoi(parts[2]) : 0, n > 3 ? atoi(parts[3]) : LIST_PAGE_ROWS,
+                                     n > 4 && atoi(parts[4]), &list, &page);
+        if (count < 0) return batchErr(out, cmd, "read failed");
+        for (int i = 0; i < count; i++) batchStudentRow(out, &list[i]);
+        free(list);
+        fprintf(out, "ok\tlist\tcount=%d\tprev=%d\tnext=%d\n", count, page.prev, page.next);
+        return 1;
+    }
+    if (strcmp(cmd, "list") == 0) {
+        if (syncStudentTable() != 1) return batchErr(out, cmd, "read failed");
+        const StudentVersion *v = studentSnapshotPin();
+        int count = 0;
+        for (int r = 0; v && r < v->count; r++) {
+            Student s;
+            if (!snapshotStudent(v, r, &s)) continue;
+            batchStudentRow(out, &s);
+            count++;
+        }
+        studentSnapshotRelease();
+        fprintf(out, "ok\tlist\tcount=%d\n", count);
+        return 1;
+    }
+    if (strcmp(cmd, "analytics") == 0) {
+        AnalyticsReport rep;
+        if (studentAnalytics(&rep) != 1) return batchErr(out, cmd, "read failed");
+        for (int i = 0; i < rep.nDepts; i++) {
+            const DeptAnalytics *d = &rep.depts[i];
+            char avg[NUM_BUF], median[NUM_BUF];
+            formatHundredths(d->avgCgpa, avg);
+            formatHundredths(d->medianCgpa, median);
+            fprintf(out, "row\tdept\t%s\t%d\t%s\t%s\n", d->department, d->students, avg, median);
+        }
+        for (int i = 0; i < ANALYTICS_SEMESTERS; i++) {
+            if (rep.bySemester[i]) fprintf(out, "row\tsemester\t%d\t%d\n", i, rep.bySemester[i]);
+        }
+        for (int b = 0; b < ANALYTICS_BUCKETS; b++) {
+            fprintf(out, "row\tcgpa\t%s\t%d\n", g_cgpaBucketLabels[b], rep.byCgpa[b]);
+        }
+        free(rep.depts);
+        char avg[NUM_BUF], median[NUM_BUF];
+        formatHundredths(rep.avgCgpa, avg);
+        formatHundredths(rep.medianCgpa, median);
+        fprintf(out, "ok\tanalytics\tstudents=%d\tavg=%s\tmedian=%s\n", rep.students, avg, median);
+        return 1;
+    }
+    if (strcmp(cmd, "top") == 0 || strcmp(cmd, "range") == 0) {
+        // top k[,department]  |  range min,max[,department[,limit]]
+        int top = (cmd[0] == 't');
+        if (top ? (n < 1 || atoi(parts[0]) <= 0) : n < 2)
+            return batchErr(out, cmd, top ? "usage: top k[,department]" : "usage: range min,max[,department[,limit]]");
+        const char *dept = (n > (top ? 1 : 2)) ? parts[top ? 1 : 2] : NULL;
+        Student *list = NULL;
+        int count = top ? topStudentsByCgpa(dept, atoi(parts[0]), &list)
+                        : studentsInCgpaRange(dept, hundredthsOf(parts[0]), hundredthsOf(parts[1]), n > 3 ? atoi(parts[3]) : 0, &list);
+        if (count < 0) return batchErr(out, cmd, "read failed");
+        for (int i = 0; i < count; i++) batchStudentRow(out, &list[i]);
+        free(list);
+        fprintf(out, "ok\t%s\tcount=%d\n", cmd, count);
+        return 1;
+    }
+    if (strcmp(cmd, "search") == 0) {
+        // search name[,offset[,limit]]  (20 per page by default)
+        if (n < 1 || (int)strlen(parts[0]) < NAME_MIN_QUERY) return batchErr(out, cmd, "usage: search name[,offset[,limit]] (at least 2 letters)");
+        Student *list = NULL;
+        int total = 0;
+        int count = searchStudentsByName(parts[0], n > 1 ? atoi(parts[1]) : 0, n > 2 ? atoi(parts[2]) : 20, &list, &total);
+        if (count < 0) return batchErr(out, cmd, "read failed");
+        for (int i = 0; i < count; i++) batchStudentRow(out, &list[i]);
+        free(list);
+        fprintf(out, "ok\tsearch\tcount=%d\ttotal=%d\n", count, total);
+        return 1;
+    }
+    if (strcmp(cmd, "login") == 0) {
+        if (n < 2) return batchErr(out, cmd, "usage: login username,password");
+        char role[16];
+        int sid = 0;
+        if (!loginUser(parts[0], parts[1], role, &sid)) return batchErr(out, cmd, "invalid credentials");
+        fprintf(out, "ok\tlogin\trole=%s\tstudentId=%d\n", role, sid);
+        return 1;
+    }
+    if (strcmp(cmd, "exists") == 0) {
+        if (n < 1 || parts[0][0] == '\0') return batchErr(out, cmd, "usage: exists username");
+        fprintf(out, "ok\texists\tlogins=%d\tadmissions=%d\n",
+                usernameExistsInLogins(parts[0]), usernameExistsInAdmissionsPending(parts[0]));
+        return 1;
+    }
+    if (strcmp(cmd, "createlogin") == 0) {
+        if (n < 4 || parts[0][0] == '\0' || parts[1][0] == '\0' || parts[2][0] == '\0')
+            return batchErr(out, cmd, "usage: createlogin username,password,role,studentId");
+        int r = createLogin(parts[0], parts[1], parts[2], atoi(parts[3]));
+        if (r != 1) return batchErr(out, cmd, r == 0 ? "username taken" : "write failed");
+        fprintf(out, "ok\tcreatelogin\n");
+        return 1;
+    }
+    if (strcmp(cmd, "admissions") == 0 && n > 1) {
+        // admissions status,department[,semester[,cursor[,limit[,back]]]]  (status, department may be empty)
+        ListFilter f = { parts[1], n > 2 ? atoi(parts[2]) : 0, parts[0] };
+        AdmissionInfo *list = NULL;
+        ListPage page;
+        int count = listAdmissionsPage(&f, n > 3 ? atoi(parts[3]) : 0, n > 4 ? atoi(parts[4]) : LIST_PAGE_ROWS,
+                                       n > 5 && atoi(parts[5]), &list, &page);
+        if (count < 0) return batchErr(out, cmd, "read failed");
+        for (int i = 0; i < count; i++) batchAdmissionRow(out, &list[i]);
+        free(list);
+        fprintf(out, "ok\tadmissions\tcount=%d\tprev=%d\tnext=%d\n", count, page.prev, page.next);
+        return 1;
+    }
+    if (strcmp(cmd, "admissions") == 0) {
+        // admissions  |  admissions tempId  |  admissions username
+        int tempId = (n >= 1 && isDigitsOnly(parts[0])) ? atoi(parts[0]) : 0;
+        const char *username = (n >= 1 && !tempId) ? parts[0] : NULL;
+        AdmissionInfo *list = NULL;
+        int count = listAdmissions(tempId, username, &list);
+        if (count < 0) return batchErr(out, cmd, "read failed");
+        for (int i = 0; i < count; i++) batchAdmissionRow(out, &list[i]);
+        free(list);
+        fprintf(out, "ok\tadmissions\tcount=%d\n", count);
+        return 1;
+    }
+    if (strcmp(cmd, "stats") == 0) {
+        FILE *tmp = tmpfile();
+        if (!tmp) return batchErr(out, cmd, "no temp file");
+        printOperationStats(tmp);
+        rewind(tmp);
+        char text[MAX_LINE];
+        while (fgets(text, sizeof(text), tmp)) fprintf(out, "row\t%s", text);
+        fclose(tmp);
+        fprintf(out, "ok\tstats\n");
+        return 1;
+    }
+    if (strcmp(cmd, "verifycgpa") == 0) {
+        // verifycgpa [fix]
+        int fix = (n > 0 && strcmp(parts[0], "fix") == 0);
+        CgpaReport rep;
+        CgpaMismatch *list = NULL;
+        int count = verifyCgpa(fix, &rep, &list);
+        if (count < 0) return batchErr(out, cmd, fix ? "write failed" : "read failed");
+        for (int i = 0; i < count; i++) {
+            char stored[NUM_BUF], computed[NUM_BUF];
+            formatHundredths(list[i].stored, stored);
+            formatHundredths(list[i].computed, computed);
+            fprintf(out, "row\t%d\t%s\t%s\n", list[i].id, stored, computed);
+        }
+        free(list);
+        fprintf(out, "ok\tverifycgpa\tstudents=%d\tmarksheets=%d\ttotals=%d\tmismatched=%d\tfixed=%d\n",
+                rep.students, rep.marksheets, rep.totalsMismatched, rep.cgpaMismatched, rep.fixed);
+        return 1;
+    }
+    if (strcmp(cmd, "export") == 0) {
+        if (n < 1 || parts[0][0] == '\0') return batchErr(out, cmd, "usage: export dir[,threads]");
+        ExportReport rep;
+        if (exportMarksheetReports(parts[0], n > 1 ? atoi(parts[1]) : 0, &rep) < 0) return batchErr(out, cmd, "write failed");
+        fprintf(out, "ok\texport\treports=%d\tmarksheets=%d\tfailed=%d\tthreads=%d\tseconds=%.3f\n",
+                rep.reports, rep.marksheets, rep.failed, rep.threads, rep.seconds);
+        return 1;
+    }
+    if (strcmp(cmd, "import") == 0) {
+        if (n < 1) return batchErr(out, cmd, "usage: import file.csv");
+        ImportReport rep;
+        int r = importStudentsCsv(parts[0], &rep);
+        if (r < 0) return batchErr(out, cmd, rep.rows ? "write failed" : "cannot read file");
+        fprintf(out, "ok\timport\trows=%d\timported=%d\tlogins=%d\trejected=%d\n",
+                rep.rows, rep.imported, rep.logins, rep.rejected);
+        return 1;
+    }
+    return batchErr(out, cmd, "unknown command");
+}
+
+static int batchCommandIn(const char *line, const char *const *names, size_t n) {
+    while (isspace((unsigned char)*line)) line++;
+    size_t len = strcspn(line, " \t\r\n");
+    for (size_t i = 0; i < n; i++) {
+        if (strlen(names[i]) == len && strncmp(line, names[i], len) == 0) return 1;
+    }
+    return 0;
+}
+
+// commands that only read and may run side by side
+static int batchIsReadCommand(const char *line) {
+    static const char *const reads[] = { "get", "marksheet", "login", "exists", "admissions", "analytics", "top", "range", "search",
+                                          "export" };
+    return batchCommandIn(line, reads, sizeof(reads) / sizeof(reads[0]));
+}
+
+// commands that read a pinned student snapshot and need no table lock at all
+static int batchIsSnapshotCommand(const char *line) {
+    static const char *const snaps[] = { "list" };
+    return batchCommandIn(line, snaps, sizeof(snaps) / sizeof(snaps[0]));
+}
+
+/* ---------- Held replies ---------- */
+/* Commands that run inside a commit window print their replies here rather than to
+   the caller, since their writes are not on disk until the window commits. heldSend
+   passes the replies on once the commit is known: as they are if it succeeded, and
+   with the "ok" of every command that may have written turned into
+   "err <cmd> commit failed" if it did not. */
+#define HELD_MAX BATCH_COMMIT_OPS   // commands per window (DAEMON_COMMIT_GROUP is smaller)
+
+typedef struct {
+    FILE *fp;                       // replies, one after another
+#ifndef _WIN32
+    char *data;                     // open_memstream buffer
+    size_t size;
+#endif
+    int n;
+    long end[HELD_MAX];             // where each command's reply ends in fp
+    int result[HELD_MAX];           // runBatchCommand's return value, 2 for an ok read
+    char cmd[HELD_MAX][16];
+    FILE *out[HELD_MAX];            // who gets the reply
+} HeldReplies;
+
+// Returns 0 on success, -1 if no stream could be opened.
+static int heldOpen(HeldReplies *h) {
+    h->n = 0;
+#ifdef _WIN32
+    h->fp = tmpfile();
+#else
+    h->data = NULL;
+    h->fp = open_memstream(&h->data, &h->size);
+#endif
+    return h->fp ? 0 : -1;
+}
+
+// after runBatchCommand(line, h->fp) returned r (line then starts with the command)
+static void heldAdd(HeldReplies *h, const char *line, int r, FILE *out) {
+    if (h->n == HELD_MAX) return;
+    h->end[h->n] = ftell(h->fp);
+    h->result[h->n] = (r == 1 && (batchIsReadCommand(line) || batchIsSnapshotCommand(line))) ? 2 : r;
+    size_t len = strlen(line);
+    if (len >= sizeof(h->cmd[0])) len = sizeof(h->cmd[0]) - 1;
+    memcpy(h->cmd[h->n], line, len);
+    h->cmd[h->n][len] = '\0';
+    h->out[h->n++] = out;
+}
+
+// Pass the replies on and close h. Returns how many "ok" replies became "err".
+static int heldSend(HeldReplies *h, int committed) {
+    char *text;
+    long len = ftell(h->fp);
+#ifdef _WIN32
+    text = malloc((size_t)(len > 0 ? len : 1));
+    rewind(h->fp);
+    if (text && len > 0 && fread(text, 1, (size_t)len, h->fp) != (size_t)len) len = 0;
+#else
+    fflush(h->fp);
+    text = h->data;
+#endif
+    int failed = 0;
+    long start = 0;
+    for (int i = 0; i < h->n; i++) {
+        if (!committed && h->result[i] == 1) {
+            fprintf(h->out[i], "err\t%s\tcommit failed\n", h->cmd[i]);
+            failed++;
+        } else if (text && h->end[i] <= len) {
+            fwrite(text + start, 1, (size_t)(h->end[i] - start), h->out[i]);
+        }
+        start = h->end[i];
+    }
+    fclose(h->fp);
+#ifdef _WIN32
+    free(text);
+#else
+    free(h->data);
+#endif
+    return failed;
+}
+
+/* Run commands from in until EOF. Returns 0 if every command succeeded, 1 otherwise.
+   Local commands run in commit windows of up to BATCH_COMMIT_OPS lines: the tables stay
+   locked for the window and its appends are written (and synced) once at its end; the
+   window's replies are held until then. Typed input commits after every line. */
+int runBatchMode(FILE *in) {
+    g_quiet = 1;
+    static char outBuf[1 << 16];
+    setvbuf(stdout, outBuf, _IOFBF, sizeof(outBuf));
+    char line[MAX_LINE * 4];
+    long ops = 0, ok = 0;
+    int window = (g_remote || isatty(fileno(in))) ? 1 : BATCH_COMMIT_OPS;
+    int inWindow = 0;
+    HeldReplies *held = (window > 1) ? malloc(sizeof(HeldReplies)) : NULL;
+    double t0 = nowSeconds();
+    while (fgets(line, sizeof(line), in)) {
+        if (held && inWindow == 0 && heldOpen(held) == 0) {
+            if (lockTables(TBL_ALL, TBL_ALL) == 1) inWindow = 1;
+            else heldSend(held, 1);
+        }
+        int r;
+        if (g_remote) {
+            r = remoteBatchCommand(line, stdout);
+        } else if (inWindow) {
+            r = runBatchCommand(line, held->fp);
+            heldAdd(held, line, r, stdout);
+        } else {
+            r = runBatchCommand(line, stdout);
+        }
+        if (r >= 0) {
+            ops++;
+            ok += r;
+        }
+        if (inWindow && ++inWindow > window) {
+            inWindow = 0;
+            int committed = (unlockTables(TBL_ALL) == 1);
+            if (!committed) discardUncommitted();
+            ok -= heldSend(held, committed);
+        }
+    }
+    if (inWindow) {
+        int committed = (unlockTables(TBL_ALL) == 1);
+        if (!committed) discardUncommitted();
+        ok -= heldSend(held, committed);
+    }
+    free(held);
+    double elapsed = nowSeconds() - t0;
+    printf("# ops=%ld ok=%ld err=%ld elapsed=%.6fs ops_per_sec=%.0f\n",
+           ops, ok, ops - ok, elapsed, elapsed > 0 ? ops / elapsed : 0.0);
+    fflush(stdout);
+    finishStudentJournal();
+    return (ok == ops) ? 0 : 1;
+}
+
+
+
+
+// =========================
+// sms.c  — Daemon and thin client
+// One process keeps the tables resident and serves many terminals:
+//   ./sms --daemon [socket] [--workers N]   serve clients on a Unix domain socket
+//   ./sms --connect [socket]                the usual menus, operations run in the daemon
+//   ./sms --connect [socket] --batch [file] batch commands against the daemon
+// A request is one batch-mode command line; the reply is its batch-mode output, ending
+// with the "ok"/"err" line (blank lines and comments get no reply). A fixed pool of
+// workers runs requests: read-only commands share the table lock, every other command
+// holds it alone; writes queued back to back share one commit (up to DAEMON_COMMIT_GROUP).
+// Default socket: DAEMON_SOCKET. The daemon needs POSIX.
+// =========================
+
+/* ---------- Thin client ---------- */
+
+static FILE *g_remoteIn = NULL;
+static FILE *g_remoteOut = NULL;
+
+typedef struct {
+    TextBuf rows;           // payload of every "row" line, '\n'-terminated
+    int nRows;
+    char status[MAX_LINE];  // the closing ok/err line
+} RemoteReply;
+
+static int remoteLost() {
+    static int reported = 0;
+    if (!reported && !g_quiet) printf("❌ Lost the connection to the daemon.\n");
+    reported = 1;
+    return -1;
+}
+
+/* Send one command and collect the reply. Returns 1 for ok, 0 for err, -1 if the
+   daemon is gone. The caller frees rep->rows. */
+static int remoteCall(RemoteReply *rep, const char *fmt, ...) {
+    memset(rep, 0, sizeof(*rep));
+    if (!g_remoteIn || !g_remoteOut) return remoteLost();
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(g_remoteOut, fmt, ap);
+    va_end(ap);
+    fputc('\n', g_remoteOut);
+    if (fflush(g_remoteOut) != 0) return remoteLost();
+    char line[MAX_LINE * 4];
+    while (fgets(line, sizeof(line), g_remoteIn)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strncmp(line, "row\t", 4) == 0) {
+            textBufPrintf(&rep->rows, "%s\n", line + 4);
+            rep->nRows++;
+            continue;
+        }
+        size_t len = strlen(line);
+        if (len >= sizeof(rep->status)) len = sizeof(rep->status) - 1;
+        memcpy(rep->status, line, len);
+        rep->status[len] = '\0';
+        return strncmp(line, "ok\t", 3) == 0 ? 1 : 0;
+    }
+    return remoteLost();
+}
+
+// copy the value of "key=" from the status line; returns 1 if present
+static int remoteValue(const RemoteReply *rep, const char *key, char *buf, size_t size) {
+    size_t len = strlen(key);
+    for (const char *p = strchr(rep->status, '\t'); p; p = strchr(p + 1, '\t')) {
+        if (strncmp(p + 1, key, len) != 0 || p[1 + len] != '=') continue;
+        const char *v = p + 2 + len;
+        size_t n = strcspn(v, "\t");
+        if (n >= size) n = size - 1;
+        memcpy(buf, v, n);
+        buf[n] = '\0';
+        return 1;
+    }
+    return 0;
+}
+
+static int remoteInt(const RemoteReply *rep, const char *key) {
+    char buf[32];
+    return remoteValue(rep, key, buf, sizeof(buf)) ? atoi(buf) : 0;
+}
+
+// err line with exactly this reason?
+static int remoteErrIs(const RemoteReply *rep, const char *reason) {
+    const char *p = strrchr(rep->status, '\t');
+    return strncmp(rep->status, "err\t", 4) == 0 && p && strcmp(p + 1, reason) == 0;
+}
+
+// split the next reply row on tabs (in place); returns the field count, 0 at the end
+static int remoteNextRow(char **cursor, char **fields, int maxFields) {
+    char *row = *cursor;
+    if (!row || !*row) return 0;
+    char *nl = strchr(row, '\n');
+    *nl = '\0';
+    *cursor = nl + 1;
+    int n = 0;
+    while (n < maxFields) {
+        fields[n++] = row;
+        char *tab = strchr(row, '\t');
+        if (!tab) break;
+        *tab = '\0';
+        row = tab + 1;
+    }
+    return n;
+}
+
+// "row id name department semester cgpa" (as written by batchStudentRow)
+static int remoteStudentRow(char **cursor, Student *s) {
+    char *f[5];
+    int n;
+    while ((n = remoteNextRow(cursor, f, 5)) != 0) {
+        if (n < 5) continue;
+        memset(s, 0, sizeof(*s));
+        s->id = atoi(f[0]);
+        strncpy(s->name, f[1], sizeof(s->name)-1);
+        strncpy(s->department, f[2], sizeof(s->department)-1);
+        s->semester = atoi(f[3]);
+        s->cgpa = hundredthsOf(f[4]);
+        return 1;
+    }
+    return 0;
+}
+
+// "row tempId name department semester email username status studentId" (as written by batchAdmissionRow)
+static int remoteAdmissionRow(char **cursor, AdmissionInfo *a) {
+    char *f[8];
+    int n;
+    while ((n = remoteNextRow(cursor, f, 8)) != 0) {
+        if (n < 8) continue;
+        memset(a, 0, sizeof(*a));
+        a->tempId = atoi(f[0]);
+        strncpy(a->name, f[1], sizeof(a->name)-1);
+        strncpy(a->department, f[2], sizeof(a->department)-1);
+        a->semester = atoi(f[3]);
+        strncpy(a->email, f[4], sizeof(a->email)-1);
+        strncpy(a->username, f[5], sizeof(a->username)-1);
+        strncpy(a->status, f[6], sizeof(a->status)-1);
+        a->studentId = atoi(f[7]);
+        return 1;
+    }
+    return 0;
+}
+
+static int remoteSimple(RemoteReply *rep, int r, const char *notFoundReason) {
+    textBufFree(&rep->rows);
+    if (r == 1) return 1;
+    return (r == 0 && notFoundReason && remoteErrIs(rep, notFoundReason)) ? 0 : -1;
+}
+
+static unsigned char remoteUsernameFlags(const char *username) {
+    RemoteReply rep;
+    unsigned char flags = 0;
+    if (remoteCall(&rep, "exists %s", username) == 1) {
+        if (remoteInt(&rep, "logins")) flags |= UNAME_IN_LOGINS;
+        if (remoteInt(&rep, "admissions")) flags |= UNAME_IN_ADMISSIONS;
+    }
+    textBufFree(&rep.rows);
+    return flags;
+}
+
+static int remoteReserveIds(SequenceId seq, int count) {
+    RemoteReply rep;
+    int r = remoteCall(&rep, "nextid %s,%d", seq == SEQ_STUDENTS ? "students" : "admissions", count);
+    textBufFree(&rep.rows);
+    return r == 1 ? remoteInt(&rep, "first") : -1;
+}
+
+static int remoteCreateLogin(const char *username, const char *password, const char *role, int studentId) {
+    RemoteReply rep;
+    char user[CSV_FIELD_SIZE(MAX_USERNAME)], pass[CSV_FIELD_SIZE(MAX_PASS)];
+    int r = remoteCall(&rep, "createlogin %s,%s,%s,%d", csvField(username, user, sizeof(user)),
+                       csvField(password, pass, sizeof(pass)), role, studentId);
+    return remoteSimple(&rep, r, "username taken");
+}
+
+/* Not atomic: one request per login, so a -1 can come after some entries were
+   written. status[] (when given) is filled for every entry either way and says
+   which logins exist; callers that need all-or-nothing undo those themselves. */
+static int remoteCreateLoginsBatch(const LoginEntry *entries, int count, int *status) {
+    int created = 0, failed = 0;
+    for (int i = 0; i < count; i++) {
+        int r = failed ? 0 : remoteCreateLogin(entries[i].username, entries[i].password, entries[i].role, entries[i].studentId);
+        if (r < 0) failed = 1;
+        if (status) status[i] = (r == 1);
+        created += (r == 1);
+    }
+    return failed ? -1 : created;
+}
+
+static int remoteSubmitAdmission(const Student *s, const char *email, const char *username, const char *password) {
+    RemoteReply rep;
+    char name[CSV_FIELD_SIZE(MAX_NAME)], dept[CSV_FIELD_SIZE(MAX_DEPT)], mail[CSV_FIELD_SIZE(MAX_TOKEN)];
+    char user[CSV_FIELD_SIZE(MAX_USERNAME)], pass[CSV_FIELD_SIZE(MAX_PASS)];
+    int r = remoteCall(&rep, "register %s,%s,%d,%s,%s,%s", csvField(s->name, name, sizeof(name)),
+                       csvField(s->department, dept, sizeof(dept)), s->semester, csvField(email, mail, sizeof(mail)),
+                       csvField(username, user, sizeof(user)), csvField(password, pass, sizeof(pass)));
+    if (r == 1) {
+        textBufFree(&rep.rows);
+        return remoteInt(&rep, "tempId");
+    }
+    return remoteSimple(&rep, r, "username taken");
+}
+
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// ids as ranges ("120-180,190"), which keeps request lines short
+static void remoteIdSpec(TextBuf *spec, const int *ids, int count) {
+    int *sorted = malloc((size_t)count * sizeof(int));
+    if (!sorted) {
+        for (int i = 0; i < count; i++) textBufPrintf(spec, "%s%d", i ? "," : "", ids[i]);
+        return;
+    }
+    memcpy(sorted, ids, (size_t)count * sizeof(int));
+    qsort(sorted, (size_t)count, sizeof(int), compareInts);
+    for (int i = 0; i < count; ) {
+        int j = i;
+        while (j + 1 < count && sorted[j + 1] <= sorted[j] + 1) j++;
+        if (sorted[j] == sorted[i]) textBufPrintf(spec, "%s%d", spec->len ? "," : "", sorted[i]);
+        else textBufPrintf(spec, "%s%d-%d", spec->len ? "," : "", sorted[i], sorted[j]);
+        i = j + 1;
+    }
+    free(sorted);
+}
+
+static int remoteApproveAdmissionsBatch(const int *tempIds, int count, ApprovalResult **outResults, int *outCount) {
+    *outResults = NULL;
+    *outCount = 0;
+    if (tempIds && count <= 0) return 0;
+    TextBuf spec = {0};
+    if (tempIds) remoteIdSpec(&spec, tempIds, count);
+    RemoteReply rep;
+    int r = remoteCall(&rep, "approve %s", tempIds ? (spec.data ? spec.data : "") : "all");
+    textBufFree(&spec);
+    if (r != 1) {
+        textBufFree(&rep.rows);
+        return -1;
+    }
+    ApprovalResult *results = malloc((size_t)(rep.nRows ? rep.nRows : 1) * sizeof(ApprovalResult));
+    if (!results) {
+        textBufFree(&rep.rows);
+        return -1;
+    }
+    static const int codes[] = { APPROVE_OK, APPROVE_NOT_FOUND, APPROVE_ALREADY, APPROVE_USERNAME_TAKEN,
+                                 APPROVE_MALFORMED, APPROVE_ERROR };
+    char *cursor = rep.rows.data, *f[3];
+    int n = 0, fields;
+    while ((fields = remoteNextRow(&cursor, f, 3)) != 0) {
+        if (fields < 3) continue;
+        results[n].tempId = atoi(f[0]);
+        results[n].result = APPROVE_ERROR;
+        for (size_t k = 0; k < sizeof(codes) / sizeof(codes[0]); k++) {
+            if (strcmp(f[1], approvalResultText(codes[k])) == 0) results[n].result = codes[k];
+        }
+        results[n].studentId = atoi(f[2]);
+        n++;
+    }
+    textBufFree(&rep.rows);
+    *outResults = results;
+    *outCount = n;
+    return remoteInt(&rep, "approved");
+}
+
+static int remoteListAdmissions(int tempId, const char *username, AdmissionInfo **out) {
+    *out = NULL;
+    RemoteReply rep;
+    int r;
+    if (tempId > 0) r = remoteCall(&rep, "admissions %d", tempId);
+    else if (username && username[0]) r = remoteCall(&rep, "admissions %s", username);
+    else r = remoteCall(&rep, "admissions");
+    if (r != 1) {
+        textBufFree(&rep.rows);
+        return -1;
+    }
+    AdmissionInfo *list = calloc((size_t)(rep.nRows ? rep.nRows : 1), sizeof(AdmissionInfo));
+    if (!list) {
+        textBufFree(&rep.rows);
+        return -1;
+    }
+    char *cursor = rep.rows.data;
+    int n = 0;
+    while (n < rep.nRows && remoteAdmissionRow(&cursor, &list[n])) n++;
+    textBufFree(&rep.rows);
+    *out = list;
+    return n;
+}
+
+static int remoteListAdmissionsPage(const ListFilter *f, int cursor, int limit, int backward, AdmissionInfo **out, ListPage *page) {
+    *out = NULL;
+    page->next = page->prev = -1;
+    RemoteReply rep;
+    char status[CSV_FIELD_SIZE(MAX_STATUS)], dept[CSV_FIELD_SIZE(MAX_DEPT)];
+    int r = remoteCall(&rep, "admissions %s,%s,%d,%d,%d,%d", csvField(f->status ? f->status : "", status, sizeof(status)),
+                       csvField(f->department ? f->department : "", dept, sizeof(dept)), f->semester, cursor, limit, backward);
+    AdmissionInfo *list = (r == 1) ? calloc((size_t)(rep.nRows ? rep.nRows : 1), sizeof(AdmissionInfo)) : NULL;
+    if (!list) {
+        textBufFree(&rep.rows);
+        return -1;
+    }
+    char *rows = rep.rows.data;
+    int n = 0;
+    while (n < rep.nRows && remoteAdmissionRow(&rows, &list[n])) n++;
+    textBufFree(&rep.rows);
+    *out = list;
+    page->prev = remoteInt(&rep, "prev");
+    page->next = remoteInt(&rep, "next");
+    return n;
+}
+
+static int remoteLoginUser(const char *username, const char *password, char *outRole, int *outStudentId) {
+    RemoteReply rep;
+    int r = remoteCall(&rep, "login %s,%s", username, password);
+    textBufFree(&rep.rows);
+    if (r != 1 || !remoteValue(&rep, "role", outRole, 16)) return 0;
+    *outStudentId = remoteInt(&rep, "studentId");
+    return 1;
+}
+
+static int remoteAddStudentRecord(const Student *s) {
+    RemoteReply rep;
+    char line[MAX_LINE];
+    int r = remoteCall(&rep, "insert %s", studentCsvLine(s, line, sizeof(line)));
+    return remoteSimple(&rep, r, "duplicate id");
+}
+
+// not atomic either: see remoteCreateLoginsBatch; after -1, status[] marks the students added
+static int remoteAddStudentRecordsBatch(const Student *list, int count, int *status) {
+    int added = 0, failed = 0;
+    for (int i = 0; i < count; i++) {
+        int r = failed ? 0 : remoteAddStudentRecord(&list[i]);
+        if (r < 0) failed = 1;
+        if (status) status[i] = (r == 1);
+        added += (r == 1);
+    }
+    return failed ? -1 : added;
+}
+
+static int remoteFindStudentById(int id, Student *out) {
+    RemoteReply rep;
+    int r = remoteCall(&rep, "get %d", id);
+    if (r == 1) {
+        Student s;
+        char *cursor = rep.rows.data;
+        int found = remoteStudentRow(&cursor, &s);
+        textBufFree(&rep.rows);
+        if (!found) return -1;
+        if (out) *out = s;
+        return 1;
+    }
+    return remoteSimple(&rep, r, "not found");
+}
+
+static int remoteUpdateStudentRecord(int id, const Student *newData) {
+    RemoteReply rep;
+    Student s = *newData;
+    s.id = id;
+    char line[MAX_LINE];
+    int r = remoteCall(&rep, "update %s", studentCsvLine(&s, line, sizeof(line)));
+    return remoteSimple(&rep, r, "not found");
+}
+
+static int remoteDeleteStudentsBatch(const int *ids, int count) {
+    if (count <= 0) return 0;
+    TextBuf spec = {0};
+    remoteIdSpec(&spec, ids, count);
+    if (!spec.data) return -1;
+    // keep each request well below DAEMON_LINE_MAX
+    int deleted = 0;
+    char *p = spec.data;
+    while (*p) {
+        char *end = p + strlen(p);
+        if (end - p > DAEMON_LINE_MAX / 2) {
+            end = p + DAEMON_LINE_MAX / 2;
+            while (*end != ',') end--;
+        }
+        char saved = *end;
+        *end = '\0';
+        RemoteReply rep;
+        int r = remoteCall(&rep, "delete %s", p);
+        textBufFree(&rep.rows);
+        *end = saved;
+        if (r == 1) deleted += remoteInt(&rep, "count");
+        else if (!(r == 0 && remoteErrIs(&rep, "not found"))) {
+            textBufFree(&spec);
+            return -1;
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+    textBufFree(&spec);
+    return deleted;
+}
+
+// the predicate runs here, over the daemon's listing
+static int remoteDeleteStudentsWhere(int (*pred)(const Student *, void *), void *ctx) {
+    RemoteReply rep;
+    if (remoteCall(&rep, "list") != 1) {
+        textBufFree(&rep.rows);
+        return -1;
+    }
+    int *ids = malloc((size_t)(rep.nRows ? rep.nRows : 1) * sizeof(int));
+    if (!ids) {
+        textBufFree(&rep.rows);
+        return -1;
+    }
+    int n = 0;
+    Student s;
+    char *cursor = rep.rows.data;
+    while (remoteStudentRow(&cursor, &s)) {
+        if (pred(&s, ctx)) ids[n++] = s.id;
+    }
+    textBufFree(&rep.rows);
+    int r = remoteDeleteStudentsBatch(ids, n);
+    free(ids);
+    return r;
+}
+
+static void remoteListAllStudents() {
+    RemoteReply rep;
+    int r = remoteCall(&rep, "list");
+    if (r != 1 || rep.nRows == 0) {
+        printf("❌ No student records found!\n");
+        textBufFree(&rep.rows);
+        return;
+    }
+    printStudentListHeader();
+    TextBuf buf = {0};
+    Student s;
+    char *cursor = rep.rows.data;
+    while (remoteStudentRow(&cursor, &s)) listOutStudent(&buf, &s);
+    textBufFree(&rep.rows);
+    listOutEnd(&buf);
+}
+
+static int remoteListStudentsPage(const ListFilter *f, int cursor, int limit, int backward, Student **out, ListPage *page) {
+    *out = NULL;
+    page->next = page->prev = -1;
+    RemoteReply rep;
+    char dept[CSV_FIELD_SIZE(MAX_DEPT)];
+    int r = remoteCall(&rep, "list %s,%d,%d,%d,%d", csvField(f->department ? f->department : "", dept, sizeof(dept)),
+                       f->semester, cursor, limit, backward);
+    Student *list = (r == 1) ? malloc((size_t)(rep.nRows ? rep.nRows : 1) * sizeof(Student)) : NULL;
+    if (!list) {
+        textBufFree(&rep.rows);
+        return -1;
+    }
+    int n = 0;
+    char *rows = rep.rows.data;
+    while (n < rep.nRows && remoteStudentRow(&rows, &list[n])) n++;
+    textBufFree(&rep.rows);
+    *out = list;
+    page->prev = remoteInt(&rep, "prev");
+    page->next = remoteInt(&rep, "next");
+    return n;
+}
+
+static int remoteAddMarksheetEntry(int studentId, const char *semesterLabel, const char *subjects) {
+    RemoteReply rep;
+    char label[CSV_FIELD_SIZE(MAX_LINE)];
+    int r = remoteCall(&rep, "addmarks %d,%s%s%s", studentId, csvField(semesterLabel, label, sizeof(label)),
+                       (subjects && subjects[0]) ? "," : "", subjects ? subjects : "");
+    return remoteSimple(&rep, r, "student not found");
+}
+
+static int remoteCollectMarksheets(int studentId, TextBuf *out) {
+    RemoteReply rep;
+    if (remoteCall(&rep, "marksheet %d", studentId) != 1) {
+        textBufFree(&rep.rows);
         return -1;
     }
+    if (rep.rows.data) textBufPrintf(out, "%s", rep.rows.data);
+    textBufFree(&rep.rows);
+    return rep.nRows;
+}
 
-    // username / password for future login (will be active only after approval)
-    while (1) {
-        getStringInput("Choose Username: ", username, sizeof(username));
-        if (usernameExists(username)) {
-            printf("❌ Username already taken (either in system or a pending request). Choose another.\n");
-            continue;
+static int remoteStudentAnalytics(AnalyticsReport *out) {
+    memset(out, 0, sizeof(*out));
+    RemoteReply rep;
+    DeptAnalytics *depts = NULL;
+    if (remoteCall(&rep, "analytics") != 1 ||
+        !(depts = calloc((size_t)(rep.nRows ? rep.nRows : 1), sizeof(DeptAnalytics)))) {
+        textBufFree(&rep.rows);
+        return -1;
+    }
+    char *cursor = rep.rows.data, *f[5];
+    int fields;
+    while ((fields = remoteNextRow(&cursor, f, 5)) != 0) {
+        if (fields >= 5 && strcmp(f[0], "dept") == 0) {
+            DeptAnalytics *d = &depts[out->nDepts++];
+            strncpy(d->department, f[1], sizeof(d->department)-1);
+            d->students = atoi(f[2]);
+            d->avgCgpa = hundredthsOf(f[3]);
+            d->medianCgpa = hundredthsOf(f[4]);
+        } else if (fields >= 3 && strcmp(f[0], "semester") == 0) {
+            int sem = atoi(f[1]);
+            if (sem >= 0 && sem < ANALYTICS_SEMESTERS) out->bySemester[sem] = atoi(f[2]);
+        } else if (fields >= 3 && strcmp(f[0], "cgpa") == 0) {
+            for (int b = 0; b < ANALYTICS_BUCKETS; b++) {
+                if (strcmp(f[1], g_cgpaBucketLabels[b]) == 0) out->byCgpa[b] = atoi(f[2]);
+            }
         }
-        break;
     }
-    getStringInput("Choose Password: ", password, sizeof(password));
+    textBufFree(&rep.rows);
+    out->depts = depts;
+    out->students = remoteInt(&rep, "students");
+    char value[32];
+    if (remoteValue(&rep, "avg", value, sizeof(value))) out->avgCgpa = hundredthsOf(value);
+    if (remoteValue(&rep, "median", value, sizeof(value))) out->medianCgpa = hundredthsOf(value);
+    return 1;
+}
 
-    // determine new temp id
-    int tempId = nextAdmissionTempId();
+static int remoteRankQuery(const char *department, int minCgpa, int maxCgpa, int limit, int top, Student **out) {
+    *out = NULL;
+    RemoteReply rep;
+    char dept[CSV_FIELD_SIZE(MAX_DEPT)], lo[NUM_BUF], hi[NUM_BUF];
+    csvField(department ? department : "", dept, sizeof(dept));
+    formatHundredths(minCgpa, lo);
+    formatHundredths(maxCgpa, hi);
+    int r = top ? remoteCall(&rep, "top %d,%s", limit, dept)
+                : remoteCall(&rep, "range %s,%s,%s,%d", lo, hi, dept, limit);
+    Student *list = (r == 1) ? malloc((size_t)(rep.nRows ? rep.nRows : 1) * sizeof(Student)) : NULL;
+    if (!list) {
+        textBufFree(&rep.rows);
+        return -1;
+    }
+    int n = 0;
+    char *cursor = rep.rows.data;
+    while (n < rep.nRows && remoteStudentRow(&cursor, &list[n])) n++;
+    textBufFree(&rep.rows);
+    *out = list;
+    return n;
+}
 
-    FILE *fp = fopen(ADMISSION_FILE, "a");
-    if (!fp) {
-        printf("❌ Unable to open %s for writing.\n", ADMISSION_FILE);
+static int remoteSearchStudentsByName(const char *query, int offset, int limit, Student **out, int *total) {
+    *out = NULL;
+    *total = 0;
+    RemoteReply rep;
+    char q[CSV_FIELD_SIZE(MAX_NAME)];
+    int r = remoteCall(&rep, "search %s,%d,%d", csvField(query, q, sizeof(q)), offset, limit);
+    Student *list = (r == 1) ? malloc((size_t)(rep.nRows ? rep.nRows : 1) * sizeof(Student)) : NULL;
+    if (!list) {
+        textBufFree(&rep.rows);
         return -1;
     }
+    int n = 0;
+    char *cursor = rep.rows.data;
+    while (n < rep.nRows && remoteStudentRow(&cursor, &list[n])) n++;
+    textBufFree(&rep.rows);
+    *out = list;
+    *total = remoteInt(&rep, "total");
+    return n;
+}
 
-    // admission format:
-    // tempId,name,department,semester,email,username,password,status,studentId
-    // status: pending (initial). studentId: 0 (initial)
-    fprintf(fp, "%d,%s,%s,%d,%s,%s,%s,pending,0\n",
-            tempId, s.name, s.department, s.semester, email, username, password);
-    fclose(fp);
+static int remoteImportStudentsCsv(const char *path, ImportReport *report) {
+    memset(report, 0, sizeof(*report));
+    double t0 = nowSeconds();
+    // the daemon resolves relative paths against its own directory
+    char full[4096];
+#ifdef _WIN32
+    if (!_fullpath(full, path, sizeof(full))) return -1;
+#else
+    if (!realpath(path, full)) return -1;
+#endif
+    RemoteReply rep;
+    int r = remoteCall(&rep, "import %s", full);
+    textBufFree(&rep.rows);
+    report->seconds = nowSeconds() - t0;
+    if (r != 1) {
+        report->rows = remoteErrIs(&rep, "write failed") ? 1 : 0; // rows > 0: the file itself was readable
+        return -1;
+    }
+    report->rows = remoteInt(&rep, "rows");
+    report->imported = remoteInt(&rep, "imported");
+    report->logins = remoteInt(&rep, "logins");
+    report->rejected = remoteInt(&rep, "rejected");
+    return report->imported;
+}
 
-    printf("✅ Admission request saved with temporary ID: %d\n", tempId);
-    printf("ℹ️  Your request is pending. After admin approval you'll be able to login.\n");
-    return tempId;
+static int remoteExportMarksheetReports(const char *dir, int threads, ExportReport *report) {
+    memset(report, 0, sizeof(*report));
+    double t0 = nowSeconds();
+    // the daemon writes the files; give it an absolute path to the same directory
+    char full[4096];
+    if (makeDir(dir) != 0) return -1;
+#ifdef _WIN32
+    if (!_fullpath(full, dir, sizeof(full))) return -1;
+#else
+    if (!realpath(dir, full)) return -1;
+#endif
+    RemoteReply rep;
+    char d[CSV_FIELD_SIZE(4096)];
+    int r = remoteCall(&rep, "export %s,%d", csvField(full, d, sizeof(d)), threads);
+    textBufFree(&rep.rows);
+    report->seconds = nowSeconds() - t0;
+    if (r != 1) return -1;
+    report->reports = remoteInt(&rep, "reports");
+    report->marksheets = remoteInt(&rep, "marksheets");
+    report->failed = remoteInt(&rep, "failed");
+    report->threads = remoteInt(&rep, "threads");
+    return report->reports;
 }
 
-/* ---------- Approve admission by temp id ---------- */
-/* returns 1 on success, 0 if not found, -1 on error */
-int approveAdmissionById(int admissionTempId) {
-    FILE *fp = fopen(ADMISSION_FILE, "r");
-    if (!fp) {
-        printf("❌ %s not found.\n", ADMISSION_FILE);
+static int remoteVerifyCgpa(int fix, CgpaReport *report, CgpaMismatch **out) {
+    memset(report, 0, sizeof(*report));
+    *out = NULL;
+    RemoteReply rep;
+    int r = remoteCall(&rep, fix ? "verifycgpa fix" : "verifycgpa");
+    CgpaMismatch *list = (r == 1) ? malloc((size_t)(rep.nRows ? rep.nRows : 1) * sizeof(CgpaMismatch)) : NULL;
+    if (!list) {
+        textBufFree(&rep.rows);
         return -1;
     }
+    char *cursor = rep.rows.data, *f[3];
+    int n = 0;
+    while (n < rep.nRows && remoteNextRow(&cursor, f, 3) == 3) {
+        list[n].id = atoi(f[0]);
+        list[n].stored = hundredthsOf(f[1]);
+        list[n].computed = hundredthsOf(f[2]);
+        n++;
+    }
+    textBufFree(&rep.rows);
+    *out = list;
+    report->students = remoteInt(&rep, "students");
+    report->marksheets = remoteInt(&rep, "marksheets");
+    report->totalsMismatched = remoteInt(&rep, "totals");
+    report->cgpaMismatched = remoteInt(&rep, "mismatched");
+    report->fixed = remoteInt(&rep, "fixed");
+    return n;
+}
 
-    FILE *tmp = fopen(TEMP_FILE, "w");
-    if (!tmp) {
-        fclose(fp);
-        printf("❌ Error creating temp file.\n");
+static void remotePrintStats() {
+    RemoteReply rep;
+    if (remoteCall(&rep, "stats") == 1 && rep.rows.data) fputs(rep.rows.data, stdout);
+    else printf("❌ Unable to fetch stats from the daemon.\n");
+    textBufFree(&rep.rows);
+}
+
+// --connect --batch: forward one command line and copy the reply (same contract as runBatchCommand)
+static int remoteBatchCommand(char *line, FILE *out) {
+    trim(line);
+    if (line[0] == '\0' || line[0] == '#') return -1;
+    RemoteReply rep;
+    int r = remoteCall(&rep, "%s", line);
+    for (char *p = rep.rows.data; p && *p; ) {
+        char *nl = strchr(p, '\n');
+        fprintf(out, "row\t%.*s\n", (int)(nl - p), p);
+        p = nl + 1;
+    }
+    textBufFree(&rep.rows);
+    if (r < 0) {
+        line[strcspn(line, " \t")] = '\0';
+        fprintf(out, "err\t%s\tconnection lost\n", line);
+        return 0;
+    }
+    fprintf(out, "%s\n", rep.status);
+    return r;
+}
+
+int connectDaemon(const char *socketPath) {
+#ifdef _WIN32
+    printf("❌ --connect needs Unix domain sockets and is not available on Windows.\n");
+    (void)socketPath;
+    return -1;
+#else
+    struct sockaddr_un addr;
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+        printf("❌ Socket path too long: %s\n", socketPath);
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socketPath);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        if (fd >= 0) close(fd);
+        printf("❌ No daemon is listening on %s.\n", socketPath);
         return -1;
     }
+    signal(SIGPIPE, SIG_IGN); // a vanished daemon shows up as a failed write instead
+    g_remoteIn = fdopen(fd, "r");
+    g_remoteOut = fdopen(dup(fd), "w");
+    if (!g_remoteIn || !g_remoteOut) return -1;
+    g_remote = 1;
+    return 0;
+#endif
+}
 
-    char line[MAX_LINE];
-    int found = 0;
-    int approvedCount = 0;
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') {
-            fprintf(tmp, "\n");
-            continue;
-        }
+/* ---------- Daemon ---------- */
+#ifndef _WIN32
+
+typedef struct {
+    int fd;
+    FILE *out;          // replies, written by the worker running the request
+    char *buf;          // bytes received but not executed yet
+    size_t len, cap;
+    int busy;           // a worker owns the client (and buf) until it hands it back
+} DaemonClient;
+
+static struct {
+    pthread_rwlock_t tableLock;
+    pthread_mutex_t queueLock;
+    pthread_cond_t queueReady;
+    DaemonClient *queue[DAEMON_MAX_CLIENTS]; // a client is queued at most once
+    int queueHead, queueLen;
+    int stopping;
+    int donePipe[2];    // workers hand finished clients back to the poll loop
+} g_daemon;
+
+static volatile sig_atomic_t g_daemonStop = 0;
+
+static void daemonOnSignal(int sig) {
+    (void)sig;
+    g_daemonStop = 1;
+}
 
-        char copy[MAX_LINE];
-        strcpy(copy, line);
+// Lazily built indexes are built here, under the exclusive lock, so readers never do.
+// Taking the table locks also reloads whatever another process has changed.
+static void daemonWarmCaches() {
+    if (lockTables(TBL_ALL, 0) != 1) return;
+    ensureStudentTable();
+    ensureRankIndex();
+    ensureNameIndex();
+    loadUsernameIndex();
+    ensureMarksheetIndex();
+    marksheetMapping();
+    unlockTables(TBL_ALL);
+}
 
-        // parse tokens:
-        // tempId,name,department,semester,email,username,password,status,studentId
-        char *tok = strtok(copy, ",");
-        if (!tok) {
-            fprintf(tmp, "%s\n", line); // preserve malformed line
-            continue;
+static int daemonCachesFresh() {
+    struct stat st;
+    long size = (stat(MARKSHEET_FILE, &st) == 0) ? (long)st.st_size : 0;
+    return g_usernames.loaded && g_marks.loaded && g_marks.fileSize == size && !g_rankStale && !g_names.stale &&
+           g_marks.file.size == (size_t)size && !tablesChangedElsewhere();
+}
+
+// Read-only request: shares the caches with other readers (or reads a snapshot).
+static void daemonExecute(char *line, FILE *out) {
+    if (batchIsSnapshotCommand(line)) {
+        if (tablesChangedElsewhere()) {
+            // another process wrote: reload (and republish the snapshot) first
+            pthread_rwlock_wrlock(&g_daemon.tableLock);
+            daemonWarmCaches();
+            pthread_rwlock_unlock(&g_daemon.tableLock);
         }
-        int tid = atoi(tok);
-
-        if (tid == admissionTempId) {
-            // we found the admission entry to approve
-            found = 1;
-
-            // re-parse original line tokens to preserve commas in later fields (we assume fields have no commas)
-            char fields[MAX_LINE];
-            strcpy(fields, line);
-            char *parts[10];
-            int p = 0;
-            char *ptr = strtok(fields, ",");
-            while (ptr && p < 10) {
-                parts[p++] = ptr;
-                ptr = strtok(NULL, ",");
-            }
-            // ensure we have at least 7 tokens (up to password). If fewer, write back unchanged.
-            if (p < 7) {
-                printf("❌ Malformed admission entry for tempId %d. Skipping.\n", tid);
-                fprintf(tmp, "%s\n", line);
-                continue;
-            }
-            char *name = parts[1];
-            char *department = parts[2];
-            char *semStr = parts[3];
-            char *email = parts[4];
-            char *username = parts[5];
-            char *password = parts[6];
-            char *status = (p >= 8) ? parts[7] : "pending";
-            // studentId if present
-            int linkedId = 0;
-            if (p >= 9) linkedId = atoi(parts[8]);
-
-            // if already approved, leave as-is
-            if (strcmp(status, "approved") == 0 && linkedId > 0) {
-                printf("ℹ️ Admission %d already approved (Student ID %d).\n", tid, linkedId);
-                fprintf(tmp, "%s\n", line);
-                continue;
-            }
+        t_readOnlyCaches = 1;
+        runBatchCommand(line, out);
+    } else {
+        pthread_rwlock_rdlock(&g_daemon.tableLock);
+        if (!daemonCachesFresh()) {
+            // a data file changed outside the daemon: rebuild before reading
+            pthread_rwlock_unlock(&g_daemon.tableLock);
+            pthread_rwlock_wrlock(&g_daemon.tableLock);
+            daemonWarmCaches();
+            pthread_rwlock_unlock(&g_daemon.tableLock);
+            pthread_rwlock_rdlock(&g_daemon.tableLock);
+        }
+        t_readOnlyCaches = 1;
+        runBatchCommand(line, out);
+        pthread_rwlock_unlock(&g_daemon.tableLock);
+    }
+    t_readOnlyCaches = 0;
+}
 
-            // Before creating student, ensure username is still free in LOGINS_FILE
-            if (usernameExistsInLogins(username)) {
-                printf("❌ Cannot approve admission %d — username '%s' already exists in system. Ask applicant to choose a different username.\n", tid, username);
-                // keep admission pending and write original line unchanged
-                fprintf(tmp, "%s\n", line);
-                continue;
-            }
+// copy the client's next request line into line and drop it from its buffer
+static void daemonTakeLine(DaemonClient *c, char *line) {
+    char *nl = memchr(c->buf, '\n', c->len);
+    size_t len = (size_t)(nl - c->buf);
+    memcpy(line, c->buf, len);
+    line[len] = '\0';
+    c->len -= len + 1;
+    memmove(c->buf, nl + 1, c->len);
+}
 
-            // Create student record
-            Student s;
-            s.id = nextStudentId();
-            strncpy(s.name, name, sizeof(s.name)-1); s.name[sizeof(s.name)-1]=0;
-            strncpy(s.department, department, sizeof(s.department)-1); s.department[sizeof(s.department)-1]=0;
-            s.semester = atoi(semStr);
-            s.cgpa = 0.00f;
-
-            if (addStudentRecord(&s) != 1) {
-                printf("❌ Failed to create student record for admission %d. Keeping request pending.\n", tid);
-                fprintf(tmp, "%s\n", line);
-                continue;
-            }
+static int daemonNextIsRead(const DaemonClient *c) {
+    return batchIsSnapshotCommand(c->buf) || batchIsReadCommand(c->buf);
+}
 
-            // Create login linked to this student id
-            int cr = createLogin(username, password, "student", s.id);
-            if (cr == 1) {
-                // mark admission as approved and set studentId in the admission record
-                // rebuild the line with status 'approved' and studentId
-                // Preserve original formatting of name/department etc.
-                fprintf(tmp, "%d,%s,%s,%d,%s,%s,%s,approved,%d\n",
-                        tid, s.name, s.department, s.semester, email, username, password, s.id);
-                printf("✅ Admission %d approved. Assigned Student ID: %d, username: %s\n", tid, s.id, username);
-                approvedCount++;
-            } else if (cr == 0) {
-                // username already exists in logins — rollback created student to avoid orphan
-                deleteStudentRecord(s.id);
-                printf("❌ Username '%s' already exists (race condition). Approval failed. Admission remains pending.\n", username);
-                // write back original pending entry
-                fprintf(tmp, "%s\n", line);
-            } else {
-                // file error — rollback student
-                deleteStudentRecord(s.id);
-                printf("❌ Error creating login file. Approval aborted for %d.\n", tid);
-                fprintf(tmp, "%s\n", line);
-            }
+/* Write requests of several clients, run back to back in one commit window: their
+   appends reach each file in a single write (and one fsync with --durability=batch)
+   before any of them is answered, and if that commit fails they are all answered
+   "err" and the tables are reloaded from the files. */
+static void daemonExecuteWrites(DaemonClient **group, int n, char *line) {
+    static HeldReplies held;    // only used under the exclusive table lock
+    pthread_rwlock_wrlock(&g_daemon.tableLock);
+    int locked = (lockTables(TBL_ALL, TBL_ALL) == 1);
+    int holding = locked && heldOpen(&held) == 0;
+    for (int i = 0; i < n; i++) {
+        daemonTakeLine(group[i], line);
+        if (!locked) {
+            fprintf(group[i]->out, "err\t-\ttables are locked\n");
+        } else if (holding) {
+            int r = runBatchCommand(line, held.fp);
+            heldAdd(&held, line, r, group[i]->out);
         } else {
-            // write back other lines unchanged
-            fprintf(tmp, "%s\n", line);
+            runBatchCommand(line, group[i]->out);
         }
     }
+    int committed = !locked || unlockTables(TBL_ALL) == 1;
+    if (!committed) {
+        fprintf(stderr, "❌ Commit failed: %s\n", strerror(errno));
+        discardUncommitted();
+    }
+    if (holding) heldSend(&held, committed);
+    daemonWarmCaches();
+    pthread_rwlock_unlock(&g_daemon.tableLock);
+}
 
-    fclose(fp);
-    fclose(tmp);
-
-    // replace admission file with updated temp
-    if (remove(ADMISSION_FILE) != 0) {
-        // if remove fails, still try rename (may overwrite)
+static void *daemonWorker(void *arg) {
+    statsUseBlock((OpStats *)arg);
+    char *line = malloc(DAEMON_LINE_MAX + 1);
+    if (!line) return NULL;
+    while (1) {
+        pthread_mutex_lock(&g_daemon.queueLock);
+        while (g_daemon.queueLen == 0 && !g_daemon.stopping) {
+            pthread_cond_wait(&g_daemon.queueReady, &g_daemon.queueLock);
+        }
+        if (g_daemon.queueLen == 0) {
+            pthread_mutex_unlock(&g_daemon.queueLock);
+            break;
+        }
+        // a write request takes the writes queued right behind it along (group commit)
+        DaemonClient *group[DAEMON_COMMIT_GROUP];
+        int n = 0;
+        do {
+            group[n++] = g_daemon.queue[g_daemon.queueHead];
+            g_daemon.queueHead = (g_daemon.queueHead + 1) % DAEMON_MAX_CLIENTS;
+            g_daemon.queueLen--;
+        } while (!daemonNextIsRead(group[0]) && n < DAEMON_COMMIT_GROUP && g_daemon.queueLen > 0 &&
+                 !daemonNextIsRead(g_daemon.queue[g_daemon.queueHead]));
+        pthread_mutex_unlock(&g_daemon.queueLock);
+
+        // run one request per client, then hand the clients back (the poll loop queues
+        // them again if more lines are waiting, so one busy client cannot hog a worker)
+        if (daemonNextIsRead(group[0])) {
+            daemonTakeLine(group[0], line);
+            daemonExecute(line, group[0]->out);
+        } else {
+            daemonExecuteWrites(group, n, line);
+        }
+        int lost = 0;
+        for (int i = 0; i < n; i++) {
+            fflush(group[i]->out);
+            if (write(g_daemon.donePipe[1], &group[i], sizeof(group[i])) != (ssize_t)sizeof(group[i])) lost = 1;
+        }
+        if (lost) break;
     }
-    if (rename(TEMP_FILE, ADMISSION_FILE) != 0) {
-        printf("❌ Error updating admission file.\n");
-        return -1;
+    free(line);
+    return NULL;
+}
+
+static DaemonClient *daemonClientNew(int fd) {
+    DaemonClient *c = calloc(1, sizeof(DaemonClient));
+    int outFd = dup(fd);
+    if (c && outFd >= 0) c->out = fdopen(outFd, "w");
+    if (!c || !c->out) {
+        if (outFd >= 0) close(outFd);
+        free(c);
+        return NULL;
     }
+    c->fd = fd;
+    return c;
+}
 
-    if (!found) return 0;
-    return (approvedCount > 0) ? 1 : 0; // 1 if at least one approval succeeded, 0 if found but not approved due to username conflict
+static void daemonClientFree(DaemonClient *c) {
+    fclose(c->out);
+    close(c->fd);
+    free(c->buf);
+    free(c);
 }
 
-/* ---------- User login (checks LOGINS_FILE) ---------- */
-/* outRole must be large enough (>=16). outStudentId pointer is required.
-   Returns 1 on success, 0 on failure */
-int loginUser(const char *username, const char *password, char *outRole, int *outStudentId) {
-    if (!username || !password || !outRole || !outStudentId) return 0;
-    FILE *fp = fopen(LOGINS_FILE, "r");
-    if (!fp) return 0;
-    char line[MAX_LINE];
-    int success = 0;
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        // format: username,password,role,studentId
-        char tmp[MAX_LINE];
-        strcpy(tmp, line);
-        char *u = strtok(tmp, ",");
-        char *p = strtok(NULL, ",");
-        char *r = strtok(NULL, ",");
-        char *sidStr = strtok(NULL, ",");
-        if (u && p && r && sidStr) {
-            if (strcmp(u, username) == 0 && strcmp(p, password) == 0) {
-                strncpy(outRole, r, 15);
-                outRole[15] = '\0';
-                *outStudentId = atoi(sidStr);
-                success = 1;
-                break;
+// queue the client if a whole request line is waiting
+static void daemonDispatch(DaemonClient *c) {
+    if (c->busy || !c->buf || !memchr(c->buf, '\n', c->len)) return;
+    c->busy = 1;
+    pthread_mutex_lock(&g_daemon.queueLock);
+    g_daemon.queue[(g_daemon.queueHead + g_daemon.queueLen) % DAEMON_MAX_CLIENTS] = c;
+    g_daemon.queueLen++;
+    pthread_cond_signal(&g_daemon.queueReady);
+    pthread_mutex_unlock(&g_daemon.queueLock);
+}
+
+// read what the client sent; returns 0 if it hung up or its line is too long
+static int daemonReceive(DaemonClient *c) {
+    if (c->cap - c->len < 4096) {
+        size_t cap = c->cap ? c->cap * 2 : 8192;
+        char *buf = realloc(c->buf, cap);
+        if (!buf) return 0;
+        c->buf = buf;
+        c->cap = cap;
+    }
+    ssize_t got = read(c->fd, c->buf + c->len, c->cap - c->len);
+    if (got <= 0) return 0;
+    c->len += (size_t)got;
+    if (c->len > DAEMON_LINE_MAX && !memchr(c->buf, '\n', c->len)) {
+        fprintf(c->out, "err\t-\trequest line too long\n");
+        fflush(c->out);
+        return 0;
+    }
+    return 1;
+}
+
+/* Serve clients on socketPath until SIGINT/SIGTERM. Returns the exit status. */
+int runDaemon(const char *socketPath, int workers) {
+    struct sockaddr_un addr;
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+        printf("❌ Socket path too long: %s\n", socketPath);
+        return 1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socketPath);
+
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe >= 0 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        close(probe);
+        printf("❌ A daemon is already listening on %s.\n", socketPath);
+        return 1;
+    }
+    if (probe >= 0) close(probe);
+    unlink(socketPath); // left behind by a daemon that did not shut down cleanly
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 || bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd, 64) != 0) {
+        printf("❌ Unable to listen on %s: %s\n", socketPath, strerror(errno));
+        if (listenFd >= 0) close(listenFd);
+        return 1;
+    }
+    chmod(socketPath, 0600); // the socket grants admin rights: owner only
+    if (pipe(g_daemon.donePipe) != 0) {
+        printf("❌ Unable to start the daemon: %s\n", strerror(errno));
+        close(listenFd);
+        unlink(socketPath);
+        return 1;
+    }
+
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+    // a steady stream of logins must not starve writers
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    pthread_rwlock_init(&g_daemon.tableLock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    pthread_mutex_init(&g_daemon.queueLock, NULL);
+    pthread_cond_init(&g_daemon.queueReady, NULL);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = daemonOnSignal; // no SA_RESTART: poll() returns on a signal
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);      // a client that hung up is a failed write, not a crash
+
+    g_quiet = 1;
+    g_compactInPlace = 1;
+    daemonWarmCaches();
+    pthread_t threads[DAEMON_MAX_WORKERS];
+    int started = 0;
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&threads[started], NULL, daemonWorker, statsNewBlock()) == 0) started++;
+    }
+    if (started == 0) {
+        printf("❌ Unable to start worker threads.\n");
+        close(listenFd);
+        unlink(socketPath);
+        return 1;
+    }
+    printf("✅ Serving %s with %d worker(s). Press Ctrl+C to stop.\n", socketPath, started);
+    fflush(stdout);
+
+    DaemonClient *clients[DAEMON_MAX_CLIENTS];
+    int nClients = 0;
+    struct pollfd pfd[DAEMON_MAX_CLIENTS + 2];
+    DaemonClient *owner[DAEMON_MAX_CLIENTS + 2];
+    while (!g_daemonStop) {
+        int np = 0;
+        pfd[np].fd = listenFd;
+        pfd[np].events = POLLIN;
+        owner[np++] = NULL;
+        pfd[np].fd = g_daemon.donePipe[0];
+        pfd[np].events = POLLIN;
+        owner[np++] = NULL;
+        for (int i = 0; i < nClients; i++) {
+            if (clients[i]->busy) continue; // its worker reports back through donePipe
+            pfd[np].fd = clients[i]->fd;
+            pfd[np].events = POLLIN;
+            owner[np++] = clients[i];
+        }
+        if (poll(pfd, (nfds_t)np, 1000) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pfd[1].revents & POLLIN) {
+            DaemonClient *done[64];
+            ssize_t got = read(g_daemon.donePipe[0], done, sizeof(done));
+            for (ssize_t k = 0; k < got / (ssize_t)sizeof(done[0]); k++) {
+                done[k]->busy = 0;
+                daemonDispatch(done[k]);
+            }
+        }
+        for (int i = 2; i < np; i++) {
+            if (!pfd[i].revents) continue;
+            DaemonClient *c = owner[i];
+            if (daemonReceive(c)) {
+                daemonDispatch(c);
+                continue;
+            }
+            for (int k = 0; k < nClients; k++) {
+                if (clients[k] == c) {
+                    clients[k] = clients[--nClients];
+                    break;
+                }
+            }
+            daemonClientFree(c);
+        }
+        if (pfd[0].revents & POLLIN) {
+            int fd = accept(listenFd, NULL, NULL);
+            DaemonClient *c = NULL;
+            if (fd >= 0 && nClients < DAEMON_MAX_CLIENTS) c = daemonClientNew(fd);
+            if (c) {
+                clients[nClients++] = c;
+            } else if (fd >= 0) {
+                static const char busyMsg[] = "err\t-\ttoo many clients\n";
+                if (write(fd, busyMsg, sizeof(busyMsg) - 1) < 0) { /* closing anyway */ }
+                close(fd);
             }
         }
     }
-    fclose(fp);
-    return success;
+
+    // let the workers finish what is queued, then shut down
+    pthread_mutex_lock(&g_daemon.queueLock);
+    g_daemon.stopping = 1;
+    pthread_cond_broadcast(&g_daemon.queueReady);
+    pthread_mutex_unlock(&g_daemon.queueLock);
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    for (int i = 0; i < nClients; i++) daemonClientFree(clients[i]);
+    close(listenFd);
+    unlink(socketPath);
+    close(g_daemon.donePipe[0]);
+    close(g_daemon.donePipe[1]);
+    finishStudentJournal();
+    g_quiet = 0;
+    printf("ℹ️  Daemon stopped.\n");
+    return 0;
 }
 
+#else
 
+int runDaemon(const char *socketPath, int workers) {
+    (void)socketPath;
+    (void)workers;
+    printf("❌ --daemon needs Unix domain sockets and is not available on Windows.\n");
+    return 1;
+}
 
+#endif
 
 
 
 
 // =========================
-// sms.c  — Part 3 of 4
-// Student CRUD and Marksheet functions
+// sms.c  — Benchmark
+// Synthetic data generator and timing suite for every storage operation:
+//   ./sms --bench [--students N] [--iterations N] [--dir DIR] [--out FILE]
+//                 [--baseline FILE] [--tolerance PCT] [--storage=csv|binary]
+// The data set is generated inside DIR (default bench_data) so real data files are
+// never touched. Results are JSON (p50/p99 in microseconds, ops/s); with --baseline
+// each operation is compared with a saved run and regressions are flagged.
 // =========================
 
-/* ---------- Add student record (students.txt) ---------- */
-/* Returns 1 on success, 0 if duplicate id, -1 on error */
-int addStudentRecord(const Student *s) {
-    if (!s) return -1;
-
-    // Check duplicate id first
-    Student tmp;
-    int f = findStudentById(s->id, &tmp);
-    if (f == 1) return 0; // duplicate
-    if (f == -1) {
-        // file read error, but proceed to try append
-    }
+#define BENCH_MAX_OPS 16
 
-    FILE *fp = fopen(STUDENTS_FILE, "a");
-    if (!fp) return -1;
+typedef struct {
+    const char *name;
+    int iterations;
+    double p50us, p99us, opsPerSec;
+} BenchResult;
 
-    // Format: id,name,department,semester,cgpa
-    fprintf(fp, "%d,%s,%s,%d,%.2f\n", s->id, s->name, s->department, s->semester, s->cgpa);
-    fclose(fp);
-    return 1;
+typedef struct {
+    int students;
+    int iterations;
+    const char *dir;
+    const char *outPath;
+    const char *baselinePath;
+    double tolerance;       // allowed slowdown, e.g. 0.20 = 20%
+} BenchConfig;
+
+static unsigned long long g_benchRng = 0x9E3779B97F4A7C15ULL;
+
+static unsigned int benchRand() {
+    g_benchRng ^= g_benchRng << 13;
+    g_benchRng ^= g_benchRng >> 7;
+    g_benchRng ^= g_benchRng << 17;
+    return (unsigned int)(g_benchRng >> 11);
 }
 
-/* ---------- Find student by id ---------- */
-/* Returns 1 if found and fills out, 0 if not found, -1 on file error */
-int findStudentById(int id, Student *out) {
-    FILE *fp = fopen(STUDENTS_FILE, "r");
-    if (!fp) return -1;
-    char line[MAX_LINE];
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        Student s;
-        // parse carefully
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-        char *tok = strtok(copy, ",");
-        if (!tok) continue;
-        s.id = atoi(tok);
-        char *name = strtok(NULL, ",");
-        char *dept = strtok(NULL, ",");
-        char *semStr = strtok(NULL, ",");
-        char *cgpaStr = strtok(NULL, ",");
-        if (!name || !dept || !semStr || !cgpaStr) continue;
-        strncpy(s.name, name, sizeof(s.name)-1); s.name[sizeof(s.name)-1]=0;
-        strncpy(s.department, dept, sizeof(s.department)-1); s.department[sizeof(s.department)-1]=0;
-        s.semester = atoi(semStr);
-        s.cgpa = (float)atof(cgpaStr);
-
-        if (s.id == id) {
-            if (out) *out = s;
-            fclose(fp);
-            return 1;
-        }
-    }
-    fclose(fp);
-    return 0;
+static const char *g_benchFirst[] = { "Abdul", "Ayesha", "Rahim", "Karim", "Nusrat", "Tanvir", "Farhana", "Sabbir",
+    "Mehedi", "Sumaiya", "Rakib", "Jannat", "Imran", "Tasnim", "Shakil", "Nadia", "Arif", "Mim", "Hasan", "Lamia" };
+static const char *g_benchLast[] = { "Rahman", "Hossain", "Islam", "Ahmed", "Khan", "Chowdhury", "Akter", "Sarker",
+    "Uddin", "Begum", "Mia", "Alam", "Karim", "Haque", "Sultana", "Roy", "Das", "Saha", "Talukder", "Mondal" };
+static const char *g_benchDepts[] = { "CSE", "EEE", "BBA", "English", "Law", "Pharmacy", "Civil", "Textile",
+    "Architecture", "Economics", "Journalism", "Mathematics", "Physics", "Chemistry", "Statistics",
+    "Nutrition", "Tourism", "Software Eng", "Multimedia", "Agriculture" };
+static const char *g_benchSubjects[] = { "Calculus", "Physics I", "Programming", "Data Structures", "Algorithms",
+    "Discrete Math", "Databases", "Networks", "Operating Systems", "Statistics", "English", "Economics" };
+#define BENCH_COUNT(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static int benchChangeDir(const char *dir) {
+#ifdef _WIN32
+    return _chdir(dir);
+#else
+    return chdir(dir);
+#endif
 }
 
-/* ---------- Update student record ---------- */
-/* Returns 1 on success, 0 if not found, -1 on error */
-int updateStudentRecord(int id, const Student *newData) {
-    FILE *fp = fopen(STUDENTS_FILE, "r");
-    if (!fp) return -1;
-    FILE *tmp = fopen(TEMP_FILE, "w");
-    if (!tmp) { fclose(fp); return -1; }
-
-    char line[MAX_LINE];
-    int found = 0;
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        // parse id
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-        char *tok = strtok(copy, ",");
-        if (!tok) continue;
-        int curId = atoi(tok);
-        if (curId == id) {
-            // write updated data
-            fprintf(tmp, "%d,%s,%s,%d,%.2f\n",
-                    id,
-                    newData->name,
-                    newData->department,
-                    newData->semester,
-                    newData->cgpa);
-            found = 1;
-        } else {
-            // write original line back
-            fprintf(tmp, "%s\n", line);
+/* Write students.txt, logins.txt, admission_requests.txt and marksheets.txt for n
+   students (ids 120..), one login each, n/10 pending admissions and two marksheets
+   per student. Returns 0 on success, -1 on error. */
+int generateDataset(int n) {
+    static const char *stale[] = { STUDENTS_JOURNAL, STUDENTS_JOURNAL_OLD, STUDENTS_BIN_FILE, SEQUENCE_FILE,
+                                   DELETE_COMMIT_FILE, IMPORT_REJECTS_FILE };
+    for (int i = 0; i < BENCH_COUNT(stale); i++) remove(stale[i]);
+    FILE *st = fopen(STUDENTS_FILE, "w");
+    FILE *lg = fopen(LOGINS_FILE, "w");
+    FILE *ad = fopen(ADMISSION_FILE, "w");
+    FILE *mk = fopen(MARKSHEET_FILE, "w");
+    if (!st || !lg || !ad || !mk) {
+        if (st) fclose(st);
+        if (lg) fclose(lg);
+        if (ad) fclose(ad);
+        if (mk) fclose(mk);
+        return -1;
+    }
+    static char bufs[4][1 << 20];
+    setvbuf(st, bufs[0], _IOFBF, sizeof(bufs[0]));
+    setvbuf(lg, bufs[1], _IOFBF, sizeof(bufs[1]));
+    setvbuf(ad, bufs[2], _IOFBF, sizeof(bufs[2]));
+    setvbuf(mk, bufs[3], _IOFBF, sizeof(bufs[3]));
+
+    fprintf(lg, "admin,admin123,admin,0\n");
+    for (int i = 0; i < n; i++) {
+        int id = FIRST_STUDENT_ID + i;
+        const char *first = g_benchFirst[benchRand() % BENCH_COUNT(g_benchFirst)];
+        const char *last = g_benchLast[benchRand() % BENCH_COUNT(g_benchLast)];
+        const char *dept = g_benchDepts[benchRand() % BENCH_COUNT(g_benchDepts)];
+        int sem = 1 + (int)(benchRand() % 12);
+        char cgpa[NUM_BUF];
+        formatHundredths((int)(benchRand() % 401), cgpa);
+        fprintf(st, "%d,%s %s,%s,%d,%s\n", id, first, last, dept, sem, cgpa);
+        fprintf(lg, "user%d,pw%d,student,%d\n", id, id, id);
+        for (int m = 0; m < 2; m++) {
+            fprintf(mk, "%d,%s%d", id, (m == 0) ? "Spring" : "Fall", 2024);
+            for (int k = 0; k < 5; k++) {
+                int score = 200 + (int)(benchRand() % 201);
+                char text[NUM_BUF];
+                formatHundredths(score, text);
+                fprintf(mk, ",%s,%s,%s", g_benchSubjects[(k * 3 + m) % BENCH_COUNT(g_benchSubjects)],
+                        text, score >= 375 ? "A" : score >= 325 ? "B" : score >= 275 ? "C" : "D");
+            }
+            fprintf(mk, "\n");
         }
     }
+    int pending = n / 10 > 0 ? n / 10 : 1;
+    for (int i = 0; i < pending; i++) {
+        const char *first = g_benchFirst[benchRand() % BENCH_COUNT(g_benchFirst)];
+        const char *last = g_benchLast[benchRand() % BENCH_COUNT(g_benchLast)];
+        fprintf(ad, "%d,%s %s,%s,%d,applicant%d@diu.edu.bd,applicant%d,pw,pending,0\n", 1001 + i, first, last,
+                g_benchDepts[benchRand() % BENCH_COUNT(g_benchDepts)], 1 + (int)(benchRand() % 2), i, i);
+    }
+    int bad = 0;
+    if (fclose(st) != 0) bad = 1;
+    if (fclose(lg) != 0) bad = 1;
+    if (fclose(ad) != 0) bad = 1;
+    if (fclose(mk) != 0) bad = 1;
+    return bad ? -1 : 0;
+}
 
-    fclose(fp);
-    fclose(tmp);
+// stdout is pointed at the null device while timed operations print their screens
+static int g_benchSavedStdout = -1;
 
-    if (!found) {
-        remove(TEMP_FILE);
-        return 0;
-    }
-    remove(STUDENTS_FILE);
-    rename(TEMP_FILE, STUDENTS_FILE);
-    return 1;
+static void benchSilence() {
+    fflush(stdout);
+#ifdef _WIN32
+    int nul = _open("NUL", _O_WRONLY);
+    g_benchSavedStdout = _dup(1);
+    _dup2(nul, 1);
+    _close(nul);
+#else
+    int nul = open("/dev/null", O_WRONLY);
+    g_benchSavedStdout = dup(1);
+    dup2(nul, 1);
+    close(nul);
+#endif
 }
 
-/* ---------- Delete student record ---------- */
-/* Returns 1 on success, 0 if not found, -1 on error */
-int deleteStudentRecord(int id) {
-    FILE *fp = fopen(STUDENTS_FILE, "r");
-    if (!fp) return -1;
-    FILE *tmp = fopen(TEMP_FILE, "w");
-    if (!tmp) { fclose(fp); return -1; }
+static void benchRestore() {
+    fflush(stdout);
+#ifdef _WIN32
+    _dup2(g_benchSavedStdout, 1);
+    _close(g_benchSavedStdout);
+#else
+    dup2(g_benchSavedStdout, 1);
+    close(g_benchSavedStdout);
+#endif
+}
 
-    char line[MAX_LINE];
-    int found = 0;
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        // parse id
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-        char *tok = strtok(copy, ",");
-        if (!tok) continue;
-        int curId = atoi(tok);
-        if (curId == id) {
-            found = 1;
-            // skip writing this line (delete)
-        } else {
-            fprintf(tmp, "%s\n", line);
-        }
-    }
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
 
-    fclose(fp);
-    fclose(tmp);
+static void benchSummarize(BenchResult *r, double *samples, int n, double total) {
+    qsort(samples, (size_t)n, sizeof(double), compareDoubles);
+    r->iterations = n;
+    r->p50us = samples[n / 2] * 1e6;
+    r->p99us = samples[(int)((n - 1) * 0.99)] * 1e6;
+    r->opsPerSec = total > 0 ? n / total : 0.0;
+}
 
-    if (!found) {
-        remove(TEMP_FILE);
-        return 0;
+// time `iterations` calls of one operation; op(i) runs call number i
+static void benchRun(BenchResult *r, const char *name, int iterations, void (*op)(int)) {
+    double *samples = malloc((size_t)iterations * sizeof(double));
+    r->name = name;
+    if (!samples) {
+        r->iterations = 0;
+        return;
     }
-    remove(STUDENTS_FILE);
-    rename(TEMP_FILE, STUDENTS_FILE);
-
-    // Also remove marksheets for this student (optional cleanup)
-    FILE *mfp = fopen(MARKSHEET_FILE, "r");
-    if (mfp) {
-        FILE *mtemp = fopen(TEMP_FILE, "w");
-        if (mtemp) {
-            while (fgets(line, sizeof(line), mfp)) {
-                trim(line);
-                if (line[0] == '\0') continue;
-                char copy2[MAX_LINE];
-                strcpy(copy2, line);
-                char *tok2 = strtok(copy2, ",");
-                if (!tok2) continue;
-                int mid = atoi(tok2);
-                if (mid == id) {
-                    // skip marksheet for deleted student
-                    continue;
-                } else {
-                    fprintf(mtemp, "%s\n", line);
-                }
-            }
-            fclose(mtemp);
-            remove(MARKSHEET_FILE);
-            rename(TEMP_FILE, MARKSHEET_FILE);
-        }
-        fclose(mfp);
-    }
-
-    // Also remove login entries linked to this studentId (LOGINS_FILE format: username,password,role,studentId)
-    FILE *lfp = fopen(LOGINS_FILE, "r");
-    if (lfp) {
-        FILE *ltmp = fopen(TEMP_FILE, "w");
-        if (ltmp) {
-            while (fgets(line, sizeof(line), lfp)) {
-                trim(line);
-                if (line[0] == '\0') continue;
-                char copy3[MAX_LINE];
-                strcpy(copy3, line);
-                char *toku = strtok(copy3, ",");
-                char *tokp = strtok(NULL, ",");
-                char *tokr = strtok(NULL, ",");
-                char *toksid = strtok(NULL, ",");
-                if (!toksid) {
-                    // malformed - keep it to avoid accidental deletion
-                    fprintf(ltmp, "%s\n", line);
-                    continue;
-                }
-                int lid = atoi(toksid);
-                if (lid == id) {
-                    // skip this login (delete)
-                    continue;
-                } else {
-                    fprintf(ltmp, "%s\n", line);
-                }
-            }
-            fclose(ltmp);
-            remove(LOGINS_FILE);
-            rename(TEMP_FILE, LOGINS_FILE);
-        }
-        fclose(lfp);
+    double total = 0;
+    benchSilence();
+    for (int i = 0; i < iterations; i++) {
+        double t0 = nowSeconds();
+        op(i);
+        samples[i] = nowSeconds() - t0;
+        total += samples[i];
     }
+    benchRestore();
+    benchSummarize(r, samples, iterations, total);
+    free(samples);
+}
 
-    return 1;
+static int g_benchStudents = 0;
+
+static int benchRandomId() {
+    return FIRST_STUDENT_ID + (int)(benchRand() % (unsigned int)g_benchStudents);
 }
 
-/* ---------- List all students ---------- */
-void listAllStudents() {
-    FILE *fp = fopen(STUDENTS_FILE, "r");
-    if (!fp) {
-        printf("❌ No student records found!\n");
-        return;
-    }
-    printf("\n===== All Student Records =====\n");
-    printf("%-6s  %-25s  %-15s  %-8s  %-6s\n", "ID", "Name", "Department", "Semester", "CGPA");
-    printf("----------------------------------------------------------------------\n");
-    char line[MAX_LINE];
-    int count = 0;
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        Student s;
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-        char *tok = strtok(copy, ",");
-        if (!tok) continue;
-        s.id = atoi(tok);
-        char *name = strtok(NULL, ",");
-        char *dept = strtok(NULL, ",");
-        char *semStr = strtok(NULL, ",");
-        char *cgpaStr = strtok(NULL, ",");
-        if (!name || !dept || !semStr || !cgpaStr) continue;
-        strncpy(s.name, name, sizeof(s.name)-1); s.name[sizeof(s.name)-1]=0;
-        strncpy(s.department, dept, sizeof(s.department)-1); s.department[sizeof(s.department)-1]=0;
-        s.semester = atoi(semStr);
-        s.cgpa = (float)atof(cgpaStr);
-
-        printf("%-6d  %-25s  %-15s  %-8d  %-6.2f\n", s.id, s.name, s.department, s.semester, s.cgpa);
-        count++;
-    }
-    if (count == 0) printf("❌ No student records to display!\n");
-    fclose(fp);
+static void benchFind(int i) {
+    Student s;
+    (void)i;
+    findStudentById(benchRandomId(), &s);
 }
 
-/* ---------- Add marksheet for a student ---------- */
-/* Format per line: id,semesterLabel,subject,score,grade,subject,score,grade,... */
-/* Returns 1 on success, 0 if student not found, -1 on file error */
-int addMarksheet(int studentId) {
-    // verify student exists
+static void benchUpdate(int i) {
     Student s;
-    int found = findStudentById(studentId, &s);
-    if (found != 1) return 0;
+    (void)i;
+    int id = benchRandomId();
+    if (findStudentById(id, &s) == 1) {
+        s.cgpa = (int)(benchRand() % 401);
+        updateStudentRecord(id, &s);
+    }
+}
 
-    FILE *fp = fopen(MARKSHEET_FILE, "a");
-    if (!fp) return -1;
+static void benchUsernameExists(int i) {
+    char name[MAX_USERNAME];
+    // half existing, half free names
+    if (i % 2) snprintf(name, sizeof(name), "user%d", benchRandomId());
+    else snprintf(name, sizeof(name), "free%u", benchRand());
+    usernameExists(name);
+}
 
-    char semesterLabel[80];
-    getStringInput("Enter Semester label (e.g. Spring2025): ", semesterLabel, sizeof(semesterLabel));
+static void benchLogin(int i) {
+    char user[MAX_USERNAME], pass[MAX_PASS], role[16];
+    int sid, id = benchRandomId();
+    (void)i;
+    snprintf(user, sizeof(user), "user%d", id);
+    snprintf(pass, sizeof(pass), "pw%d", id);
+    loginUser(user, pass, role, &sid);
+}
+
+static void benchApprove(int i) {
+    approveAdmissionById(1001 + i);
+}
 
-    // start line with id and semester
-    fprintf(fp, "%d,%s", studentId, semesterLabel);
+static void benchViewMarksheet(int i) {
+    (void)i;
+    viewMarksheetFor(benchRandomId());
+}
 
-    while (1) {
-        printf("\n1. Add Subject\n2. Done\n");
-        int ch = getIntInput("Enter choice: ");
-        if (ch == 2) break;
-        if (ch != 1) {
-            printf("❌ Invalid choice. Try again.\n");
-            continue;
-        }
-        char subject[MAX_SUBJECT];
-        char grade[8];
-        float score;
-        getStringInput("Enter Subject Name: ", subject, sizeof(subject));
-        score = getFloatInput("Enter Subject CGPA (numeric): ");
-        getStringInput("Enter Grade (A/B/C/D/F): ", grade, sizeof(grade));
+static void benchList(int i) {
+    (void)i;
+    listAllStudents();
+}
 
-        // append triplet
-        fprintf(fp, ",%s,%.2f,%s", subject, score, grade);
-    }
+static void benchListPage(int i) {
+    (void)i;
+    ListFilter f = { g_benchDepts[benchRand() % BENCH_COUNT(g_benchDepts)], 1 + (int)(benchRand() % 12), NULL };
+    Student *list = NULL;
+    ListPage page;
+    listStudentsPage(&f, (int)(benchRand() % (unsigned int)g_benchStudents), LIST_PAGE_ROWS, 0, &list, &page);
+    free(list);
+}
 
-    fprintf(fp, "\n");
-    fclose(fp);
-    return 1;
+static void benchAnalytics(int i) {
+    (void)i;
+    AnalyticsReport rep;
+    if (studentAnalytics(&rep) == 1) free(rep.depts);
 }
 
-/* ---------- View marksheet(s) for a student ---------- */
-/* If studentId <=0, interactive prompt is used; otherwise prints all marksheets for that id */
-/* Returns number of marksheets found (>0) or 0 if none, -1 on file error */
-int viewMarksheetFor(int studentId) {
-    if (studentId <= 0) {
-        studentId = getIntInput("Enter Student ID to view marksheet: ");
+static void benchTop(int i) {
+    (void)i;
+    Student *list = NULL;
+    topStudentsByCgpa(NULL, 100, &list);
+    free(list);
+}
+
+static void benchSearch(int i) {
+    (void)i;
+    char query[64];
+    snprintf(query, sizeof(query), "%s %s", g_benchFirst[benchRand() % BENCH_COUNT(g_benchFirst)],
+             g_benchLast[benchRand() % BENCH_COUNT(g_benchLast)]);
+    Student *list = NULL;
+    int total;
+    searchStudentsByName(query, 0, 20, &list, &total);
+    free(list);
+}
+
+// a full pass over the snapshot with a department + semester filter (the filtered listing's inner loop)
+static int g_benchScanned = 0;
+
+static void benchScan(int i) {
+    (void)i;
+    ListFilter f = { g_benchDepts[benchRand() % BENCH_COUNT(g_benchDepts)], 1 + (int)(benchRand() % 12), NULL };
+    const StudentVersion *v = studentSnapshotPin();
+    if (v) {
+        RowFilter rf = rowFilterFor(v, &f);
+        for (int r = studentScan(v, &rf, 0, 1); r >= 0; r = studentScan(v, &rf, r + 1, 1)) g_benchScanned++;
     }
+    studentSnapshotRelease();
+}
 
-    FILE *fp = fopen(MARKSHEET_FILE, "r");
-    if (!fp) return -1;
+/* Resident bytes per live student: the rows (allocated capacity) with their live flags,
+   the name arena bytes handed out so far and the department dictionary. The id hash
+   index is left out, it does not depend on what a row holds. */
+static void benchMemory(TextBuf *json) {
+    int live = g_students.liveCount > 0 ? g_students.liveCount : 1;
+    double rows = (double)g_students.capacity * (sizeof(StudentRec) + 1);
+    double names = g_nameArena ? (double)g_nameArena->used : 0.0;
+    double depts = (double)((g_depts.count + DEPT_PAGE_NAMES - 1) / DEPT_PAGE_NAMES) * DEPT_PAGE_NAMES * MAX_DEPT +
+                   (double)g_depts.slotCap * sizeof(int);
+    textBufPrintf(json, "  \"memory\": { \"row_bytes\": %d, \"student_struct_bytes\": %d, \"name_bytes_per_student\": %.1f, "
+                  "\"departments\": %d, \"bytes_per_student\": %.1f },\n",
+                  (int)sizeof(StudentRec), (int)sizeof(Student), names / live, g_depts.count, (rows + names + depts) / live);
+}
 
-    char line[MAX_LINE];
-    int foundAny = 0;
+static int g_benchDeleteNext = 0;
 
-    // To display student basic info:
-    Student s;
-    int stFound = findStudentById(studentId, &s);
+static void benchDelete(int i) {
+    (void)i;
+    // walk down from the highest id so the other operations keep hitting live rows
+    deleteStudentRecord(FIRST_STUDENT_ID + g_benchStudents - 1 - g_benchDeleteNext++);
+}
 
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        // make a copy for strtok
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-        char *tok = strtok(copy, ",");
-        if (!tok) continue;
-        int id = atoi(tok);
-        if (id != studentId) continue;
-
-        foundAny = 1;
-        // next token is semester label
-        char *semester = strtok(NULL, ",");
-        if (!semester) semester = "Unknown";
-
-        // print nice header (A4-like)
-        printf("\n****************************************************\n");
-        printf("            OFFICIAL MARKSHEET REPORT\n");
-        printf("      DAFFODIL INTERNATIONAL UNIVERSITY\n");
-        printf("****************************************************\n");
-        if (stFound == 1) {
-            printf("Student ID   : %d\n", s.id);
-            printf("Student Name : %s\n", s.name);
-            printf("Department   : %s\n", s.department);
-        } else {
-            printf("Student ID   : %d\n", id);
-            printf("Student Name : (Not found in students.txt)\n");
-        }
-        printf("Semester     : %s\n", semester);
-        printf("----------------------------------------------------\n");
-        printf("%-4s  %-30s  %-6s  %-6s\n", "No.", "Subject", "CGPA", "Grade");
-        printf("----------------------------------------------------\n");
+// find "name": { ... "key": value in a baseline written by this benchmark
+static int benchBaselineValue(const char *json, const char *name, const char *key, double *out) {
+    char pat[96];
+    snprintf(pat, sizeof(pat), "\"%s\": {", name);
+    const char *p = strstr(json, pat);
+    if (!p) return 0;
+    const char *end = strchr(p, '}');
+    snprintf(pat, sizeof(pat), "\"%s\": ", key);
+    const char *k = strstr(p, pat);
+    if (!k || (end && k > end)) return 0;
+    return sscanf(k + strlen(pat), "%lf", out) == 1;
+}
 
-        int count = 0;
-        float total = 0.0f;
-        while (1) {
-            char *sub = strtok(NULL, ",");
-            if (!sub) break;
-            char *scoreStr = strtok(NULL, ",");
-            char *grade = strtok(NULL, ",");
-            if (!scoreStr || !grade) break;
-            float score = (float)atof(scoreStr);
-            printf("%-4d  %-30s  %-6.2f  %-6s\n", ++count, sub, score, grade);
-            total += score;
-        }
-        float avg = (count > 0) ? (total / (float)count) : 0.0f;
-        printf("----------------------------------------------------\n");
-        printf(" Semester Average CGPA: %.2f\n", avg);
-        printf("****************************************************\n");
-        // continue to display other marksheets (if multiple)
+static char *benchReadFile(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *text = malloc((size_t)size + 1);
+    if (text && fread(text, 1, (size_t)size, fp) != (size_t)size) {
+        free(text);
+        text = NULL;
     }
-
+    if (text) text[size] = '\0';
     fclose(fp);
-    if (!foundAny) {
-        printf("❌ No marksheet found for Student ID %d.\n", studentId);
-        return 0;
-    }
-    return 1;
+    return text;
 }
 
+/* Generate the data set, time every operation and print JSON.
+   Returns 0, 1 on error, or 2 if a regression against the baseline was found. */
+int runBenchmark(const BenchConfig *cfg) {
+    char *baseline = NULL;
+    if (cfg->baselinePath) {
+        baseline = benchReadFile(cfg->baselinePath);
+        if (!baseline) {
+            fprintf(stderr, "❌ Unable to read baseline %s.\n", cfg->baselinePath);
+            return 1;
+        }
+    }
+    // opened here, like the baseline: both paths are relative to where we were started
+    FILE *out = NULL;
+    if (cfg->outPath && !(out = fopen(cfg->outPath, "w"))) {
+        fprintf(stderr, "❌ Unable to write %s.\n", cfg->outPath);
+        free(baseline);
+        return 1;
+    }
+    if (makeDir(cfg->dir) != 0 || benchChangeDir(cfg->dir) != 0) {
+        fprintf(stderr, "❌ Unable to use benchmark directory %s.\n", cfg->dir);
+        if (out) fclose(out);
+        free(baseline);
+        return 1;
+    }
+    g_quiet = 1;
+    g_benchStudents = cfg->students;
+
+    double t0 = nowSeconds();
+    if (generateDataset(cfg->students) != 0) {
+        fprintf(stderr, "❌ Unable to generate the data set.\n");
+        if (out) fclose(out);
+        free(baseline);
+        return 1;
+    }
+    double genSeconds = nowSeconds() - t0;
+    t0 = nowSeconds(); // the binary conversion loads the table, so it counts as load time
+    if (g_storage == STORAGE_BINARY && convertStudentsToBinary() < 0) {
+        fprintf(stderr, "❌ Unable to convert the data set to %s.\n", STUDENTS_BIN_FILE);
+        if (out) fclose(out);
+        free(baseline);
+        return 1;
+    }
+    if (loadStudentTable() != 1) {
+        if (out) fclose(out);
+        free(baseline);
+        return 1;
+    }
+    double loadSeconds = nowSeconds() - t0;
+
+    int cheap = cfg->iterations;
+    int costly = cfg->iterations / 50 > 3 ? cfg->iterations / 50 : 3; // full-file rewrites and scans
+    int pending = cfg->students / 10 > 0 ? cfg->students / 10 : 1;
+    BenchResult res[BENCH_MAX_OPS];
+    int n = 0;
+    benchRun(&res[n++], "findStudentById", cheap, benchFind);
+    benchRun(&res[n++], "usernameExists", cheap, benchUsernameExists);
+    benchRun(&res[n++], "viewMarksheetFor", cheap, benchViewMarksheet);
+    benchRun(&res[n++], "updateStudentRecord", cheap, benchUpdate);
+    benchRun(&res[n++], "loginUser", costly, benchLogin);
+    benchRun(&res[n++], "approveAdmissionById", costly < pending ? costly : pending, benchApprove);
+    benchRun(&res[n++], "listAllStudents", 3, benchList);
+    benchRun(&res[n++], "listStudentsPage", cheap, benchListPage);
+    benchRun(&res[n++], "scanStudents", costly, benchScan);
+    benchRun(&res[n++], "studentAnalytics", costly, benchAnalytics);
+    benchRun(&res[n++], "topStudentsByCgpa", cheap, benchTop);
+    benchRun(&res[n++], "searchStudentsByName", cheap, benchSearch);
+    benchRun(&res[n++], "deleteStudentRecord", costly < cfg->students ? costly : cfg->students, benchDelete);
+
+    TextBuf json = {0};
+    textBufPrintf(&json, "{\n  \"students\": %d,\n  \"storage\": \"%s\",\n", cfg->students,
+                  g_storage == STORAGE_BINARY ? "binary" : "csv");
+    textBufPrintf(&json, "  \"generate_seconds\": %.3f,\n  \"load_seconds\": %.3f,\n", genSeconds, loadSeconds);
+    benchMemory(&json);
+    textBufPrintf(&json, "  \"ops\": {\n");
+    for (int i = 0; i < n; i++) {
+        textBufPrintf(&json, "    \"%s\": { \"iterations\": %d, \"p50_us\": %.2f, \"p99_us\": %.2f, \"ops_per_sec\": %.1f }%s\n",
+                      res[i].name, res[i].iterations, res[i].p50us, res[i].p99us, res[i].opsPerSec, i + 1 < n ? "," : "");
+    }
+    textBufPrintf(&json, "  }");
+    int regressions = 0;
+    if (baseline) {
+        textBufPrintf(&json, ",\n  \"baseline\": \"%s\",\n  \"tolerance_pct\": %.0f,\n  \"regressions\": [",
+                      cfg->baselinePath, cfg->tolerance * 100);
+        for (int i = 0; i < n; i++) {
+            double p50, p99;
+            if (!benchBaselineValue(baseline, res[i].name, "p50_us", &p50) ||
+                !benchBaselineValue(baseline, res[i].name, "p99_us", &p99)) continue;
+            // tiny latencies are dominated by timer noise; ignore changes below 1us
+            int slow50 = res[i].p50us > p50 * (1 + cfg->tolerance) && res[i].p50us - p50 > 1.0;
+            int slow99 = res[i].p99us > p99 * (1 + cfg->tolerance) && res[i].p99us - p99 > 1.0;
+            if (!slow50 && !slow99) continue;
+            textBufPrintf(&json, "%s\n    { \"op\": \"%s\", \"p50_us\": %.2f, \"baseline_p50_us\": %.2f, \"p99_us\": %.2f, \"baseline_p99_us\": %.2f }",
+                          regressions ? "," : "", res[i].name, res[i].p50us, p50, res[i].p99us, p99);
+            regressions++;
+        }
+        textBufPrintf(&json, "%s]", regressions ? "\n  " : "");
+    }
+    textBufPrintf(&json, "\n}\n");
+
+    finishStudentJournal();
+    fputs(json.data, stdout);
+    if (out) {
+        int written = (fputs(json.data, out) >= 0);
+        if (fclose(out) != 0 || !written) fprintf(stderr, "❌ Unable to write %s.\n", cfg->outPath);
+    }
+    if (regressions) fprintf(stderr, "❌ %d operation(s) regressed against %s.\n", regressions, cfg->baselinePath);
+    textBufFree(&json);
+    free(baseline);
+    return regressions ? 2 : 0;
+}
 
 
 
@@ -1074,51 +8370,40 @@ int viewMarksheetFor(int studentId) {
 // =========================
 
 /* ---------- List pending (and approved) admission requests ---------- */
-void listPendingAdmissions() {
-    FILE *fp = fopen(ADMISSION_FILE, "r");
-    if (!fp) {
-        printf("ℹ️  No admission requests found.\n");
-        return;
-    }
-
+static void printAdmissionListHeader() {
     printf("\n===== Admission Requests =====\n");
     printf("%-8s  %-30s  %-15s  %-6s  %-25s  %-15s  %-8s  %-8s\n",
            "TempID", "Name", "Department", "Sem", "Email", "Username", "Status", "StudID");
     printf("---------------------------------------------------------------------------------------------------------------\n");
+}
 
-    char line[MAX_LINE];
-    int count = 0;
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        // tempId,name,department,semester,email,username,password,status,studentId
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-
-        // Safe tokenization (fields are assumed not to contain commas)
-        char *tok = strtok(copy, ",");
-        if (!tok) continue;
-        char *tempId = tok;
-        char *name = strtok(NULL, ",");
-        char *dept = strtok(NULL, ",");
-        char *sem = strtok(NULL, ",");
-        char *email = strtok(NULL, ",");
-        char *username = strtok(NULL, ",");
-        char *password = strtok(NULL, ","); // not printed
-        char *status = strtok(NULL, ",");
-        char *studId = strtok(NULL, ",");
-
-        if (!name || !dept || !sem || !email || !username) continue;
-        if (!status) status = "pending";
-        if (!studId) studId = "0";
-
-        printf("%-8s  %-30s  %-15s  %-6s  %-25s  %-15s  %-8s  %-8s\n",
-               tempId, name, dept, sem, email, username, status, studId);
-        count++;
-    }
-
-    if (count == 0) printf("ℹ️  No admission requests to display.\n");
-    fclose(fp);
+static void listOutAdmission(TextBuf *b, const AdmissionInfo *a) {
+    textBufPrintf(b, "%-8d  %-30s  %-15s  %-6d  %-25s  %-15s  %-8s  %-8d\n",
+                  a->tempId, a->name, a->department, a->semester, a->email, a->username, a->status, a->studentId);
+    if (b->len >= LIST_FLUSH_BYTES) listOutFlush(b);
+}
+
+static void listPendingAdmissionsImpl() {
+    AdmissionInfo *list = NULL;
+    int n = listAdmissions(0, NULL, &list);
+    if (n < 0 || (n == 0 && !g_remote && !fileExists(ADMISSION_FILE))) {
+        printf("ℹ️  No admission requests found.\n");
+        return;
+    }
+
+    printAdmissionListHeader();
+    TextBuf buf = {0};
+    for (int i = 0; i < n; i++) listOutAdmission(&buf, &list[i]);
+    listOutEnd(&buf);
+
+    if (n == 0) printf("ℹ️  No admission requests to display.\n");
+    free(list);
+}
+
+void listPendingAdmissions() {
+    StatScope sc = statsBegin(STAT_LIST_PENDING);
+    listPendingAdmissionsImpl();
+    statsEnd(sc);
 }
 
 /* ---------- Admin interactive helpers ---------- */
@@ -1128,10 +8413,14 @@ void adminAddStudentInteractive() {
 
     Student s;
     s.id = nextStudentId();
+    if (s.id < 0) {
+        printf("❌ Unable to allocate a student ID (%s not writable).\n", SEQUENCE_FILE);
+        return;
+    }
     getStringInput("Enter Full Name: ", s.name, sizeof(s.name));
     getStringInput("Enter Department: ", s.department, sizeof(s.department));
     s.semester = getIntInput("Enter Semester (int): ");
-    s.cgpa = getFloatInput("Enter CGPA (numeric): ");
+    s.cgpa = getHundredthsInput("Enter CGPA (numeric): ");
     int r = addStudentRecord(&s);
     if (r == 1) {
         printf("✅ Student added with ID %d\n", s.id);
@@ -1186,7 +8475,9 @@ void adminViewStudentInteractive() {
         printf("Name      : %s\n", s.name);
         printf("Department: %s\n", s.department);
         printf("Semester  : %d\n", s.semester);
-        printf("CGPA      : %.2f\n", s.cgpa);
+        char cgpa[NUM_BUF];
+        formatHundredths(s.cgpa, cgpa);
+        printf("CGPA      : %s\n", cgpa);
     } else if (r == 0) {
         printf("❌ Student ID %d not found.\n", id);
     } else {
@@ -1217,8 +8508,9 @@ void adminUpdateStudentInteractive() {
     printf("Semester [%d]: ", s.semester);
     if (safeFgets(tmp, sizeof(tmp)) && tmp[0] != '\0') s.semester = atoi(tmp);
 
-    printf("CGPA [%.2f]: ", s.cgpa);
-    if (safeFgets(tmp, sizeof(tmp)) && tmp[0] != '\0') s.cgpa = (float)atof(tmp);
+    formatHundredths(s.cgpa, tmp);
+    printf("CGPA [%s]: ", tmp);
+    if (safeFgets(tmp, sizeof(tmp)) && tmp[0] != '\0') s.cgpa = hundredthsOf(tmp);
 
     int upr = updateStudentRecord(id, &s);
     if (upr == 1) printf("✅ Student ID %d updated.\n", id);
@@ -1236,10 +8528,98 @@ void adminDeleteStudentInteractive() {
     else printf("❌ Error deleting student.\n");
 }
 
+/* ---------- Paged listings (admin) ---------- */
+// after a page: 1 = next page, -1 = previous page, 0 = done
+static int askListPageStep(const ListPage *page) {
+    if (page->next < 0 && page->prev < 0) return 0;
+    char cmd[16];
+    while (1) {
+        printf("\n%s%s[Enter] done: ", page->next >= 0 ? "[n] next page  " : "", page->prev >= 0 ? "[p] previous page  " : "");
+        if (!safeFgets(cmd, sizeof(cmd))) return 0;
+        if (cmd[0] == 'n' && page->next >= 0) return 1;
+        if (cmd[0] == 'p' && page->prev >= 0) return -1;
+        if (cmd[0] != 'n' && cmd[0] != 'p') return 0;
+    }
+}
+
+// department and semester filters; Enter skips either
+static void askListFilter(ListFilter *f, char *dept, size_t deptSize) {
+    char sem[16];
+    printf("Department (press Enter for all): ");
+    if (!safeFgets(dept, deptSize)) dept[0] = '\0';
+    printf("Semester (press Enter for all): ");
+    f->department = dept;
+    f->semester = safeFgets(sem, sizeof(sem)) ? atoi(sem) : 0;
+}
+
+void adminViewStudentsInteractive() {
+    clearScreen();
+    printBoxedTitle("Admin: View Students");
+    char dept[MAX_DEPT];
+    ListFilter f = {0};
+    askListFilter(&f, dept, sizeof(dept));
+    int cursor = 0, backward = 0;
+    while (1) {
+        Student *list = NULL;
+        ListPage page;
+        int n = listStudentsPage(&f, cursor, LIST_PAGE_ROWS, backward, &list, &page);
+        if (n <= 0) {
+            free(list);
+            printf(n < 0 ? "❌ Unable to read the student records.\n" : "❌ No student records found!\n");
+            return;
+        }
+        printStudentListHeader();
+        TextBuf buf = {0};
+        for (int i = 0; i < n; i++) listOutStudent(&buf, &list[i]);
+        listOutEnd(&buf);
+        free(list);
+        int step = askListPageStep(&page);
+        if (step == 0) return;
+        backward = (step < 0);
+        cursor = backward ? page.prev : page.next;
+    }
+}
+
+static void browseAdmissions(const ListFilter *f) {
+    int cursor = 0, backward = 0;
+    while (1) {
+        AdmissionInfo *list = NULL;
+        ListPage page;
+        int n = listAdmissionsPage(f, cursor, LIST_PAGE_ROWS, backward, &list, &page);
+        if (n <= 0) {
+            free(list);
+            printf(n < 0 ? "❌ Unable to read the admission requests.\n" : "ℹ️  No admission requests found.\n");
+            return;
+        }
+        printAdmissionListHeader();
+        TextBuf buf = {0};
+        for (int i = 0; i < n; i++) listOutAdmission(&buf, &list[i]);
+        listOutEnd(&buf);
+        free(list);
+        int step = askListPageStep(&page);
+        if (step == 0) return;
+        backward = (step < 0);
+        cursor = backward ? page.prev : page.next;
+    }
+}
+
+void adminViewAdmissionsInteractive() {
+    clearScreen();
+    printBoxedTitle("Admin: View Admissions");
+    char status[MAX_STATUS], dept[MAX_DEPT];
+    ListFilter f = {0};
+    printf("Status (pending / approved, press Enter for all): ");
+    if (!safeFgets(status, sizeof(status))) status[0] = '\0';
+    askListFilter(&f, dept, sizeof(dept));
+    f.status = status;
+    browseAdmissions(&f);
+}
+
 void adminApproveAdmissionInteractive() {
     clearScreen();
     printBoxedTitle("Admin: Approve Admission");
-    listPendingAdmissions();
+    ListFilter pending = { NULL, 0, "pending" };
+    browseAdmissions(&pending);
     int tempId = getIntInput("\nEnter Temp Admission ID to approve (or 0 to cancel): ");
     if (tempId == 0) {
         printf("Cancelled.\n");
@@ -1247,46 +8627,19 @@ void adminApproveAdmissionInteractive() {
     }
 
     // First, check if this tempId exists and its current status
-    FILE *fp = fopen(ADMISSION_FILE, "r");
-    if (!fp) {
+    AdmissionInfo *adm = NULL;
+    int found = listAdmissions(tempId, NULL, &adm);
+    if (found < 0) {
         printf("❌ Unable to read admissions file.\n");
         return;
     }
-    char line[MAX_LINE];
-    int found = 0;
     char curStatus[MAX_STATUS] = {0};
     char pendingUsername[MAX_USERNAME] = {0};
-    while (fgets(line, sizeof(line), fp)) {
-        trim(line);
-        if (line[0] == '\0') continue;
-        char copy[MAX_LINE];
-        strcpy(copy, line);
-        char *tok = strtok(copy, ",");
-        if (!tok) continue;
-        int tid = atoi(tok);
-        if (tid == tempId) {
-            found = 1;
-            // parse to find status and username
-            // tempId,name,department,semester,email,username,password,status,studentId
-            char *parts[10];
-            int p = 0;
-            char *ptr = strtok(line, ",");
-            while (ptr && p < 10) {
-                parts[p++] = ptr;
-                ptr = strtok(NULL, ",");
-            }
-            if (p >= 7) {
-                strncpy(pendingUsername, parts[5], sizeof(pendingUsername)-1);
-            }
-            if (p >= 8) {
-                strncpy(curStatus, parts[7], sizeof(curStatus)-1);
-            } else {
-                strcpy(curStatus, "pending");
-            }
-            break;
-        }
+    if (found > 0) {
+        snprintf(curStatus, sizeof(curStatus), "%s", adm[0].status);
+        snprintf(pendingUsername, sizeof(pendingUsername), "%s", adm[0].username);
     }
-    fclose(fp);
+    free(adm);
 
     if (!found) {
         printf("❌ Admission ID %d not found.\n", tempId);
@@ -1314,32 +8667,312 @@ void adminApproveAdmissionInteractive() {
     }
 }
 
+void adminApproveBatchInteractive() {
+    clearScreen();
+    printBoxedTitle("Admin: Approve Admissions (Batch)");
+    char spec[MAX_LINE];
+    getStringInput("Temp IDs to approve (e.g. 1001,1003,1010-1050 or 'all'): ", spec, sizeof(spec));
+
+    int *ids = NULL;
+    int count = 0;
+    if (strcmp(spec, "all") != 0) {
+        count = parseIdList(spec, &ids);
+        if (count <= 0) {
+            printf("❌ Invalid ID list.\n");
+            return;
+        }
+    }
+    ApprovalResult *results = NULL;
+    int n = 0;
+    int approved = approveAdmissionsBatch(ids, count, &results, &n);
+    free(ids);
+    if (approved < 0) {
+        printf("❌ Error processing batch. No admission was changed.\n");
+        free(results);
+        return;
+    }
+    printf("\n%-8s  %-18s  %-8s\n", "TempID", "Result", "StudID");
+    printf("------------------------------------\n");
+    for (int i = 0; i < n; i++) {
+        printf("%-8d  %-18s  %-8d\n", results[i].tempId, approvalResultText(results[i].result), results[i].studentId);
+    }
+    printf("\n✅ %d of %d admission(s) approved.\n", approved, n);
+    free(results);
+}
+
+void adminImportInteractive() {
+    clearScreen();
+    printBoxedTitle("Admin: Bulk Import Students (CSV)");
+    printf("Row format: name,department,semester,cgpa[,email,username,password]\n\n");
+    char path[MAX_LINE];
+    getStringInput("CSV file to import: ", path, sizeof(path));
+    ImportReport rep;
+    int r = importStudentsCsv(path, &rep);
+    if (r < 0 && rep.rows == 0) {
+        printf("❌ Unable to read %s.\n", path);
+        return;
+    }
+    if (r < 0) printf("❌ Import stopped by a write error; rows before it were saved.\n");
+    double rate = (rep.seconds > 0) ? rep.rows / rep.seconds : 0.0;
+    printf("\n✅ Imported %d student(s) and %d login(s) from %d row(s) in %.2f s (%.0f rows/s).\n",
+           rep.imported, rep.logins, rep.rows, rep.seconds, rate);
+    if (rep.rejected > 0) {
+        printf("❌ %d row(s) rejected", rep.rejected);
+        if (rep.rejected > 20) printf(" (first 20 shown above)");
+        printf("; see %s.\n", IMPORT_REJECTS_FILE);
+    }
+}
+
+void adminExportMarksheetsInteractive() {
+    clearScreen();
+    printBoxedTitle("Admin: Export Marksheet Reports");
+    char dir[MAX_LINE];
+    getStringInput("Folder for the report files: ", dir, sizeof(dir));
+    ExportReport rep;
+    if (exportMarksheetReports(dir, 0, &rep) < 0) {
+        printf("❌ Unable to export to %s.\n", dir);
+        return;
+    }
+    double rate = (rep.seconds > 0) ? rep.reports / rep.seconds : 0.0;
+    printf("\n✅ Wrote %d report(s) (%d marksheet(s)) to %s in %.2f s on %d thread(s) (%.0f reports/s).\n",
+           rep.reports, rep.marksheets, dir, rep.seconds, rep.threads, rate);
+    if (rep.failed > 0) printf("❌ %d report(s) could not be written.\n", rep.failed);
+}
+
+void adminVerifyCgpaInteractive() {
+    clearScreen();
+    printBoxedTitle("Admin: Verify CGPA from Marksheets");
+    CgpaReport rep;
+    CgpaMismatch *list = NULL;
+    int n = verifyCgpa(0, &rep, &list);
+    if (n < 0) {
+        printf("❌ Unable to read the student or marksheet records.\n");
+        return;
+    }
+    printf("Checked %d student(s) with %d marksheet(s).\n", rep.students, rep.marksheets);
+    if (rep.totalsMismatched > 0) printf("❌ Running totals of %d student(s) were off and have been recounted.\n", rep.totalsMismatched);
+    if (n == 0) {
+        free(list);
+        printf("✅ Every stored CGPA matches the marksheets.\n");
+        return;
+    }
+    printf("\n%-6s  %-8s  %-10s\n", "ID", "Stored", "Marksheets");
+    for (int i = 0; i < n && i < 20; i++) {
+        char stored[NUM_BUF], computed[NUM_BUF];
+        formatHundredths(list[i].stored, stored);
+        formatHundredths(list[i].computed, computed);
+        printf("%-6d  %-8s  %-10s\n", list[i].id, stored, computed);
+    }
+    if (n > 20) printf("... and %d more\n", n - 20);
+    free(list);
+    char choice[8];
+    printf("\n❌ %d stored CGPA(s) differ. Replace them with the marksheet CGPA? (y/n): ", n);
+    if (!safeFgets(choice, sizeof(choice)) || (choice[0] != 'y' && choice[0] != 'Y')) {
+        printf("Cancelled.\n");
+        return;
+    }
+    if (verifyCgpa(1, &rep, &list) < 0) printf("❌ Error updating records.\n");
+    else printf("✅ Updated %d record(s).\n", rep.fixed);
+    free(list);
+}
+
+static int semesterAbove(const Student *s, void *ctx) {
+    return s->semester > *(const int *)ctx;
+}
+
+void adminBulkDeleteInteractive() {
+    clearScreen();
+    printBoxedTitle("Admin: Bulk Delete Students");
+    printf("1. Delete by ID list\n");
+    printf("2. Delete everyone above a semester\n");
+    int mode = getIntInput("Enter choice: ");
+    int deleted;
+    if (mode == 1) {
+        char spec[MAX_LINE];
+        getStringInput("Student IDs (e.g. 120,125,130-180): ", spec, sizeof(spec));
+        int *ids = NULL;
+        int n = parseIdList(spec, &ids);
+        if (n <= 0) {
+            printf("❌ Invalid ID list.\n");
+            return;
+        }
+        deleted = deleteStudentsBatch(ids, n);
+        free(ids);
+    } else if (mode == 2) {
+        int sem = getIntInput("Delete students with semester greater than: ");
+        deleted = deleteStudentsWhere(semesterAbove, &sem);
+    } else {
+        printf("❌ Invalid choice.\n");
+        return;
+    }
+    if (deleted < 0) printf("❌ Error deleting students. Nothing was changed.\n");
+    else printf("✅ %d student(s) deleted with their marksheets and logins.\n", deleted);
+}
+
+void adminAnalyticsInteractive() {
+    clearScreen();
+    printBoxedTitle("Department Analytics");
+    AnalyticsReport rep;
+    if (studentAnalytics(&rep) != 1) {
+        printf("❌ Unable to compute analytics.\n");
+        return;
+    }
+    if (rep.students == 0) {
+        free(rep.depts);
+        printf("❌ No student records found!\n");
+        return;
+    }
+    printf("\n%-20s  %8s  %8s  %8s\n", "Department", "Students", "Avg CGPA", "Median");
+    printf("------------------------------------------------------\n");
+    for (int i = 0; i < rep.nDepts; i++) {
+        const DeptAnalytics *d = &rep.depts[i];
+        char avg[NUM_BUF], median[NUM_BUF];
+        formatHundredths(d->avgCgpa, avg);
+        formatHundredths(d->medianCgpa, median);
+        printf("%-20s  %8d  %8s  %8s\n", d->department, d->students, avg, median);
+    }
+    char avg[NUM_BUF], median[NUM_BUF];
+    formatHundredths(rep.avgCgpa, avg);
+    formatHundredths(rep.medianCgpa, median);
+    printf("------------------------------------------------------\n");
+    printf("%-20s  %8d  %8s  %8s\n", "All", rep.students, avg, median);
+
+    printf("\nStudents per semester:\n");
+    for (int i = 0; i < ANALYTICS_SEMESTERS; i++) {
+        if (rep.bySemester[i]) printf("  Semester %-3d  %8d\n", i, rep.bySemester[i]);
+    }
+    printf("\nCGPA distribution:\n");
+    for (int b = 0; b < ANALYTICS_BUCKETS; b++) {
+        char bar[41];
+        int len = (int)((long long)rep.byCgpa[b] * 40 / rep.students);
+        memset(bar, '#', (size_t)len);
+        bar[len] = '\0';
+        printf("  %-10s %8d  %5.1f%%  %s\n", g_cgpaBucketLabels[b], rep.byCgpa[b],
+               100.0 * rep.byCgpa[b] / rep.students, bar);
+    }
+    free(rep.depts);
+}
+
+void adminMeritListInteractive() {
+    clearScreen();
+    printBoxedTitle("Admin: Merit Lists");
+    printf("1. Top students by CGPA\n");
+    printf("2. Students in a CGPA range (e.g. dean's list)\n");
+    int mode = getIntInput("Enter choice: ");
+    if (mode != 1 && mode != 2) {
+        printf("❌ Invalid choice.\n");
+        return;
+    }
+    char dept[MAX_DEPT];
+    printf("Department (press Enter for all): ");
+    if (!safeFgets(dept, sizeof(dept))) dept[0] = '\0';
+    Student *list = NULL;
+    int n;
+    if (mode == 1) {
+        int k = getIntInput("How many students: ");
+        if (k <= 0) {
+            printf("❌ Invalid count.\n");
+            return;
+        }
+        n = topStudentsByCgpa(dept, k, &list);
+    } else {
+        int lo = getHundredthsInput("Minimum CGPA: ");
+        int hi = getHundredthsInput("Maximum CGPA: ");
+        n = studentsInCgpaRange(dept, lo, hi, 0, &list);
+    }
+    if (n < 0) {
+        printf("❌ Unable to read the student records.\n");
+        return;
+    }
+    if (n == 0) {
+        free(list);
+        printf("❌ No matching students.\n");
+        return;
+    }
+    printf("\n%-5s  %-6s  %-25s  %-15s  %-8s  %-6s\n", "Rank", "ID", "Name", "Department", "Semester", "CGPA");
+    printf("-----------------------------------------------------------------------------\n");
+    for (int i = 0; i < n; i++) {
+        const Student *s = &list[i];
+        char cgpa[NUM_BUF];
+        formatHundredths(s->cgpa, cgpa);
+        printf("%-5d  %-6d  %-25s  %-15s  %-8d  %-6s\n", i + 1, s->id, s->name, s->department, s->semester, cgpa);
+    }
+    free(list);
+}
+
+#define SEARCH_PAGE 20
+
+void adminSearchStudentsInteractive() {
+    clearScreen();
+    printBoxedTitle("Admin: Search Students by Name");
+    char query[MAX_NAME];
+    getStringInput("Name (or part of it): ", query, sizeof(query));
+    if ((int)strlen(query) < NAME_MIN_QUERY) {
+        printf("❌ Type at least %d letters.\n", NAME_MIN_QUERY);
+        return;
+    }
+    int offset = 0;
+    while (1) {
+        Student *list = NULL;
+        int total = 0;
+        int n = searchStudentsByName(query, offset, SEARCH_PAGE, &list, &total);
+        if (n < 0) {
+            printf("❌ Unable to search the student records.\n");
+            return;
+        }
+        if (total == 0) {
+            free(list);
+            printf("❌ No student matches \"%s\".\n", query);
+            return;
+        }
+        printf("\nMatches %d-%d of %d:\n", offset + 1, offset + n, total);
+        printStudentListHeader();
+        for (int i = 0; i < n; i++) printStudentListRow(&list[i]);
+        free(list);
+        char cmd[16];
+        printf("\n[n] next page  [p] previous page  [Enter] done: ");
+        if (!safeFgets(cmd, sizeof(cmd))) return;
+        if (cmd[0] == 'n' && offset + SEARCH_PAGE < total) offset += SEARCH_PAGE;
+        else if (cmd[0] == 'p' && offset > 0) offset -= SEARCH_PAGE;
+        else if (cmd[0] != 'n' && cmd[0] != 'p') return;
+    }
+}
+
 /* ---------- Admin Menu ---------- */
 void adminMenu() {
     while (1) {
         clearScreen();
         printBoxedTitle("ADMIN PANEL");
         showDateTime();
-        printf("\n1. View All Admissions\n");
+        printf("\n1. View Admissions\n");
         printf("2. Approve Admission\n");
         printf("3. Add Student (manual)\n");
         printf("4. View Student by ID\n");
         printf("5. Update Student\n");
         printf("6. Delete Student\n");
-        printf("7. View All Students\n");
+        printf("7. View Students\n");
         printf("8. Add Marksheet\n");
         printf("9. View Marksheet\n");
-        printf("10. Logout\n");
+        printf("10. Approve Admissions (batch)\n");
+        printf("11. Bulk Import Students (CSV)\n");
+        printf("12. Bulk Delete Students\n");
+        printf("13. Department Analytics\n");
+        printf("14. Merit Lists (CGPA ranking)\n");
+        printf("15. Search Students by Name\n");
+        printf("16. Export Marksheet Reports\n");
+        printf("17. Verify CGPA from Marksheets\n");
+        printf("18. Operation Stats\n");
+        printf("19. Logout\n");
 
         int ch = getIntInput("Enter choice: ");
         switch (ch) {
-            case 1: listPendingAdmissions(); break;
+            case 1: adminViewAdmissionsInteractive(); break;
             case 2: adminApproveAdmissionInteractive(); break;
             case 3: adminAddStudentInteractive(); break;
             case 4: adminViewStudentInteractive(); break;
             case 5: adminUpdateStudentInteractive(); break;
             case 6: adminDeleteStudentInteractive(); break;
-            case 7: listAllStudents(); break;
+            case 7: adminViewStudentsInteractive(); break;
             case 8: {
                 int id = getIntInput("Enter Student ID to add marksheet: ");
                 int r = addMarksheet(id);
@@ -1351,7 +8984,21 @@ void adminMenu() {
             case 9:
                 viewMarksheetFor(0); // interactive prompt inside
                 break;
-            case 10:
+            case 10: adminApproveBatchInteractive(); break;
+            case 11: adminImportInteractive(); break;
+            case 12: adminBulkDeleteInteractive(); break;
+            case 13: adminAnalyticsInteractive(); break;
+            case 14: adminMeritListInteractive(); break;
+            case 15: adminSearchStudentsInteractive(); break;
+            case 16: adminExportMarksheetsInteractive(); break;
+            case 17: adminVerifyCgpaInteractive(); break;
+            case 18:
+                clearScreen();
+                printBoxedTitle("Operation Stats");
+                if (g_remote) remotePrintStats(); // the daemon's numbers
+                else printOperationStats(stdout);
+                break;
+            case 19:
                 printf("🔒 Logging out of admin panel.\n");
                 pauseAndClear();
                 return;
@@ -1384,7 +9031,9 @@ void studentMenu(int studentId) {
                 printf("Name      : %s\n", s.name);
                 printf("Department: %s\n", s.department);
                 printf("Semester  : %d\n", s.semester);
-                printf("CGPA      : %.2f\n", s.cgpa);
+                char cgpa[NUM_BUF];
+                formatHundredths(s.cgpa, cgpa);
+                printf("CGPA      : %s\n", cgpa);
             } else {
                 printf("❌ Your student record not found.\n");
             }
@@ -1407,7 +9056,7 @@ void studentMenu(int studentId) {
                 if (safeFgets(tmp, sizeof(tmp)) && tmp[0] != '\0') s.semester = atoi(tmp);
 
                 // printf("CGPA [%.2f]: ", s.cgpa);
-                if (safeFgets(tmp, sizeof(tmp)) && tmp[0] != '\0') s.cgpa = (float)atof(tmp);
+                if (safeFgets(tmp, sizeof(tmp)) && tmp[0] != '\0') s.cgpa = hundredthsOf(tmp);
 
                 int upr = updateStudentRecord(studentId, &s);
                 if (upr == 1) printf("✅ Your details updated.\n");
@@ -1451,8 +9100,116 @@ void studentMenu(int studentId) {
 }
 
 /* ---------- Main program flow ---------- */
-int main() {
+int main(int argc, char **argv) {
     enableVirtualTerminal(); // enable colors on Windows if possible
+    atexit(dumpOperationStats);
+
+    // command line: --storage=csv|binary   --durability=none|batch|op   --convert-students
+    //               --batch [file]   --bench [options]   --scan-threads N
+    //               --daemon [socket] [--workers N]   --connect [socket]
+    const char *batchFile = NULL;
+    const char *daemonSocket = NULL, *connectSocket = NULL;
+    int batch = 0, bench = 0, workers = 0;
+    BenchConfig benchCfg = { 10000, 1000, "bench_data", NULL, NULL, 0.20 };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--storage=csv") == 0) {
+            g_storage = STORAGE_CSV;
+        } else if (strcmp(argv[i], "--storage=binary") == 0) {
+            g_storage = STORAGE_BINARY;
+        } else if (strcmp(argv[i], "--convert-students") == 0) {
+            int n = convertStudentsToBinary();
+            if (n < 0) {
+                printf("❌ Conversion of %s failed.\n", STUDENTS_FILE);
+                return 1;
+            }
+            printf("✅ Converted %d students from %s to %s.\n", n, STUDENTS_FILE, STUDENTS_BIN_FILE);
+            return 0;
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            batch = 1;
+            if (i + 1 < argc && argv[i + 1][0] != '-') batchFile = argv[++i];
+        } else if (strcmp(argv[i], "--daemon") == 0) {
+            daemonSocket = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : DAEMON_SOCKET;
+        } else if (strcmp(argv[i], "--connect") == 0) {
+            connectSocket = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : DAEMON_SOCKET;
+        } else if (i + 1 < argc && strcmp(argv[i], "--workers") == 0) {
+            workers = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--scan-threads") == 0) {
+            g_scanThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--durability=none") == 0) {
+            g_durability = DURABILITY_NONE;
+        } else if (strcmp(argv[i], "--durability=batch") == 0) {
+            g_durability = DURABILITY_BATCH;
+        } else if (strcmp(argv[i], "--durability=op") == 0) {
+            g_durability = DURABILITY_OP;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            bench = 1;
+        } else if (bench && i + 1 < argc && strcmp(argv[i], "--students") == 0) {
+            benchCfg.students = atoi(argv[++i]);
+        } else if (bench && i + 1 < argc && strcmp(argv[i], "--iterations") == 0) {
+            benchCfg.iterations = atoi(argv[++i]);
+        } else if (bench && i + 1 < argc && strcmp(argv[i], "--dir") == 0) {
+            benchCfg.dir = argv[++i];
+        } else if (bench && i + 1 < argc && strcmp(argv[i], "--out") == 0) {
+            benchCfg.outPath = argv[++i];
+        } else if (bench && i + 1 < argc && strcmp(argv[i], "--baseline") == 0) {
+            benchCfg.baselinePath = argv[++i];
+        } else if (bench && i + 1 < argc && strcmp(argv[i], "--tolerance") == 0) {
+            benchCfg.tolerance = atof(argv[++i]) / 100.0;
+        } else {
+            printf("Usage: %s [--storage=csv|binary] [--durability=none|batch|op] [--convert-students]\n", argv[0]);
+            printf("            [--scan-threads N] [--batch [file]]\n");
+            printf("       %s --bench [--students N] [--iterations N] [--dir DIR] [--out FILE]\n", argv[0]);
+            printf("            [--baseline FILE] [--tolerance PCT]\n");
+            printf("       %s --daemon [socket] [--workers N]\n", argv[0]);
+            printf("       %s --connect [socket] [--batch [file]]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (bench) {
+        if (benchCfg.students < 1 || benchCfg.iterations < 1) {
+            printf("❌ --students and --iterations must be positive.\n");
+            return 1;
+        }
+        return runBenchmark(&benchCfg);
+    }
+
+    if (connectSocket) {
+        if (connectDaemon(connectSocket) != 0) return 1;
+    } else if (g_storage == STORAGE_BINARY) {
+        FILE *bin = fopen(STUDENTS_BIN_FILE, "rb");
+        FILE *csv = bin ? NULL : fopen(STUDENTS_FILE, "r");
+        if (csv) printf("ℹ️  %s not found. Run with --convert-students to import %s.\n", STUDENTS_BIN_FILE, STUDENTS_FILE);
+        if (bin) fclose(bin);
+        if (csv) fclose(csv);
+    }
+    if (!g_remote && loadStudentTable() != 1) {
+        printf("❌ Unable to load student records (%s).\n",
+               g_storage == STORAGE_BINARY ? STUDENTS_BIN_FILE : STUDENTS_FILE);
+        return 1;
+    }
+    if (daemonSocket) {
+        if (workers <= 0) {
+#ifdef _WIN32
+            workers = 4;
+#else
+            workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        }
+        if (workers < 1) workers = 1;
+        if (workers > DAEMON_MAX_WORKERS) workers = DAEMON_MAX_WORKERS;
+        return runDaemon(daemonSocket, workers);
+    }
+
+    if (batch) {
+        FILE *in = batchFile ? fopen(batchFile, "r") : stdin;
+        if (!in) {
+            printf("❌ Unable to open %s.\n", batchFile);
+            return 1;
+        }
+        int r = runBatchMode(in);
+        if (in != stdin) fclose(in);
+        return r;
+    }
     printAppHeader();
 
     while (1) {
@@ -1501,35 +9258,12 @@ int main() {
                 // Provide helpful hint: if username exists as pending admission, tell user pending approval
                 // We'll check ADMISSION_FILE for a matching username with status 'pending'
                 int pendingFound = 0;
-                FILE *afp = fopen(ADMISSION_FILE, "r");
-                if (afp) {
-                    char aline[MAX_LINE];
-                    while (fgets(aline, sizeof(aline), afp)) {
-                        trim(aline);
-                        if (aline[0] == '\0') continue;
-                        char copy[MAX_LINE];
-                        strcpy(copy, aline);
-                        char *tok = strtok(copy, ",");
-                        if (!tok) continue;
-                        // parse fields to get username and status
-                        char *parts[10];
-                        int p = 0;
-                        char *ptr = strtok(aline, ",");
-                        while (ptr && p < 10) {
-                            parts[p++] = ptr;
-                            ptr = strtok(NULL, ",");
-                        }
-                        if (p >= 6) {
-                            char *adUser = parts[5];
-                            char *adStatus = (p >= 8) ? parts[7] : "pending";
-                            if (strcmp(adUser, username) == 0) {
-                                if (strcmp(adStatus, "pending") == 0) pendingFound = 1;
-                                break;
-                            }
-                        }
-                    }
-                    fclose(afp);
+                AdmissionInfo *adm = NULL;
+                int nAdm = listAdmissions(0, username, &adm);
+                for (int i = 0; i < nAdm; i++) {
+                    if (strcmp(adm[i].status, "pending") == 0) pendingFound = 1;
                 }
+                free(adm);
                 if (pendingFound) {
                     printf("❌ Login failed: your registration is still pending admin approval.\n");
                 } else {
@@ -1568,6 +9302,7 @@ int main() {
             }
         } else if (choice == 4) {
             printf("👋 Exiting... Goodbye!\n");
+            finishStudentJournal();
             break;
         } else {
             printf("❌ Invalid choice. Try again.\n");